@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <boost/program_options.hpp>
+
+#include "../src/loader/json_loader.h"
+#include "../src/model/model.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Every allocation is prefixed with its size, so the bytes in use and their peak are known at any moment
+struct alignas(std::max_align_t) AllocationHeader {
+    std::size_t size;
+};
+
+std::atomic<std::size_t> used_bytes{0};
+std::atomic<std::size_t> peak_bytes{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    auto* header = static_cast<AllocationHeader*>(std::malloc(sizeof(AllocationHeader) + size));
+    if (!header) {
+        throw std::bad_alloc{};
+    }
+    header->size = size;
+    const auto used = used_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak = peak_bytes.load(std::memory_order_relaxed);
+    while (used > peak && !peak_bytes.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+    }
+    return header + 1;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    auto* header = static_cast<AllocationHeader*>(ptr) - 1;
+    used_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    std::free(header);
+}
+
+void operator delete(void* ptr, [[maybe_unused]] std::size_t size) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+struct Args {
+    std::size_t maps;
+    std::size_t roads;
+    std::string config_file_path;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+    po::options_description desc("Allowed options");
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("maps,m", po::value<std::size_t>(&args.maps)->default_value(4), "set number of maps of the generated config")
+        ("roads,r", po::value<std::size_t>(&args.roads)->default_value(200000), "set number of roads of every generated map")
+        ("config-file,c", po::value(&args.config_file_path)->value_name("file"s), "load the given config instead of generating one");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    return args;
+}
+
+// Grids of horizontal and vertical roads with a building in every tenth cell, like procedurally generated maps
+void WriteConfig(const std::filesystem::path& path, std::size_t map_count, std::size_t road_count) {
+    std::ofstream out{path, std::ios::trunc};
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to create config: "s + path.string());
+    }
+    const auto lines = std::max<std::size_t>(1, road_count / 2);
+    const auto length = 10 * (lines - 1);
+    out << R"({"defaultDogSpeed": 3.0, "defaultBagCapacity": 3, "lootGeneratorConfig": {"period": 5.0, "probability": 0.5}, "maps": [)";
+    for (std::size_t map = 0; map != map_count; ++map) {
+        out << (map == 0 ? "" : ",") << R"({"id": "map)" << map << R"(", "name": "Map )" << map << R"(", "lootTypes": [)"
+            << R"({"name": "key", "file": "assets/key.obj", "type": "obj", "rotation": 90, "color": "#338844", "scale": 0.03, "value": 10},)"
+            << R"({"name": "wallet", "file": "assets/wallet.obj", "type": "obj", "rotation": 0, "color": "#883344", "scale": 0.01, "value": 30}],)"
+            << "\n\"roads\": [";
+        for (std::size_t i = 0; i != lines; ++i) {
+            out << (i == 0 ? "" : ",") << R"({"x0": 0, "y0": )" << i * 10 << R"(, "x1": )" << length << "},\n"
+                << R"({"x0": )" << i * 10 << R"(, "y0": 0, "y1": )" << length << "}";
+        }
+        out << "],\n\"buildings\": [";
+        for (std::size_t i = 0; i < lines; i += 10) {
+            out << (i == 0 ? "" : ",") << R"({"x": )" << i * 10 + 2 << R"(, "y": )" << i * 10 + 2 << R"(, "w": 6, "h": 6})" << "\n";
+        }
+        out << R"(], "offices": [{"id": "o0", "x": 0, "y": 0, "offsetX": 5, "offsetY": 0}]})" << "\n";
+    }
+    out << "]}\n";
+    if (!out) {
+        throw std::runtime_error("Failed to write config: "s + path.string());
+    }
+}
+
+template <typename Parse>
+void Measure(std::string_view name, std::string_view content, Parse parse) {
+    const auto baseline = used_bytes.load();
+    peak_bytes.store(baseline);
+    const auto start = std::chrono::steady_clock::now();
+    extra_data::Payload payload;
+    std::size_t roads = 0;
+    {
+        const auto game = parse(content, payload);
+        const std::chrono::duration<double> load_time = std::chrono::steady_clock::now() - start;
+        const auto retained = used_bytes.load() - baseline;
+        for (const auto& map : game.GetMaps()) {
+            roads += map->GetRoads().size();
+        }
+        std::cout << name << ": maps: "sv << game.GetMaps().size() << ", roads: "sv << roads
+                  << ", load ms: "sv << load_time.count() * 1000.
+                  << ", peak heap MiB: "sv << static_cast<double>(peak_bytes.load() - baseline) / (1 << 20)
+                  << ", game MiB: "sv << static_cast<double>(retained) / (1 << 20) << std::endl;
+    }
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        const bool generate = args->config_file_path.empty();
+        const std::filesystem::path path = generate ? std::filesystem::temp_directory_path() / "config_load_bench.json"
+                                                    : std::filesystem::path{args->config_file_path};
+        if (generate) {
+            WriteConfig(path, args->maps, args->roads);
+        }
+        {
+            // The file is mapped, so its pages are not counted as heap
+            const auto file = json_loader::MapFile(path);
+            const std::string_view content{file.data(), file.size()};
+            std::cout << "config MiB: "sv << static_cast<double>(content.size()) / (1 << 20) << std::endl;
+            Measure("streaming"sv, content, json_loader::ParseGame);
+            Measure("document"sv, content, json_loader::ParseGameDocument);
+        }
+        if (generate) {
+            std::filesystem::remove(path);
+        }
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
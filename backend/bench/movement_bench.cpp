@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "../src/model/model.h"
+#include "../src/util/random.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct Args {
+    std::size_t roads;
+    std::size_t dogs;
+    std::size_t ticks;
+    int tick_period;
+    std::size_t turn_period;
+    std::uint64_t random_seed;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+    po::options_description desc("Allowed options");
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("roads,r", po::value<std::size_t>(&args.roads)->default_value(2000), "set number of roads of the generated grid map")
+        ("dogs,d", po::value<std::size_t>(&args.dogs)->default_value(1000), "set number of moving dogs")
+        ("ticks,t", po::value<std::size_t>(&args.ticks)->default_value(1000), "set number of ticks to run")
+        ("tick-period", po::value<int>(&args.tick_period)->default_value(50), "set simulated tick period in milliseconds")
+        ("turn-period", po::value<std::size_t>(&args.turn_period)->default_value(20), "set number of ticks after which a dog changes its direction")
+        ("random-seed", po::value<std::uint64_t>(&args.random_seed)->default_value(1), "set seed of spawning and dog movement");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    return args;
+}
+
+// Square grid of horizontal and vertical roads with a 10 units step
+model::Map MakeGridMap(std::size_t road_count) {
+    constexpr model::Coord step = 10;
+    const auto lines = static_cast<model::Coord>(std::max<std::size_t>(1, road_count / 2));
+    const model::Coord length = step * std::max<model::Coord>(1, lines - 1);
+
+    model::Map map{model::Map::Id{"grid"s}, "Grid"s, 4.0, 3};
+    model::Map::Roads roads;
+    roads.reserve(lines * 2);
+    for (model::Coord i = 0; i != lines; ++i) {
+        roads.emplace_back(model::Road::Direction::HORIZONTAL, model::Point{0, i * step}, length);
+        roads.emplace_back(model::Road::Direction::VERTICAL, model::Point{i * step, 0}, length);
+    }
+    map.AddRoads(roads);
+    map.FinalizeRoads();
+    return map;
+}
+
+// Dogs always move, so every tick some of them leave their road and look for a road to turn to
+void TurnDog(model::Dog& dog, double dog_speed, util::RandomEngine& engine) {
+    switch (engine.NextIndex(4)) {
+        case 0:
+            dog.SetDirection(model::Dog::Direction::WEST);
+            dog.SetSpeed({-dog_speed, 0.});
+            break;
+        case 1:
+            dog.SetDirection(model::Dog::Direction::EAST);
+            dog.SetSpeed({dog_speed, 0.});
+            break;
+        case 2:
+            dog.SetDirection(model::Dog::Direction::NORTH);
+            dog.SetSpeed({0., -dog_speed});
+            break;
+        default:
+            dog.SetDirection(model::Dog::Direction::SOUTH);
+            dog.SetSpeed({0., dog_speed});
+    }
+}
+
+void MoveDog(model::Dog& dog, const model::Map& map, int delta) {
+    switch (dog.GetDirection()) {
+        case model::Dog::Direction::WEST:
+            dog.SetPositionWhenMovingWest(map, delta);
+            break;
+        case model::Dog::Direction::EAST:
+            dog.SetPositionWhenMovinggEast(map, delta);
+            break;
+        case model::Dog::Direction::NORTH:
+            dog.SetPositionWhenMovingNorth(map, delta);
+            break;
+        case model::Dog::Direction::SOUTH:
+            dog.SetPositionWhenMovingSouth(map, delta);
+            break;
+    }
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        // Includes finding the junctions of every road
+        const auto build_start = std::chrono::steady_clock::now();
+        const auto map = MakeGridMap(args->roads);
+        const std::chrono::duration<double> build_time = std::chrono::steady_clock::now() - build_start;
+        util::RandomEngine engine{args->random_seed};
+        std::vector<model::Dog> dogs;
+        dogs.reserve(args->dogs);
+        for (std::size_t i = 0; i != args->dogs; ++i) {
+            auto& dog = dogs.emplace_back(model::Dog::Id{static_cast<std::uint32_t>(i)}, "dog"s + std::to_string(i), 3);
+            const auto index = map.GetRandomRoadIndex(engine);
+            dog.SetPosition(model::GetRandomPosition(map.GetRoads()[index], engine));
+            dog.SetCurrentRoadsIndex(index);
+        }
+
+        const auto& roads = map.GetCompactRoads();
+        std::size_t road_changes = 0;
+        std::chrono::duration<double> total{};
+        for (std::size_t tick = 0; tick != args->ticks; ++tick) {
+            if (args->turn_period != 0 && tick % args->turn_period == 0) {
+                for (auto& dog : dogs) {
+                    TurnDog(dog, map.GetDogSpeed(), engine);
+                }
+            }
+            const auto tick_start = std::chrono::steady_clock::now();
+            for (auto& dog : dogs) {
+                const auto index = dog.GetCurrentRoadsIndex();
+                MoveDog(dog, map, args->tick_period);
+                road_changes += dog.GetCurrentRoadsIndex() != index ? 1 : 0;
+            }
+            total += std::chrono::steady_clock::now() - tick_start;
+        }
+
+        const double moves = static_cast<double>(std::max<std::size_t>(1, args->dogs * args->ticks));
+        std::cout << "roads: "sv << roads.size() << ", road bytes: "sv << roads.size() * sizeof(model::CompactRoad)
+                  << ", dogs: "sv << dogs.size() << ", ticks: "sv << args->ticks << '\n'
+                  << "map build ms: "sv << build_time.count() * 1000. << '\n'
+                  << "movement ms: "sv << total.count() * 1000. << '\n'
+                  << "ns per move: "sv << total.count() * 1e9 / moves << '\n'
+                  << "road changes: "sv << road_changes << std::endl;
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
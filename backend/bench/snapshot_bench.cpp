@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include "../src/serialization/snapshot_format.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct Args {
+    std::size_t sessions;
+    std::size_t dogs;
+    std::size_t roads;
+    std::size_t ticks;
+    std::string state_file;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+    po::options_description desc("Allowed options");
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("sessions,s", po::value<std::size_t>(&args.sessions)->default_value(100), "set number of game sessions")
+        ("dogs,d", po::value<std::size_t>(&args.dogs)->default_value(1000), "set number of dogs in every session")
+        ("roads,r", po::value<std::size_t>(&args.roads)->default_value(100), "set number of roads of the generated grid map")
+        ("ticks,t", po::value<std::size_t>(&args.ticks)->default_value(10), "set number of ticks run before saving, they spawn lost objects")
+        ("state-file", po::value<std::string>(&args.state_file), "set path of the written state files, a temporary file by default");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (args.state_file.empty()) {
+        args.state_file = (std::filesystem::temp_directory_path() / "game_snapshot_bench_state").string();
+    }
+    return args;
+}
+
+// Square grid of horizontal and vertical roads with a 10 units step
+model::Map MakeGridMap(std::size_t road_count) {
+    constexpr model::Coord step = 10;
+    const auto lines = static_cast<model::Coord>(std::max<std::size_t>(1, road_count / 2));
+    const model::Coord length = step * std::max<model::Coord>(1, lines - 1);
+
+    model::Map map{model::Map::Id{"grid"s}, "Grid"s, 4.0, 3};
+    model::Map::Roads roads;
+    roads.reserve(lines * 2);
+    for (model::Coord i = 0; i != lines; ++i) {
+        roads.emplace_back(model::Road::Direction::HORIZONTAL, model::Point{0, i * step}, length);
+        roads.emplace_back(model::Road::Direction::VERTICAL, model::Point{i * step, 0}, length);
+    }
+    map.AddRoads(roads);
+    map.AddOffice(model::Office{model::Office::Id{"o0"s}, {0, 0}, {0, 0}});
+    map.AddLoot({0.005, 0.5}, 2, {10, 20, 30});
+    return map;
+}
+
+std::unique_ptr<model::Game> MakeGame(const Args& args) {
+    auto game = std::make_unique<model::Game>();
+    game->AddMap(MakeGridMap(args.roads));
+    return game;
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::size_t CountDogs(const app::Application& app) {
+    std::size_t count = 0;
+    for (const auto& session : app.GetGame()->GetGameSessions()) {
+        count += session->GetDogs().size();
+    }
+    return count;
+}
+
+void Measure(const Args& args, const app::Application& app, const serialization::ApplicationRepr& snapshot,
+             serialization::SnapshotFormat format, std::string_view name) {
+    auto start = std::chrono::steady_clock::now();
+    serialization::SaveSnapshot(snapshot, args.state_file, format);
+    const auto save_time = MillisecondsSince(start);
+    const auto size = std::filesystem::file_size(args.state_file);
+
+    app::Application restored{MakeGame(args), false, args.dogs};
+    start = std::chrono::steady_clock::now();
+    serialization::LoadSnapshot(restored, args.state_file);
+    const auto load_time = MillisecondsSince(start);
+    if (CountDogs(restored) != CountDogs(app)) {
+        throw std::runtime_error("Restored state differs from the saved one");
+    }
+
+    std::cout << name << ": size bytes: "sv << size << ", save ms: "sv << save_time << ", load ms: "sv << load_time << std::endl;
+    std::filesystem::remove(args.state_file);
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        // Sessions are filled one by one, because a session takes at most args->dogs players
+        app::Application app{MakeGame(*args), true, args->dogs};
+        const model::Map::Id map_id{"grid"s};
+        for (std::size_t i = 0, count = args->sessions * args->dogs; i != count; ++i) {
+            app.JoinGame("dog"s + std::to_string(i), map_id);
+        }
+        for (std::size_t tick = 0; tick != args->ticks; ++tick) {
+            app.UpdateGameState(50);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const serialization::ApplicationRepr snapshot{app};
+        std::cout << "sessions: "sv << app.GetGame()->GetGameSessions().size() << ", dogs: "sv << CountDogs(app) << '\n'
+                  << "capture ms: "sv << MillisecondsSince(start) << std::endl;
+
+        Measure(*args, app, snapshot, serialization::SnapshotFormat::TEXT, "text"sv);
+        Measure(*args, app, snapshot, serialization::SnapshotFormat::BINARY, "binary"sv);
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "../src/loader/json_loader.h"
+#include "../src/model/model.h"
+#include "../src/util/random.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Counting every allocation made by the process. The counter is only read between ticks
+std::atomic<std::size_t> allocation_count{0};
+std::atomic<std::size_t> allocated_bytes{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, [[maybe_unused]] std::size_t size) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+struct Args {
+    std::string config_file_path;
+    std::string map_id;
+    std::size_t roads;
+    std::size_t dogs;
+    std::size_t ticks;
+    int tick_period;
+    std::size_t turn_period;
+    std::uint64_t random_seed;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+    po::options_description desc("Allowed options");
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("config-file,c", po::value<std::string>(&args.config_file_path), "load maps from the config file instead of generating a grid")
+        ("map", po::value<std::string>(&args.map_id), "set id of the config map to run, the first map by default")
+        ("roads,r", po::value<std::size_t>(&args.roads)->default_value(100), "set number of roads of the generated grid map")
+        ("dogs,d", po::value<std::size_t>(&args.dogs)->default_value(1000), "set number of dogs in the session")
+        ("ticks,t", po::value<std::size_t>(&args.ticks)->default_value(1000), "set number of ticks to run")
+        ("tick-period", po::value<int>(&args.tick_period)->default_value(50), "set simulated tick period in milliseconds")
+        ("turn-period", po::value<std::size_t>(&args.turn_period)->default_value(20), "set number of ticks after which a dog changes its direction")
+        ("random-seed", po::value<std::uint64_t>(&args.random_seed)->default_value(1), "set seed of spawning and dog movement");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    return args;
+}
+
+// Square grid of horizontal and vertical roads with a 10 units step
+model::Map MakeGridMap(std::size_t road_count) {
+    constexpr model::Coord step = 10;
+    const auto lines = static_cast<model::Coord>(std::max<std::size_t>(1, road_count / 2));
+    const model::Coord length = step * std::max<model::Coord>(1, lines - 1);
+
+    model::Map map{model::Map::Id{"grid"s}, "Grid"s, 4.0, 3};
+    model::Map::Roads roads;
+    roads.reserve(lines * 2);
+    for (model::Coord i = 0; i != lines; ++i) {
+        roads.emplace_back(model::Road::Direction::HORIZONTAL, model::Point{0, i * step}, length);
+        roads.emplace_back(model::Road::Direction::VERTICAL, model::Point{i * step, 0}, length);
+    }
+    map.AddRoads(roads);
+    map.AddOffice(model::Office{model::Office::Id{"o0"s}, {0, 0}, {0, 0}});
+    map.AddLoot({0.005, 0.5}, 2, {10, 20, 30});
+    return map;
+}
+
+model::Game MakeGame(const Args& args) {
+    if (args.config_file_path.empty()) {
+        model::Game game;
+        game.AddMap(MakeGridMap(args.roads));
+        return game;
+    }
+    extra_data::Payload payload;
+    return json_loader::LoadGame(args.config_file_path, payload);
+}
+
+// The map to run: the given one or the first one of the config, it needs roads to spawn dogs on and loot settings
+model::Game::MapPtr FindMap(const model::Game& game, const std::string& map_id) {
+    if (game.GetMaps().empty()) {
+        throw std::runtime_error("Config has no maps");
+    }
+    const auto map = map_id.empty() ? game.GetMaps().front() : game.FindMap(model::Map::Id{map_id});
+    if (!map) {
+        throw std::runtime_error("Map "s + map_id + " not found"s);
+    }
+    if (map->GetRoads().empty()) {
+        throw std::runtime_error("Map "s + *map->GetId() + " has no roads"s);
+    }
+    if (!map->GetLoot()) {
+        throw std::runtime_error("Map "s + *map->GetId() + " has no loot settings"s);
+    }
+    return map;
+}
+
+void TurnDog(model::Dog& dog, double dog_speed, util::RandomEngine& engine) {
+    switch (engine.NextIndex(5)) {
+        case 0:
+            dog.SetDirection(model::Dog::Direction::WEST);
+            dog.SetSpeed({-dog_speed, 0.});
+            break;
+        case 1:
+            dog.SetDirection(model::Dog::Direction::EAST);
+            dog.SetSpeed({dog_speed, 0.});
+            break;
+        case 2:
+            dog.SetDirection(model::Dog::Direction::NORTH);
+            dog.SetSpeed({0., -dog_speed});
+            break;
+        case 3:
+            dog.SetDirection(model::Dog::Direction::SOUTH);
+            dog.SetSpeed({0., dog_speed});
+            break;
+        default:
+            dog.SetSpeed({0., 0.});
+    }
+}
+
+double Percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.;
+    }
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        model::Game game = MakeGame(*args);
+        game.SetRandomSeed(args->random_seed);
+        const auto map = FindMap(game, args->map_id);
+
+        auto session = game.AddGameSession(map);
+        auto& engine = session->GetRandomEngine();
+        for (std::size_t i = 0; i != args->dogs; ++i) {
+            const auto index = map->GetRandomRoadIndex(engine);
+            session->AddDog("dog"s + std::to_string(i), model::GetRandomPosition(map->GetRoads()[index], engine), index);
+        }
+
+        // Movement has its own engine so that scripted turns do not change what the session spawns
+        util::RandomEngine movement{util::MixSeed(args->random_seed, args->dogs)};
+        std::vector<double> latencies;
+        latencies.reserve(args->ticks);
+        std::size_t allocations = 0;
+        std::size_t bytes = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t tick = 0; tick != args->ticks; ++tick) {
+            if (args->turn_period != 0 && tick % args->turn_period == 0) {
+                for (const auto& dog : session->GetDogs()) {
+                    TurnDog(*dog, map->GetDogSpeed(), movement);
+                }
+            }
+            const auto allocations_before = allocation_count.load(std::memory_order_relaxed);
+            const auto bytes_before = allocated_bytes.load(std::memory_order_relaxed);
+            const auto tick_start = std::chrono::steady_clock::now();
+            session->UpdateGameState(args->tick_period);
+            const std::chrono::duration<double, std::micro> tick_time = std::chrono::steady_clock::now() - tick_start;
+            allocations += allocation_count.load(std::memory_order_relaxed) - allocations_before;
+            bytes += allocated_bytes.load(std::memory_order_relaxed) - bytes_before;
+            latencies.push_back(tick_time.count());
+        }
+        const std::chrono::duration<double> total = std::chrono::steady_clock::now() - start;
+
+        std::sort(latencies.begin(), latencies.end());
+        const double ticks = static_cast<double>(std::max<std::size_t>(1, args->ticks));
+        std::cout << "map: "sv << *map->GetId() << ", roads: "sv << map->GetRoads().size()
+                  << ", dogs: "sv << session->GetDogs().size() << ", ticks: "sv << args->ticks << '\n'
+                  << "ticks per second: "sv << (total.count() > 0 ? args->ticks / total.count() : 0.) << '\n'
+                  << "tick p50 us: "sv << Percentile(latencies, 0.5) << '\n'
+                  << "tick p99 us: "sv << Percentile(latencies, 0.99) << '\n'
+                  << "tick max us: "sv << (latencies.empty() ? 0. : latencies.back()) << '\n'
+                  << "allocations per tick: "sv << allocations / ticks << '\n'
+                  << "allocated bytes per tick: "sv << bytes / ticks << '\n'
+                  << "lost objects: "sv << session->GetLoot()->GetLostObjects().size() << std::endl;
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
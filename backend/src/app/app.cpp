@@ -1,12 +1,12 @@
 #include "app.h"
 
-#include <sstream>
-#include <iomanip>
 #include <iostream>
 #include <utility>
 
 namespace app {
 
+using namespace std::literals;
+
 void Player::Add(const GameSessionPtr& session, const DogPtr& dog) {
     session_ = session;
     dog_ = dog;
@@ -20,16 +20,13 @@ const GameSessionPtr& Player::GetGameSession() const {
     return session_;
 }
 
-Token PlayerTokens::Add(Player& player) {
-    std::ostringstream oss;
-    oss << std::hex << std::setw(16) << std::setfill('0') << generator1_();
-    oss << std::hex << std::setw(16) << std::setfill('0') << generator2_();
-    Token token{oss.str()};
-    token_to_player_.emplace(token, std::make_shared<Player>(player));
+Token PlayerTokens::Add(const Player& player) {
+    Token token{generator1_(), generator2_()};
+    token_to_player_.emplace(token, &player);
     return token;
 }
 
-PlayerPtr PlayerTokens::FindPlayerByToken(const Token& token) {
+PlayerHandle PlayerTokens::FindPlayerByToken(const Token& token) const {
     if (auto it = token_to_player_.find(token); it != token_to_player_.end()) {
         return it->second;
     }
@@ -40,28 +37,26 @@ const PlayerTokens::TokenToPlayer& PlayerTokens::GetTokenToPlayer() const {
     return token_to_player_;
 }
 
-void PlayerTokens::SetTokenToPlayer(const Token& token, const PlayerPtr& player) {
+void PlayerTokens::SetTokenToPlayer(const Token& token, PlayerHandle player) {
     token_to_player_.emplace(token, player);
 }
 
 Player& Players::Add(const GameSessionPtr& session, const DogPtr& dog) {
-    Player player_tmp;
-    player_tmp.Add(session, dog);
-    players_.emplace_back(std::move(player_tmp));
-    auto& player = players_.back();
-    map_id_to_player_list_[(player.GetGameSession()->GetMap()->GetId())][*(player.GetDog()->GetId())] = player.GetDog()->GetName();
+    auto& player = players_.emplace_back();
+    player.Add(session, dog);
+    session_id_to_player_list_[(player.GetGameSession()->GetId())][*(player.GetDog()->GetId())] = player.GetDog()->GetName();
     return player;
 }
 
-std::optional<Players::CRefPlayerList> Players::FindPlayerList(const model::Map::Id& id) const {
-    if (auto it = map_id_to_player_list_.find(id); it != map_id_to_player_list_.end()) {
+std::optional<Players::CRefPlayerList> Players::FindPlayerList(const model::GameSession::Id& id) const {
+    if (auto it = session_id_to_player_list_.find(id); it != session_id_to_player_list_.end()) {
         return std::cref(it->second);
     }
     return std::nullopt;
 }
 
-const Players::MapIdToPlayerList& Players::GetMapIdToPlayerList() const {
-    return map_id_to_player_list_;
+const Players::SessionIdToPlayerList& Players::GetSessionIdToPlayerList() const {
+    return session_id_to_player_list_;
 }
 
 const Players::AddedPlayers& Players::GetAddedPlayers() const {
@@ -85,11 +80,12 @@ const std::string& ApplicationError::GetMessage() const {
     return message_;
 }
 
-Application::Application(GamePtr game, bool random_positions)
+Application::Application(GamePtr game, bool random_positions, std::size_t max_session_players)
     : game_{std::move(game)}
     , players_{std::make_unique<Players>()}
     , player_tokens_{std::make_unique<PlayerTokens>()}
     , random_positions_{random_positions} {
+    game_->SetMaxSessionDogs(max_session_players);
 }
 
 [[nodiscard]] sig::connection Application::DoOnTick(const TickSignal::slot_type& handler) {
@@ -113,8 +109,8 @@ const Application::PlayerTokensPtr& Application::GetPlayerTokens() const {
 }
 
 const Players::PlayerList& Application::GetPlayerList(const std::string& credentials) {
-    const auto& map_id = PlayerAuthorization(credentials)->GetGameSession()->GetMap()->GetId();
-    auto player_list = players_->FindPlayerList(map_id);
+    const auto& session_id = PlayerAuthorization(credentials)->GetGameSession()->GetId();
+    auto player_list = players_->FindPlayerList(session_id);
     if (!player_list) {
         throw ApplicationError{"invalidArgument", "The player list was not found"};
     }
@@ -126,90 +122,199 @@ const model::GameSession::GameStateList& Application::GetGameStateList(const std
 }
 
 const model::Loot::LostObjects& Application::GetLostObjects(const std::string& credentials) {
-    return PlayerAuthorization(credentials)->GetGameSession()->GetMap()->GetLoot()->GetLostObjects();
+    return PlayerAuthorization(credentials)->GetGameSession()->GetLoot()->GetLostObjects();
 }
 
 void Application::SetPlayerAction(const std::string& credentials, const std::string& dir) {
-    auto player = PlayerAuthorization(credentials);
-    const auto& dog = player->GetDog();
-    const double dog_speed = player->GetGameSession()->GetMap()->GetDogSpeed();
-    if (dir.empty()) {
-        dog->SetSpeed({0., 0.});
-    } else if (dir == "L") {
-        dog->SetDirection(model::Dog::Direction::WEST);
-        dog->SetSpeed({-dog_speed, 0.});
-    } else if (dir == "R") {
-        dog->SetDirection(model::Dog::Direction::EAST);
-        dog->SetSpeed({dog_speed, 0.});
-    } else if (dir == "U") {
-        dog->SetDirection(model::Dog::Direction::NORTH);
-        dog->SetSpeed({0., -dog_speed});
-    } else if (dir == "D") {
-        dog->SetDirection(model::Dog::Direction::SOUTH);
-        dog->SetSpeed({0., dog_speed});
-    } else {
-        throw ApplicationError{"invalidArgument", "Failed to parse action"};
+    ApplyPlayerAction(PlayerAuthorization(credentials), dir);
+    // The header has been validated by the authorization
+    RecordPlayerAction(std::string_view{credentials}.substr(credentials.size() - Token::HEX_SIZE), dir);
+}
+
+PlayerActionErrors Application::SetPlayerActions(const PlayerActions& actions) {
+    PlayerActionErrors errors;
+    for (std::size_t i = 0; i != actions.size(); ++i) {
+        try {
+            ApplyPlayerAction(FindPlayer(actions[i].token), actions[i].move);
+            RecordPlayerAction(actions[i].token, actions[i].move);
+        } catch (const ApplicationError& e) {
+            errors.push_back({i, e.GetCode(), e.GetMessage()});
+        }
     }
+    return errors;
 }
 
 void Application::UpdateGameState(int delta) {
-    for (const auto& map : game_->GetMaps()) {
-        const auto& map_id = map.GetId();
-        if (const auto& session = game_->FindGameSession(map_id); session) {
-            session->UpdateGameState(delta);
-        }
+    trace_.BeginTick();
+    util::ScopedTimer timer{tick_stats_, trace_.IsRecording() ? &trace_ : nullptr, "Tick"sv, 0};
+    if (input_log_) {
+        input_log_->WriteTick(delta);
+    }
+    if (fixed_time_step_ == milliseconds::zero()) {
+        UpdateGameSessions(delta);
+        return;
+    }
+    pending_time_ += milliseconds{delta};
+    while (pending_time_ >= fixed_time_step_) {
+        UpdateGameSessions(static_cast<int>(fixed_time_step_.count()));
+        pending_time_ -= fixed_time_step_;
+    }
+}
+
+void Application::SetFixedTimeStep(milliseconds step) {
+    if (step < milliseconds::zero()) {
+        throw std::invalid_argument("Time step must not be negative");
+    }
+    fixed_time_step_ = step;
+    pending_time_ = milliseconds::zero();
+}
+
+Application::milliseconds Application::GetPendingTime() const noexcept {
+    return pending_time_;
+}
+
+void Application::SetPendingTime(milliseconds pending_time) noexcept {
+    pending_time_ = pending_time;
+}
+
+void Application::SetInputLog(InputLogWriter* input_log) {
+    input_log_ = input_log;
+}
+
+util::TraceRecorder& Application::GetTraceRecorder() noexcept {
+    return trace_;
+}
+
+const util::TraceRecorder& Application::GetTraceRecorder() const noexcept {
+    return trace_;
+}
+
+const util::PhaseStats& Application::GetTickStats() const noexcept {
+    return tick_stats_;
+}
+
+const util::PhaseStats& Application::GetStateSavingStats() const noexcept {
+    return state_saving_stats_;
+}
+
+util::ScopedTimer Application::MeasureStateSaving() {
+    return util::ScopedTimer{state_saving_stats_, trace_.IsRecording() ? &trace_ : nullptr, "SaveState"sv, 0};
+}
+
+void Application::UpdateGameSessions(int delta) {
+    auto* trace = trace_.IsRecording() ? &trace_ : nullptr;
+    for (const auto& session : game_->GetGameSessions()) {
+        session->UpdateGameState(delta, trace);
     }
 }
 
 const JoinGameResult& Application::JoinGame(const std::string& name, const model::Map::Id& id) {
+    return JoinGame(name, id, nullptr);
+}
+
+const JoinGameResult& Application::JoinGame(const std::string& name, const model::Map::Id& id, const Token& token) {
+    return JoinGame(name, id, &token);
+}
+
+const JoinGameResult& Application::JoinGame(const std::string& name, const model::Map::Id& id, const Token* token) {
     if (name.empty()) {
         throw ApplicationError{"invalidArgument", "Invalid name"};
-    } else if (auto session = game_->FindGameSession(id); session) {
-        MakeJoinGameResult(name, session);
-        return result_;
-    } else if (const model::Map* map = game_->FindMap(id); map) {
-        game_->AddGameSession(map);
-        if (auto session = game_->FindGameSession(id); session) {
-            MakeJoinGameResult(name, session);
-            return result_;
-        } else {
-            throw ApplicationError{"mapNotFound", "Map not found"};
-        }
-    } else {
+    }
+    auto map = game_->FindMap(id);
+    if (!map) {
         throw ApplicationError{"mapNotFound", "Map not found"};
     }
+    // When all sessions of the map are full, the player is placed in a new session of the same map
+    auto session = game_->FindVacantGameSession(id);
+    if (!session) {
+        session = game_->AddGameSession(std::move(map));
+    }
+    MakeJoinGameResult(name, session, token);
+    return result_;
 }
 
 void Application::AddPlayerAndMakeResult(const std::string& user_name,
                                          const GameSessionPtr& session,
+                                         const Token* issued_token,
                                          const geom::Point2D& start_pos,
                                          std::size_t index) {
     auto& player = players_->Add(session, session->AddDog(user_name, start_pos, index));
-    auto token_tmp = player_tokens_->Add(player);
-    result_.player_token = std::move(*token_tmp);
+    Token token;
+    if (issued_token) {
+        token = *issued_token;
+        player_tokens_->SetTokenToPlayer(token, &player);
+    } else {
+        token = player_tokens_->Add(player);
+    }
+    result_.player_token = token.ToHex();
     result_.player_id = *player.GetDog()->GetId();
+    if (input_log_) {
+        input_log_->WriteJoin(user_name, *session->GetMap()->GetId(), token);
+    }
 }
 
-void Application::MakeJoinGameResult(const std::string& user_name, const GameSessionPtr& session) {
+void Application::MakeJoinGameResult(const std::string& user_name, const GameSessionPtr& session, const Token* token) {
     const auto& roads = session->GetMap()->GetRoads();
     if (random_positions_) {
-        std::size_t index = model::GetRandomIndex(roads.size());
-        AddPlayerAndMakeResult(user_name, session, model::GetRandomPosition(roads.at(index)), index);
+        auto& engine = session->GetRandomEngine();
+        std::size_t index = session->GetMap()->GetRandomRoadIndex(engine);
+        AddPlayerAndMakeResult(user_name, session, token, model::GetRandomPosition(roads.at(index), engine), index);
     } else {
-        AddPlayerAndMakeResult(user_name, session, {static_cast<double>(roads.at(0).GetStart().x), static_cast<double>(roads.at(0).GetStart().y)}, 0);
+        AddPlayerAndMakeResult(user_name, session, token, {static_cast<double>(roads.at(0).GetStart().x), static_cast<double>(roads.at(0).GetStart().y)}, 0);
     }
 }
 
-PlayerPtr Application::PlayerAuthorization(const std::string& credentials) {
-    if (credentials.empty() || !(credentials.starts_with("Bearer ")) || credentials.size() != 39) {
+PlayerHandle Application::PlayerAuthorization(const std::string& credentials) {
+    using namespace std::literals;
+    static constexpr auto prefix = "Bearer "sv;
+    std::string_view header{credentials};
+    if (!header.starts_with(prefix) || header.size() != prefix.size() + Token::HEX_SIZE) {
         throw ApplicationError{"invalidToken", "Authorization header is missing"};
     }
-    Token token(std::move(credentials.substr(7)));
-    auto player = player_tokens_->FindPlayerByToken(token);
+    // The token is decoded directly from the header without copying it
+    return FindPlayer(header.substr(prefix.size()));
+}
+
+PlayerHandle Application::FindPlayer(std::string_view token) {
+    PlayerHandle player = nullptr;
+    if (auto binary_token = Token::FromHex(token); binary_token) {
+        player = player_tokens_->FindPlayerByToken(*binary_token);
+    }
     if (!player) {
         throw ApplicationError{"unknownToken", "Player token has not been found"};
     }
     return player;
 }
 
+void Application::ApplyPlayerAction(PlayerHandle player, const std::string& dir) {
+    const auto& dog = player->GetDog();
+    const double dog_speed = player->GetGameSession()->GetMap()->GetDogSpeed();
+    if (dir.empty()) {
+        dog->SetSpeed({0., 0.});
+    } else if (dir == "L") {
+        dog->SetDirection(model::Dog::Direction::WEST);
+        dog->SetSpeed({-dog_speed, 0.});
+    } else if (dir == "R") {
+        dog->SetDirection(model::Dog::Direction::EAST);
+        dog->SetSpeed({dog_speed, 0.});
+    } else if (dir == "U") {
+        dog->SetDirection(model::Dog::Direction::NORTH);
+        dog->SetSpeed({0., -dog_speed});
+    } else if (dir == "D") {
+        dog->SetDirection(model::Dog::Direction::SOUTH);
+        dog->SetSpeed({0., dog_speed});
+    } else {
+        throw ApplicationError{"invalidArgument", "Failed to parse action"};
+    }
+}
+
+void Application::RecordPlayerAction(std::string_view token, const std::string& dir) {
+    if (!input_log_) {
+        return;
+    }
+    if (auto binary_token = Token::FromHex(token); binary_token) {
+        input_log_->WriteAction(*binary_token, dir);
+    }
+}
+
 }  // namespace app
@@ -2,26 +2,25 @@
 
 #include <algorithm>
 #include <chrono>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <functional>
 #include <map>
+#include <string_view>
 #include <vector>
 
 
 #include <boost/signals2.hpp>
 
+#include "input_log.h"
+#include "token.h"
 #include "../model/model.h"
+#include "../util/open_addressing_map.h"
+#include "../util/profiler.h"
 
 namespace app {
 
-namespace detail {
-
-struct TokenTag {};
-
-}  // namespace detail
-
-using Token = util::Tagged<std::string, detail::TokenTag>;
 using GameSessionPtr = std::shared_ptr<model::GameSession>;
 using DogPtr = std::shared_ptr<model::Dog>;
 using GameState = model::GameState;
@@ -42,20 +41,20 @@ private:
     DogPtr dog_;
 };
 
-using PlayerPtr = std::shared_ptr<Player>;
+// Players are owned by Players only, other tables refer to them through stable handles
+using PlayerHandle = const Player*;
 
 class PlayerTokens {
 public:
-    using TokenHasher = util::TaggedHasher<Token>;
-    using TokenToPlayer = std::unordered_map<Token, PlayerPtr, TokenHasher>;
+    using TokenToPlayer = util::OpenAddressingMap<Token, PlayerHandle, TokenHasher>;
 
-    Token Add(Player& player);
+    Token Add(const Player& player);
 
-    PlayerPtr FindPlayerByToken(const Token& token);
+    PlayerHandle FindPlayerByToken(const Token& token) const;
 
     const TokenToPlayer& GetTokenToPlayer() const;
 
-    void SetTokenToPlayer(const Token& token, const PlayerPtr& player);
+    void SetTokenToPlayer(const Token& token, PlayerHandle player);
 
 private:
     std::random_device random_device_;
@@ -73,23 +72,24 @@ private:
 
 class Players {
 public:
-    using AddedPlayers = std::vector<Player>;
+    // Deque never relocates its elements, so handles to players stay valid as it grows
+    using AddedPlayers = std::deque<Player>;
     using PlayerList = std::map<std::uint32_t, std::string>;
     using CRefPlayerList = std::reference_wrapper<const PlayerList>;
-    using MapIdHasher = util::TaggedHasher<model::Map::Id>;
-    using MapIdToPlayerList = std::unordered_map<model::Map::Id, PlayerList, MapIdHasher>;
+    using SessionIdHasher = util::TaggedHasher<model::GameSession::Id>;
+    using SessionIdToPlayerList = std::unordered_map<model::GameSession::Id, PlayerList, SessionIdHasher>;
 
     Player& Add(const GameSessionPtr& session, const DogPtr& dog);
 
-    std::optional<CRefPlayerList> FindPlayerList(const model::Map::Id& id) const;
+    std::optional<CRefPlayerList> FindPlayerList(const model::GameSession::Id& id) const;
 
-    const MapIdToPlayerList& GetMapIdToPlayerList() const;
+    const SessionIdToPlayerList& GetSessionIdToPlayerList() const;
 
     const AddedPlayers& GetAddedPlayers() const;
 
 private:
     AddedPlayers players_;
-    MapIdToPlayerList map_id_to_player_list_;
+    SessionIdToPlayerList session_id_to_player_list_;
 };
 
 class ApplicationError : public std::exception {
@@ -112,6 +112,20 @@ struct JoinGameResult {
     std::uint32_t player_id;
 };
 
+struct PlayerAction {
+    std::string token;
+    std::string move;
+};
+
+struct PlayerActionError {
+    std::size_t index;
+    std::string code;
+    std::string message;
+};
+
+using PlayerActions = std::vector<PlayerAction>;
+using PlayerActionErrors = std::vector<PlayerActionError>;
+
 class Application {
 public:
     using TickSignal = sig::signal<void(milliseconds delta)>;
@@ -120,7 +134,8 @@ public:
     using PlayersPtr = std::unique_ptr<Players>;
     using PlayerTokensPtr = std::unique_ptr<PlayerTokens>;
 
-    Application(GamePtr game, bool random_positions);
+    // max_session_players limits the number of players in one game session, 0 means no limit
+    Application(GamePtr game, bool random_positions, std::size_t max_session_players = 0);
 
     Application(const Application&) = delete;
     Application& operator=(const Application&) = delete;
@@ -141,10 +156,36 @@ public:
 
     void SetPlayerAction(const std::string& credentials, const std::string& dir);
 
+    PlayerActionErrors SetPlayerActions(const PlayerActions& actions);
+
     void UpdateGameState(int delta);
 
+    // Makes the simulation advance in steps of a fixed length, the rest of a tick is carried over
+    // to the next one. Zero step turns the mode off
+    void SetFixedTimeStep(milliseconds step);
+
+    // The rest of the ticks that has not been simulated yet in the fixed time step mode
+    milliseconds GetPendingTime() const noexcept;
+    void SetPendingTime(milliseconds pending_time) noexcept;
+
+    // Joins, actions and ticks are recorded to the log while it is set
+    void SetInputLog(InputLogWriter* input_log);
+
+    // Ticks and the phases of session updates are added to the trace while it is recording
+    util::TraceRecorder& GetTraceRecorder() noexcept;
+    const util::TraceRecorder& GetTraceRecorder() const noexcept;
+
+    const util::PhaseStats& GetTickStats() const noexcept;
+    const util::PhaseStats& GetStateSavingStats() const noexcept;
+
+    // Measures saving of the state until the returned timer is destroyed
+    [[nodiscard]] util::ScopedTimer MeasureStateSaving();
+
     const JoinGameResult& JoinGame(const std::string& name, const model::Map::Id& id);
 
+    // Joins the player with the token issued to them before, e.g. when the journal is replayed
+    const JoinGameResult& JoinGame(const std::string& name, const model::Map::Id& id, const Token& token);
+
 
 private:
     GamePtr game_;
@@ -153,15 +194,33 @@ private:
     bool random_positions_;
     TickSignal tick_signal_;
     JoinGameResult result_;
+    milliseconds fixed_time_step_{0};
+    milliseconds pending_time_{0};
+    InputLogWriter* input_log_ = nullptr;
+    util::TraceRecorder trace_;
+    util::PhaseStats tick_stats_;
+    util::PhaseStats state_saving_stats_;
 
+    const JoinGameResult& JoinGame(const std::string& name, const model::Map::Id& id, const Token* token);
+
+    // A new token is issued when the token is not given
     void AddPlayerAndMakeResult(const std::string& user_name,
                                     const GameSessionPtr& session,
+                                    const Token* token,
                                     const geom::Point2D& start_pos,
                                     std::size_t index);
 
-    void MakeJoinGameResult(const std::string& user_name, const GameSessionPtr& session);
+    void MakeJoinGameResult(const std::string& user_name, const GameSessionPtr& session, const Token* token);
+
+    PlayerHandle PlayerAuthorization(const std::string& credentials);
+
+    PlayerHandle FindPlayer(std::string_view token);
+
+    void ApplyPlayerAction(PlayerHandle player, const std::string& dir);
+
+    void RecordPlayerAction(std::string_view token, const std::string& dir);
 
-    PlayerPtr PlayerAuthorization(const std::string& credentials);
+    void UpdateGameSessions(int delta);
 
 };
 
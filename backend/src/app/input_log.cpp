@@ -0,0 +1,199 @@
+#include "input_log.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "app.h"
+
+namespace app {
+
+namespace {
+
+constexpr char MAGIC[] = {'G', 'S', 'I', 'L'};
+
+}  // namespace
+
+InputLogWriter::InputLogWriter(std::ostream& out, const InputLogHeader& header)
+    : out_{out} {
+    out_.write(MAGIC, sizeof(MAGIC));
+    WriteU32(VERSION);
+    WriteU64(header.random_seed);
+    WriteU32(header.fixed_time_step);
+    WriteU32(header.max_session_players);
+    WriteU8(header.random_positions ? 1u : 0u);
+}
+
+void InputLogWriter::WriteJoin(std::string_view name, std::string_view map_id, const Token& token) {
+    WriteType(InputRecordType::JOIN);
+    WriteString(name);
+    WriteString(map_id);
+    WriteToken(token);
+}
+
+void InputLogWriter::WriteAction(const Token& token, std::string_view move) {
+    WriteType(InputRecordType::ACTION);
+    WriteToken(token);
+    WriteString(move);
+}
+
+void InputLogWriter::WriteTick(std::int64_t delta) {
+    WriteType(InputRecordType::TICK);
+    WriteU64(static_cast<std::uint64_t>(delta));
+}
+
+void InputLogWriter::Flush() {
+    out_.flush();
+}
+
+void InputLogWriter::WriteType(InputRecordType type) {
+    WriteU8(static_cast<std::uint8_t>(type));
+}
+
+void InputLogWriter::WriteU8(std::uint8_t value) {
+    out_.put(static_cast<char>(value));
+}
+
+void InputLogWriter::WriteU32(std::uint32_t value) {
+    char bytes[sizeof(value)];
+    for (std::size_t i = 0; i != sizeof(value); ++i) {
+        bytes[i] = static_cast<char>(value >> (i * 8));
+    }
+    out_.write(bytes, sizeof(bytes));
+}
+
+void InputLogWriter::WriteU64(std::uint64_t value) {
+    char bytes[sizeof(value)];
+    for (std::size_t i = 0; i != sizeof(value); ++i) {
+        bytes[i] = static_cast<char>(value >> (i * 8));
+    }
+    out_.write(bytes, sizeof(bytes));
+}
+
+void InputLogWriter::WriteString(std::string_view str) {
+    WriteU32(static_cast<std::uint32_t>(str.size()));
+    out_.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+void InputLogWriter::WriteToken(const Token& token) {
+    out_.write(reinterpret_cast<const char*>(token.GetBytes().data()), Token::SIZE);
+}
+
+InputLogReader::InputLogReader(std::istream& in)
+    : in_{in} {
+    char magic[sizeof(MAGIC)];
+    ReadBytes(magic, sizeof(magic));
+    if (!std::equal(std::begin(magic), std::end(magic), std::begin(MAGIC))) {
+        throw std::runtime_error("Not an input log");
+    }
+    if (ReadU32() != InputLogWriter::VERSION) {
+        throw std::runtime_error("Unsupported input log version");
+    }
+    header_.random_seed = ReadU64();
+    header_.fixed_time_step = ReadU32();
+    header_.max_session_players = ReadU32();
+    header_.random_positions = ReadU8() != 0;
+}
+
+const InputLogHeader& InputLogReader::GetHeader() const noexcept {
+    return header_;
+}
+
+ReplayStats InputLogReader::Replay(Application& app, bool keep_tokens) {
+    using namespace std::literals;
+    ReplayStats stats;
+    std::unordered_map<Token, std::string, TokenHasher> recorded_to_credentials;
+    InputRecordType type;
+    while (ReadType(type)) {
+        if (type == InputRecordType::JOIN) {
+            const auto name = ReadString();
+            const auto map_id = ReadString();
+            const auto token = ReadToken();
+            try {
+                const auto& result = keep_tokens ? app.JoinGame(name, model::Map::Id{map_id}, token)
+                                                 : app.JoinGame(name, model::Map::Id{map_id});
+                recorded_to_credentials[token] = "Bearer "s + result.player_token;
+                ++stats.joins;
+            } catch (const ApplicationError&) {
+                ++stats.rejected;
+            }
+        } else if (type == InputRecordType::ACTION) {
+            const auto token = ReadToken();
+            const auto move = ReadString();
+            auto it = recorded_to_credentials.find(token);
+            if (it == recorded_to_credentials.end()) {
+                if (!keep_tokens) {
+                    throw std::runtime_error("Input log refers to a player that has not joined");
+                }
+                it = recorded_to_credentials.emplace(token, "Bearer "s + token.ToHex()).first;
+            }
+            try {
+                app.SetPlayerAction(it->second, move);
+                ++stats.actions;
+            } catch (const ApplicationError&) {
+                ++stats.rejected;
+            }
+        } else if (type == InputRecordType::TICK) {
+            app.UpdateGameState(static_cast<int>(static_cast<std::int64_t>(ReadU64())));
+            ++stats.ticks;
+        } else {
+            throw std::runtime_error("Unknown input log record");
+        }
+    }
+    return stats;
+}
+
+bool InputLogReader::ReadType(InputRecordType& type) {
+    const auto value = in_.get();
+    if (value == std::istream::traits_type::eof()) {
+        return false;
+    }
+    type = static_cast<InputRecordType>(static_cast<std::uint8_t>(value));
+    return true;
+}
+
+std::uint8_t InputLogReader::ReadU8() {
+    char byte;
+    ReadBytes(&byte, 1);
+    return static_cast<std::uint8_t>(byte);
+}
+
+std::uint32_t InputLogReader::ReadU32() {
+    unsigned char bytes[sizeof(std::uint32_t)];
+    ReadBytes(reinterpret_cast<char*>(bytes), sizeof(bytes));
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i != sizeof(bytes); ++i) {
+        value |= static_cast<std::uint32_t>(bytes[i]) << (i * 8);
+    }
+    return value;
+}
+
+std::uint64_t InputLogReader::ReadU64() {
+    unsigned char bytes[sizeof(std::uint64_t)];
+    ReadBytes(reinterpret_cast<char*>(bytes), sizeof(bytes));
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i != sizeof(bytes); ++i) {
+        value |= static_cast<std::uint64_t>(bytes[i]) << (i * 8);
+    }
+    return value;
+}
+
+std::string InputLogReader::ReadString() {
+    std::string str(ReadU32(), '\0');
+    ReadBytes(str.data(), str.size());
+    return str;
+}
+
+Token InputLogReader::ReadToken() {
+    Token::Bytes bytes;
+    ReadBytes(reinterpret_cast<char*>(bytes.data()), bytes.size());
+    return Token{bytes};
+}
+
+void InputLogReader::ReadBytes(char* data, std::size_t size) {
+    if (!in_.read(data, static_cast<std::streamsize>(size))) {
+        throw InputLogTruncatedError("Input log is truncated");
+    }
+}
+
+}  // namespace app
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "token.h"
+
+namespace app {
+
+class Application;
+
+// Binary log of everything that changes the game from outside: joins, player actions and ticks.
+// Together with the random seed in its header it is enough to repeat a run of the server offline.
+// All numbers are stored in little-endian order, strings are prefixed with their 32-bit length.
+//
+// header:  "GSIL" u32 version, u64 random seed, u32 fixed time step, u32 max session players, u8 random positions
+// records: u8 type followed by
+//          JOIN   - string name, string map id, 16 bytes of the token issued to the player
+//          ACTION - 16 bytes of the player token, string move
+//          TICK   - i64 delta in milliseconds
+struct InputLogHeader {
+    std::uint64_t random_seed = 0;
+    // 0 means that the simulation advances by the whole tick delta
+    std::uint32_t fixed_time_step = 0;
+    std::uint32_t max_session_players = 0;
+    bool random_positions = false;
+};
+
+enum class InputRecordType : std::uint8_t {
+    JOIN = 1,
+    ACTION = 2,
+    TICK = 3
+};
+
+class InputLogWriter {
+public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    // The stream must outlive the writer, the header is written immediately
+    InputLogWriter(std::ostream& out, const InputLogHeader& header);
+
+    void WriteJoin(std::string_view name, std::string_view map_id, const Token& token);
+    void WriteAction(const Token& token, std::string_view move);
+    void WriteTick(std::int64_t delta);
+
+    void Flush();
+
+private:
+    std::ostream& out_;
+
+    void WriteType(InputRecordType type);
+    void WriteU8(std::uint8_t value);
+    void WriteU32(std::uint32_t value);
+    void WriteU64(std::uint64_t value);
+    void WriteString(std::string_view str);
+    void WriteToken(const Token& token);
+};
+
+struct ReplayStats {
+    std::size_t joins = 0;
+    std::size_t actions = 0;
+    std::size_t ticks = 0;
+    // Records that failed the same way they may have failed on the server, e.g. a join to an unknown map
+    std::size_t rejected = 0;
+};
+
+// Thrown when the log ends in the middle of the header or of a record, e.g. when the server stopped while writing it
+class InputLogTruncatedError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class InputLogReader {
+public:
+    // Reads the header, throws std::runtime_error if the stream does not contain an input log
+    explicit InputLogReader(std::istream& in);
+
+    const InputLogHeader& GetHeader() const noexcept;
+
+    // Applies all remaining records to the application. Tokens issued during the replay differ
+    // from the recorded ones, so actions are redirected to the players created by the replayed joins.
+    // The application must be configured from the header and must not have players yet.
+    // With keep_tokens the players get the recorded tokens back and actions may refer to players
+    // that the application already has, which continues a restored state from a journal
+    ReplayStats Replay(Application& app, bool keep_tokens = false);
+
+private:
+    std::istream& in_;
+    InputLogHeader header_;
+
+    bool ReadType(InputRecordType& type);
+    std::uint8_t ReadU8();
+    std::uint32_t ReadU32();
+    std::uint64_t ReadU64();
+    std::string ReadString();
+    Token ReadToken();
+    void ReadBytes(char* data, std::size_t size);
+};
+
+}  // namespace app
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace app {
+
+// 128-bit player token. It is stored in binary form and is only converted to
+// its textual representation (32 lowercase hex digits) at the API boundary
+class Token {
+public:
+    static constexpr std::size_t SIZE = 16;
+    static constexpr std::size_t HEX_SIZE = SIZE * 2;
+    using Bytes = std::array<std::uint8_t, SIZE>;
+
+    Token() = default;
+
+    explicit Token(const Bytes& bytes) noexcept
+        : bytes_{bytes} {
+    }
+
+    // The high part goes first, so the hex form matches the two numbers printed one after another
+    Token(std::uint64_t high, std::uint64_t low) noexcept {
+        for (std::size_t i = 0; i != SIZE / 2; ++i) {
+            bytes_[SIZE / 2 - 1 - i] = static_cast<std::uint8_t>(high >> (i * 8));
+            bytes_[SIZE - 1 - i] = static_cast<std::uint8_t>(low >> (i * 8));
+        }
+    }
+
+    // Returns nullopt if the string is not exactly HEX_SIZE lowercase hex digits. Tokens are issued in lowercase,
+    // so a token with its case changed is another string and must not authorize the same player
+    static std::optional<Token> FromHex(std::string_view hex) noexcept {
+        if (hex.size() != HEX_SIZE) {
+            return std::nullopt;
+        }
+        Token token;
+        for (std::size_t i = 0; i != SIZE; ++i) {
+            const int high = HexDigitValue(hex[i * 2]);
+            const int low = HexDigitValue(hex[i * 2 + 1]);
+            if (high < 0 || low < 0) {
+                return std::nullopt;
+            }
+            token.bytes_[i] = static_cast<std::uint8_t>((high << 4) | low);
+        }
+        return token;
+    }
+
+    // Writes exactly HEX_SIZE characters, no terminating zero is added
+    void ToHex(char* out) const noexcept {
+        static constexpr char digits[] = "0123456789abcdef";
+        for (std::size_t i = 0; i != SIZE; ++i) {
+            out[i * 2] = digits[bytes_[i] >> 4];
+            out[i * 2 + 1] = digits[bytes_[i] & 0x0F];
+        }
+    }
+
+    std::string ToHex() const {
+        std::string hex(HEX_SIZE, '\0');
+        ToHex(hex.data());
+        return hex;
+    }
+
+    const Bytes& GetBytes() const noexcept {
+        return bytes_;
+    }
+
+    auto operator<=>(const Token&) const = default;
+
+private:
+    Bytes bytes_{};
+
+    static int HexDigitValue(char c) noexcept {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        return -1;
+    }
+};
+
+struct TokenHasher {
+    std::size_t operator()(const Token& token) const noexcept {
+        // Tokens are generated randomly, so any 8 of their bytes are already well distributed
+        std::uint64_t hash;
+        std::memcpy(&hash, token.GetBytes().data(), sizeof(hash));
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+}  // namespace app
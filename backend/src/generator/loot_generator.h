@@ -1,23 +1,24 @@
 #pragma once
 
 #include <chrono>
-#include <functional>
+
+#include "../util/random.h"
 
 namespace loot_gen {
 
 class LootGenerator {
 public:
-    using RandomGenerator = std::function<double()>;
     using TimeInterval = std::chrono::milliseconds;
 
     // base_interval - base time interval > 0
     // probability - probability of a loot appearing during the base time interval
-    // random_generator - random number generator in the range [0 to 1]
+    // random_engine - source of a random factor in the range [0 to 1) of the probability, the factor is 1 without it.
+    // The engine is not owned and must outlive the generator
     LootGenerator(TimeInterval base_interval, double probability,
-                  RandomGenerator random_gen = DefaultGenerator)
+                  util::RandomEngine* random_engine = nullptr) noexcept
         : base_interval_{base_interval}
         , probability_{probability}
-        , random_generator_{std::move(random_gen)} {
+        , random_engine_{random_engine} {
     }
 
     // Returns the number of loot items that should appear on the map after
@@ -29,14 +30,20 @@ public:
     // looter_count - number of looters on the map
     unsigned Generate(TimeInterval time_delta, unsigned loot_count, unsigned looter_count);
 
+    // Time accumulated since loot was generated last time
+    TimeInterval GetTimeWithoutLoot() const noexcept {
+        return time_without_loot_;
+    }
+
+    void SetTimeWithoutLoot(TimeInterval time_without_loot) noexcept {
+        time_without_loot_ = time_without_loot;
+    }
+
 private:
-    static double DefaultGenerator() noexcept {
-        return 1.0;
-    };
     TimeInterval base_interval_;
     double probability_;
     TimeInterval time_without_loot_{};
-    RandomGenerator random_generator_;
+    util::RandomEngine* random_engine_;
 };
 
 }  // namespace loot_gen
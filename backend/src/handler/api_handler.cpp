@@ -2,6 +2,51 @@
 
 namespace api_handler {
 
+namespace {
+
+void UpdateGameStateWithMetrics(app::Application& app, metrics::Registry& registry, int delta) {
+    const auto start = std::chrono::steady_clock::now();
+    app.UpdateGameState(delta);
+    registry.RecordTick(std::chrono::steady_clock::now() - start);
+
+    const auto& sessions = app.GetGame()->GetGameSessions();
+    std::size_t dogs = 0;
+    std::size_t lost_objects = 0;
+    for (const auto& session : sessions) {
+        dogs += session->GetDogs().size();
+        if (session->GetLoot()) {
+            lost_objects += session->GetLoot()->GetLostObjects().size();
+        }
+    }
+    registry.SetGameState(sessions.size(), dogs, lost_objects);
+}
+
+double ToMicroseconds(util::PhaseStats::Duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+json::object GetJsonPhaseStats(const util::PhaseStats& stats) {
+    json::object json_stats;
+    json_stats["count"] = stats.GetCount();
+    json_stats["totalUs"] = ToMicroseconds(stats.GetTotal());
+    json_stats["meanUs"] = ToMicroseconds(stats.GetMean());
+    json_stats["maxUs"] = ToMicroseconds(stats.GetMax());
+    json_stats["lastUs"] = ToMicroseconds(stats.GetLast());
+    return json_stats;
+}
+
+json::object MakeTrackName(std::uint32_t track, const std::string& name) {
+    json::object event;
+    event["name"] = "thread_name";
+    event["ph"] = "M";
+    event["pid"] = 1;
+    event["tid"] = track;
+    event["args"] = json::object{{"name", name}};
+    return event;
+}
+
+}  // namespace
+
 MapsApiHandler::MapsApiHandler(app::Application& app)
     : app_{app} {
 }
@@ -17,12 +62,12 @@ StringResponse MapsApiHandler::Handle(const StringRequest& request) const {
 }
 
 StringResponse MapsApiHandler::GetMaps(unsigned version, bool keep_alive) const {
-    const std::vector<model::Map>& maps = app_.GetGame()->GetMaps();
+    const auto& maps = app_.GetGame()->GetMaps();
     boost::json::array json_maps;
     for (const auto& map : maps) {
         boost::json::object json_map;
-        json_map["id"] = boost::json::value_from(*map.GetId());
-        json_map["name"] = map.GetName();
+        json_map["id"] = boost::json::value_from(*map->GetId());
+        json_map["name"] = map->GetName();
         json_maps.push_back(json_map);
     }
     StringResponse response;
@@ -98,7 +143,7 @@ json::array MapByIdApiHandler::GetJsonOffices(const model::Map::Offices& offices
 }
 
 StringResponse MapByIdApiHandler::GetMapById(const std::string& map_id, unsigned version, bool keep_alive) const {
-    const model::Map* map = app_.GetGame()->FindMap(model::Map::Id(map_id));
+    const auto map = app_.GetGame()->FindMap(model::Map::Id(map_id));
     if (!map) {
         return MakeNotFoundError(version, keep_alive, "mapNotFound", "Map not found");
     }
@@ -369,11 +414,72 @@ StringResponse PlayerActionApiHandler::SetPlayerAction(unsigned version,
     return MakeBadRequestError(version, keep_alive, "invalidArgument", "Invalid content type");
 }
 
-TickApiHandler::TickApiHandler(app::Application& app, bool is_state_file_set, bool is_save_state_period_set, bool is_tick_period_set)
+PlayerActionsApiHandler::PlayerActionsApiHandler(app::Application& app)
+    : app_{app} {
+}
+
+StringResponse PlayerActionsApiHandler::Handle(const StringRequest& request) const {
+    auto version = request.version();
+    auto keep_alive = request.keep_alive();
+    auto method = request.method();
+    if (auto error = CheckPostMethod(version, keep_alive, method); error) {
+        return *error;
+    }
+    json::array request_body;
+    try {
+        request_body = boost::json::parse(request.body()).as_array();
+    } catch (const std::exception&) {
+        return MakeBadRequestError(version, keep_alive, "invalidArgument", "Failed to parse batch action request JSON");
+    }
+    return SetPlayerActions(version, keep_alive, request_body);
+}
+
+StringResponse PlayerActionsApiHandler::SetPlayerActions(unsigned version,
+                                                         bool keep_alive,
+                                                         const json::array& request_body) const {
+    app::PlayerActions actions;
+    actions.reserve(request_body.size());
+    try {
+        for (const auto& json_action : request_body) {
+            const auto& action = json_action.as_object();
+            actions.push_back({std::string{action.at("token").as_string()}, std::string{action.at("move").as_string()}});
+        }
+    } catch (const std::exception&) {
+        return MakeBadRequestError(version, keep_alive, "invalidArgument", "Invalid content type");
+    }
+
+    // All actions of the batch are applied within a single pass through the API strand
+    const auto errors = app_.SetPlayerActions(actions);
+
+    json::array json_errors;
+    for (const auto& error : errors) {
+        json::object json_error;
+        json_error["index"] = error.index;
+        json_error["code"] = error.code;
+        json_error["message"] = error.message;
+        json_errors.push_back(std::move(json_error));
+    }
+    json::object json_response;
+    json_response["applied"] = actions.size() - errors.size();
+    json_response["errors"] = std::move(json_errors);
+
+    StringResponse response;
+    response.version(version);
+    response.keep_alive(keep_alive);
+    response.result(http::status::ok);
+    response.set(http::field::content_type, "application/json"sv);
+    response.set(http::field::cache_control, "no-cache");
+    response.body() = boost::json::serialize(json_response);
+    response.content_length(response.body().size());
+    return response;
+}
+
+TickApiHandler::TickApiHandler(app::Application& app, bool is_state_file_set, bool is_save_state_period_set, bool is_tick_period_set, metrics::Registry& metrics)
     : app_{app}
     , is_state_file_set_{is_state_file_set_}
     , is_save_state_period_set_{is_save_state_period_set}
-    , is_tick_period_set_{is_tick_period_set} {
+    , is_tick_period_set_{is_tick_period_set}
+    , metrics_{metrics} {
 }
 
 StringResponse TickApiHandler::Handle(const StringRequest& request) const {
@@ -402,7 +508,7 @@ StringResponse TickApiHandler::Handle(const StringRequest& request) const {
 }
 
 StringResponse TickApiHandler::UpdateGameState(unsigned version, bool keep_alive, int delta) const {
-    app_.UpdateGameState(delta);
+    UpdateGameStateWithMetrics(app_, metrics_, delta);
     if (!is_state_file_set_ && is_save_state_period_set_) {
         app_.Tick(milliseconds(delta));
     }
@@ -418,6 +524,167 @@ StringResponse TickApiHandler::UpdateGameState(unsigned version, bool keep_alive
     return response;
 }
 
+ProfileApiHandler::ProfileApiHandler(app::Application& app)
+    : app_{app} {
+}
+
+StringResponse ProfileApiHandler::Handle(const StringRequest& request) const {
+    auto version = request.version();
+    auto keep_alive = request.keep_alive();
+    auto method = request.method();
+    if (auto error = CheckGetOrHeadMethod(version, keep_alive, method); error) {
+        return *error;
+    }
+    return GetProfile(version, keep_alive);
+}
+
+StringResponse ProfileApiHandler::GetProfile(unsigned version, bool keep_alive) const {
+    json::array json_sessions;
+    for (const auto& session : app_.GetGame()->GetGameSessions()) {
+        json::object json_phases;
+        const auto& stats = session->GetTickPhaseStats();
+        for (std::size_t i = 0; i != model::TICK_PHASE_COUNT; ++i) {
+            json_phases[model::GetTickPhaseName(static_cast<model::TickPhase>(i))] = GetJsonPhaseStats(stats[i]);
+        }
+        json::object json_session;
+        json_session["id"] = *session->GetId();
+        json_session["mapId"] = *session->GetMap()->GetId();
+        // Sessions on a replaced version of the map take no new players
+        json_session["mapIsCurrent"] = session->GetMap() == app_.GetGame()->FindMap(session->GetMap()->GetId()).get();
+        json_session["dogs"] = session->GetDogs().size();
+        json_session["phases"] = std::move(json_phases);
+        json_sessions.push_back(std::move(json_session));
+    }
+    json::object json_response;
+    json_response["mapsVersion"] = app_.GetGame()->GetMapsVersion();
+    json_response["tick"] = GetJsonPhaseStats(app_.GetTickStats());
+    json_response["saveState"] = GetJsonPhaseStats(app_.GetStateSavingStats());
+    json_response["sessions"] = std::move(json_sessions);
+
+    StringResponse response;
+    response.version(version);
+    response.keep_alive(keep_alive);
+    response.result(http::status::ok);
+    response.set(http::field::content_type, "application/json"sv);
+    response.set(http::field::cache_control, "no-cache");
+    response.body() = boost::json::serialize(json_response);
+    response.content_length(response.body().size());
+    return response;
+}
+
+TraceApiHandler::TraceApiHandler(app::Application& app)
+    : app_{app} {
+}
+
+StringResponse TraceApiHandler::Handle(const StringRequest& request) const {
+    auto version = request.version();
+    auto keep_alive = request.keep_alive();
+    auto method = request.method();
+    if (IsGetOrHeadMethod(method)) {
+        return GetTrace(version, keep_alive);
+    }
+    if (!IsPostMethod(method)) {
+        return MakeMethodNotAllowedError(version, keep_alive, "GET, HEAD, POST", "invalidMethod", "Invalid method");
+    }
+    std::int64_t ticks;
+    try {
+        ticks = boost::json::parse(request.body()).as_object().at("ticks").as_int64();
+    } catch (const std::exception&) {
+        return MakeBadRequestError(version, keep_alive, "invalidArgument", "Failed to parse trace request JSON");
+    }
+    if (ticks <= 0 || ticks > MAX_TRACE_TICKS) {
+        return MakeBadRequestError(version, keep_alive, "invalidArgument", "Number of ticks must be from 1 to "s + std::to_string(MAX_TRACE_TICKS));
+    }
+    return StartTrace(version, keep_alive, ticks);
+}
+
+StringResponse TraceApiHandler::StartTrace(unsigned version, bool keep_alive, std::int64_t ticks) const {
+    app_.GetTraceRecorder().Start(static_cast<std::size_t>(ticks));
+
+    StringResponse response;
+    response.version(version);
+    response.keep_alive(keep_alive);
+    response.result(http::status::ok);
+    response.set(http::field::content_type, "application/json"sv);
+    response.set(http::field::cache_control, "no-cache");
+    response.body() = boost::json::serialize(json::object{{"ticks", ticks}});
+    response.content_length(response.body().size());
+    return response;
+}
+
+StringResponse TraceApiHandler::GetTrace(unsigned version, bool keep_alive) const {
+    const auto& trace = app_.GetTraceRecorder();
+    json::array json_events;
+    json_events.reserve(trace.GetEvents().size() + app_.GetGame()->GetGameSessions().size() + 1);
+    json_events.push_back(MakeTrackName(0, "server"s));
+    for (const auto& session : app_.GetGame()->GetGameSessions()) {
+        json_events.push_back(MakeTrackName(*session->GetId() + 1, "session "s + std::to_string(*session->GetId()) + " ("s + *session->GetMap()->GetId() + ")"s));
+    }
+    for (const auto& event : trace.GetEvents()) {
+        json::object json_event;
+        json_event["name"] = event.name;
+        json_event["ph"] = "X";
+        json_event["pid"] = 1;
+        json_event["tid"] = event.track;
+        json_event["ts"] = ToMicroseconds(event.start - trace.GetOrigin());
+        json_event["dur"] = ToMicroseconds(event.duration);
+        json_events.push_back(std::move(json_event));
+    }
+    json::object json_response;
+    json_response["traceEvents"] = std::move(json_events);
+    json_response["displayTimeUnit"] = "ms";
+    json_response["otherData"] = json::object{{"ticks", trace.GetRequestedTicks()}, {"recording", trace.IsRecording()}};
+
+    StringResponse response;
+    response.version(version);
+    response.keep_alive(keep_alive);
+    response.result(http::status::ok);
+    response.set(http::field::content_type, "application/json"sv);
+    response.set(http::field::cache_control, "no-cache");
+    response.body() = boost::json::serialize(json_response);
+    response.content_length(response.body().size());
+    return response;
+}
+
+MapsReloadApiHandler::MapsReloadApiHandler(app::Application& app, const std::function<bool()>& reload_maps)
+    : app_{app}
+    , reload_maps_{reload_maps} {
+}
+
+StringResponse MapsReloadApiHandler::Handle(const StringRequest& request) const {
+    auto version = request.version();
+    auto keep_alive = request.keep_alive();
+    auto method = request.method();
+    if (auto error = CheckPostMethod(version, keep_alive, method); error) {
+        return *error;
+    }
+    if (!reload_maps_) {
+        return MakeForbiddenError(version, keep_alive, "reloadDisabled", "Maps can't be reloaded while the input log or the journal is recorded");
+    }
+    return ReloadMaps(version, keep_alive);
+}
+
+StringResponse MapsReloadApiHandler::ReloadMaps(unsigned version, bool keep_alive) const {
+    const bool is_started = reload_maps_();
+
+    StringResponse response;
+    response.version(version);
+    response.keep_alive(keep_alive);
+    response.result(is_started ? http::status::accepted : http::status::conflict);
+    response.set(http::field::content_type, "application/json"sv);
+    response.set(http::field::cache_control, "no-cache");
+    json::object json_response;
+    if (is_started) {
+        json_response["mapsVersion"] = app_.GetGame()->GetMapsVersion();
+    } else {
+        json_response["code"] = "reloadInProgress";
+        json_response["message"] = "Maps are being reloaded";
+    }
+    response.body() = boost::json::serialize(json_response);
+    response.content_length(response.body().size());
+    return response;
+}
+
 std::shared_ptr<ApiHandler> MapsApiHandlerFactory::CreateApiHandler(ApiHandlerParams& params) const {
     return std::make_shared<MapsApiHandler>(params.ref_app);
 }
@@ -442,8 +709,24 @@ std::shared_ptr<ApiHandler> PlayerActionApiHandlerFactory::CreateApiHandler(ApiH
     return std::make_shared<PlayerActionApiHandler>(params.ref_app);
 }
 
+std::shared_ptr<ApiHandler> PlayerActionsApiHandlerFactory::CreateApiHandler(ApiHandlerParams& params) const {
+    return std::make_shared<PlayerActionsApiHandler>(params.ref_app);
+}
+
 std::shared_ptr<ApiHandler> TickApiHandlerFactory::CreateApiHandler(ApiHandlerParams& params) const {
-    return std::make_shared<TickApiHandler>(params.ref_app, params.is_state_file_set, params.is_save_state_period_set, params.is_tick_period_set);
+    return std::make_shared<TickApiHandler>(params.ref_app, params.is_state_file_set, params.is_save_state_period_set, params.is_tick_period_set, params.metrics);
+}
+
+std::shared_ptr<ApiHandler> ProfileApiHandlerFactory::CreateApiHandler(ApiHandlerParams& params) const {
+    return std::make_shared<ProfileApiHandler>(params.ref_app);
+}
+
+std::shared_ptr<ApiHandler> TraceApiHandlerFactory::CreateApiHandler(ApiHandlerParams& params) const {
+    return std::make_shared<TraceApiHandler>(params.ref_app);
+}
+
+std::shared_ptr<ApiHandler> MapsReloadApiHandlerFactory::CreateApiHandler(ApiHandlerParams& params) const {
+    return std::make_shared<MapsReloadApiHandler>(params.ref_app, params.reload_maps);
 }
 
 ApiHandlerManager::ApiHandlerManager(ApiHandlerParams& params)
@@ -454,7 +737,13 @@ ApiHandlerManager::ApiHandlerManager(ApiHandlerParams& params)
         endpoint_to_factory_["/api/v1/game/players"] = std::make_shared<PlayersApiHandlerFactory>();
         endpoint_to_factory_["/api/v1/game/state"] = std::make_shared<GameStateApiHandlerFactory>();
         endpoint_to_factory_["/api/v1/game/player/action"] = std::make_shared<PlayerActionApiHandlerFactory>();
+        endpoint_to_factory_["/api/v1/game/player/actions"] = std::make_shared<PlayerActionsApiHandlerFactory>();
         endpoint_to_factory_["/api/v1/game/tick"] = std::make_shared<TickApiHandlerFactory>();
+        if (params_.is_admin_api_enabled) {
+            endpoint_to_factory_["/api/v1/admin/profile"] = std::make_shared<ProfileApiHandlerFactory>();
+            endpoint_to_factory_["/api/v1/admin/trace"] = std::make_shared<TraceApiHandlerFactory>();
+            endpoint_to_factory_["/api/v1/admin/maps/reload"] = std::make_shared<MapsReloadApiHandlerFactory>();
+        }
 }
 
 StringResponse ApiHandlerManager::HandleApiRequest(const StringRequest& request) {
@@ -475,7 +764,7 @@ StringResponse ApiHandlerManager::HandleApiRequest(const StringRequest& request)
 }
 
 void ApiHandlerManager::Tick(int delta) {
-    params_.ref_app.UpdateGameState(delta);
+    UpdateGameStateWithMetrics(params_.ref_app, params_.metrics, delta);
     if (!params_.is_state_file_set && params_.is_save_state_period_set) {
         params_.ref_app.Tick(milliseconds(delta));
     }
@@ -98,9 +98,22 @@ private:
 
 };
 
+class PlayerActionsApiHandler : public ApiHandler {
+public:
+    PlayerActionsApiHandler(app::Application& app);
+
+    StringResponse Handle(const StringRequest& request) const override;
+
+private:
+    app::Application& app_;
+
+    StringResponse SetPlayerActions(unsigned version, bool keep_alive, const json::array& request_body) const;
+
+};
+
 class TickApiHandler : public ApiHandler {
 public:
-    TickApiHandler(app::Application& app, bool is_state_file_set, bool is_save_state_period_set, bool is_tick_period_set);
+    TickApiHandler(app::Application& app, bool is_state_file_set, bool is_save_state_period_set, bool is_tick_period_set, metrics::Registry& metrics);
 
     StringResponse Handle(const StringRequest& request) const override;
 
@@ -109,11 +122,59 @@ private:
     bool is_state_file_set_;
     bool is_save_state_period_set_;
     bool is_tick_period_set_;
+    metrics::Registry& metrics_;
 
     StringResponse UpdateGameState(unsigned version, bool keep_alive, int delta) const;
 
 };
 
+class ProfileApiHandler : public ApiHandler {
+public:
+    ProfileApiHandler(app::Application& app);
+
+    StringResponse Handle(const StringRequest& request) const override;
+
+private:
+    app::Application& app_;
+
+    StringResponse GetProfile(unsigned version, bool keep_alive) const;
+
+};
+
+class TraceApiHandler : public ApiHandler {
+public:
+    // A window longer than this is rejected to bound the memory used by the trace
+    static constexpr std::int64_t MAX_TRACE_TICKS = 10000;
+
+    TraceApiHandler(app::Application& app);
+
+    StringResponse Handle(const StringRequest& request) const override;
+
+private:
+    app::Application& app_;
+
+    StringResponse StartTrace(unsigned version, bool keep_alive, std::int64_t ticks) const;
+
+    // Returns the trace in the Chrome trace event format, it can be opened in chrome://tracing or Perfetto
+    StringResponse GetTrace(unsigned version, bool keep_alive) const;
+
+};
+
+class MapsReloadApiHandler : public ApiHandler {
+public:
+    MapsReloadApiHandler(app::Application& app, const std::function<bool()>& reload_maps);
+
+    StringResponse Handle(const StringRequest& request) const override;
+
+private:
+    app::Application& app_;
+    const std::function<bool()>& reload_maps_;
+
+    // Answers before the maps are loaded, the new version shows up in /api/v1/admin/profile
+    StringResponse ReloadMaps(unsigned version, bool keep_alive) const;
+
+};
+
 class ApiHandlerFactory {
 public:
     virtual ~ApiHandlerFactory() = default;
@@ -151,11 +212,31 @@ public:
     std::shared_ptr<ApiHandler> CreateApiHandler(ApiHandlerParams& params) const override;
 };
 
+class PlayerActionsApiHandlerFactory : public ApiHandlerFactory {
+public:
+    std::shared_ptr<ApiHandler> CreateApiHandler(ApiHandlerParams& params) const override;
+};
+
 class TickApiHandlerFactory : public ApiHandlerFactory {
 public:
     std::shared_ptr<ApiHandler> CreateApiHandler(ApiHandlerParams& params) const override;
 };
 
+class ProfileApiHandlerFactory : public ApiHandlerFactory {
+public:
+    std::shared_ptr<ApiHandler> CreateApiHandler(ApiHandlerParams& params) const override;
+};
+
+class TraceApiHandlerFactory : public ApiHandlerFactory {
+public:
+    std::shared_ptr<ApiHandler> CreateApiHandler(ApiHandlerParams& params) const override;
+};
+
+class MapsReloadApiHandlerFactory : public ApiHandlerFactory {
+public:
+    std::shared_ptr<ApiHandler> CreateApiHandler(ApiHandlerParams& params) const override;
+};
+
 class ApiHandlerManager {
 public:
     ApiHandlerManager(ApiHandlerParams& params);
@@ -8,13 +8,11 @@ namespace http_handler {
 RequestHandler::RequestHandler(api_handler::ApiHandlerManager& api_handler_manager,
                                const fs::path& root,
                                RequestHandler::Strand api_strand,
-                               detail::DurationMeasure& measure,
-                               std::function<void(const json::object&)> data_collection)
+                               metrics::Registry& metrics)
     : api_handler_manager_{api_handler_manager}
     , root_{root}
-    , measure_{measure}
     , api_strand_{api_strand}
-    , data_collection_{data_collection} {
+    , metrics_{metrics} {
 }
 
 std::string RequestHandler::UrlDecode(const std::string& path) {
@@ -120,6 +118,21 @@ StringResponse RequestHandler::ReportServerError(unsigned version, bool keep_ali
     return response;
 }
 
+StringResponse RequestHandler::MakeMetricsResponse(const StringRequest& req) const {
+    if (auto error = CheckGetOrHeadMethod(req.version(), req.keep_alive(), req.method()); error) {
+        return *error;
+    }
+    StringResponse response;
+    response.version(req.version());
+    response.keep_alive(req.keep_alive());
+    response.result(http::status::ok);
+    response.set(http::field::content_type, "text/plain; version=0.0.4"sv);
+    response.set(http::field::cache_control, "no-cache");
+    response.body() = metrics_.Serialize();
+    response.content_length(response.body().size());
+    return response;
+}
+
 RequestHandler::FileRequestResult RequestHandler::HandleFileRequest(const StringRequest& req, unsigned version, bool keep_alive) {
     std::string req_str{req.target()};
     std::string decoded_url_str = UrlDecode(req_str);
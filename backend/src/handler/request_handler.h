@@ -13,64 +13,46 @@ public:
     RequestHandler(api_handler::ApiHandlerManager& api_handler_manager,
                    const fs::path& root,
                    Strand api_strand,
-                   detail::DurationMeasure& measure,
-                   std::function<void(const json::object&)> data_collection);
+                   metrics::Registry& metrics);
 
     RequestHandler(const RequestHandler&) = delete;
     RequestHandler& operator=(const RequestHandler&) = delete;
 
+    // The response is logged and counted by the session once it has been written, using the timing of the request
     template <typename Body, typename Allocator, typename Send>
-    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req,
+                    std::shared_ptr<http_server::RequestTiming> timing, Send&& send) {
         auto version = req.version();
         auto keep_alive = req.keep_alive();
         try {
+            if (metrics::GetEndpoint(req.target()) == metrics::Endpoint::METRICS) {
+                // Metrics are read from atomics, so they are served without the API strand
+                timing->MarkHandlerStarted();
+                return send(MakeMetricsResponse(req));
+            }
             if (req.target().starts_with("/api/v1"sv)) {
-                auto handle = [self = shared_from_this(), send,
+                auto handle = [self = shared_from_this(), send, timing,
                                req = std::forward<decltype(req)>(req), version, keep_alive] {
+                    // Everything before this point is waiting for the API strand
+                    timing->MarkHandlerStarted();
                     try {
-                        json::object custom_data;
-                        self->measure_.StartMeasurement();
                         assert(self->api_strand_.running_in_this_thread());
-                        auto response = std::move(self->api_handler_manager_.HandleApiRequest(req));
-                        custom_data.emplace("response_time", self->measure_.GetDuration());
-                        custom_data.emplace("code", response.result_int());
-                        custom_data.emplace("content_type", std::string{response[http::field::content_type]});
-                        self->data_collection_(custom_data);
-                        return send(response);
+                        return send(self->api_handler_manager_.HandleApiRequest(req));
                     } catch (const std::exception& e) {
-                        json::object custom_data;
-                        self->measure_.StartMeasurement();
-                        auto response = std::move(self->ReportServerError(version, keep_alive));
-                        custom_data.emplace("response_time", self->measure_.GetDuration());
-                        custom_data.emplace("code", response.result_int());
-                        custom_data.emplace("content_type", std::string{response[http::field::content_type]});
-                        self->data_collection_(custom_data);
-                        return send(response);
+                        return send(self->ReportServerError(version, keep_alive));
                     }
                 };
 
                 return net::dispatch(api_strand_, handle);
             }
+            timing->MarkHandlerStarted();
             return std::visit(
                 [&](auto&& result) {
-                    json::object custom_data;
-                    measure_.StartMeasurement();
-                    custom_data.emplace("response_time", measure_.GetDuration());
-                    custom_data.emplace("code", result.result_int());
-                    custom_data.emplace("content_type", std::string{result[http::field::content_type]});
-                    data_collection_(custom_data);
                     send(std::forward<decltype(result)>(result));
                 },
                 HandleFileRequest(req, version, keep_alive));
         } catch (...) {
-            json::object custom_data;
-            measure_.StartMeasurement();
-            auto response = ReportServerError(version, keep_alive);
-            custom_data.emplace("response_time", measure_.GetDuration());
-            custom_data.emplace("code", response.result_int());
-            custom_data.emplace("content_type", std::string{response[http::field::content_type]});
-            data_collection_(custom_data);
-            send(response);
+            send(ReportServerError(version, keep_alive));
         }
     }
 
@@ -78,8 +60,7 @@ private:
     api_handler::ApiHandlerManager& api_handler_manager_;
     fs::path root_;
     Strand api_strand_;
-    detail::DurationMeasure& measure_;
-    std::function<void(const json::object&)> data_collection_;
+    metrics::Registry& metrics_;
 
     using FileRequestResult = std::variant<StringResponse, FileResponse>;
 
@@ -95,6 +76,8 @@ private:
 
     StringResponse ReportServerError(unsigned version, bool keep_alive) const;
 
+    StringResponse MakeMetricsResponse(const StringRequest& req) const;
+
     FileRequestResult HandleFileRequest(const StringRequest& req, unsigned version, bool keep_alive);
 };
 
@@ -1,55 +1,613 @@
 #include "json_loader.h"
 
-#include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/json/basic_parser_impl.hpp>
 
 namespace json_loader {
 
+using namespace std::literals;
+
+namespace {
+
+constexpr std::size_t MIN_ARENA_SIZE = 4 * 1024;
+
+template <typename T>
+const T& Require(const std::optional<T>& value, std::string_view name) {
+    if (!value) {
+        throw std::runtime_error("Game config has no "s + std::string{name});
+    }
+    return *value;
+}
+
+// Builds the maps from the events of json::basic_parser, so the roads, buildings and offices never become a DOM.
+// Only the loot types, which are served to clients as they are, are collected into json values.
+// Defaults may follow the maps in the file, so the maps are made once the whole document is parsed
+class GameConfigHandler {
+public:
+    static constexpr std::size_t max_object_size = std::numeric_limits<std::size_t>::max();
+    static constexpr std::size_t max_array_size = std::numeric_limits<std::size_t>::max();
+    static constexpr std::size_t max_key_size = std::numeric_limits<std::size_t>::max();
+    static constexpr std::size_t max_string_size = std::numeric_limits<std::size_t>::max();
+
+    explicit GameConfigHandler(extra_data::Payload& payload)
+        : payload_{payload} {
+    }
+
+    model::Game MakeGame();
+
+    bool on_document_begin(json::error_code&) {
+        return true;
+    }
+
+    bool on_document_end(json::error_code&) {
+        return true;
+    }
+
+    bool on_object_begin(json::error_code&) {
+        BeginContainer(true);
+        return true;
+    }
+
+    bool on_object_end(std::size_t size, json::error_code&) {
+        EndContainer(true, size);
+        return true;
+    }
+
+    bool on_array_begin(json::error_code&) {
+        BeginContainer(false);
+        return true;
+    }
+
+    bool on_array_end(std::size_t size, json::error_code&) {
+        EndContainer(false, size);
+        return true;
+    }
+
+    bool on_key_part(json::string_view part, std::size_t, json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_chars(part);
+        } else {
+            AppendPart(key_, part, key_in_parts_);
+        }
+        return true;
+    }
+
+    bool on_key(json::string_view part, std::size_t, json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_key(part);
+        } else {
+            AppendLastPart(key_, part, key_in_parts_);
+        }
+        return true;
+    }
+
+    bool on_string_part(json::string_view part, std::size_t, json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_chars(part);
+        } else {
+            AppendPart(string_, part, string_in_parts_);
+        }
+        return true;
+    }
+
+    bool on_string(json::string_view part, std::size_t, json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_string(part);
+            return true;
+        }
+        AppendLastPart(string_, part, string_in_parts_);
+        const auto field = FindField();
+        if (field.string) {
+            *field.string = std::move(string_);
+        } else {
+            CheckIgnored(field);
+        }
+        return true;
+    }
+
+    bool on_number_part(json::string_view, json::error_code&) {
+        return true;
+    }
+
+    bool on_int64(std::int64_t value, json::string_view, json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_int64(value);
+            return true;
+        }
+        const auto field = FindField();
+        if (field.integer) {
+            *field.integer = value;
+        } else if (field.number) {
+            *field.number = static_cast<double>(value);
+        } else {
+            CheckIgnored(field);
+        }
+        return true;
+    }
+
+    bool on_uint64(std::uint64_t value, json::string_view, json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_uint64(value);
+            return true;
+        }
+        // Only values above the int64 range are reported as uint64, no coordinate or capacity is that large
+        CheckIgnored(FindField());
+        return true;
+    }
+
+    bool on_double(double value, json::string_view, json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_double(value);
+            return true;
+        }
+        const auto field = FindField();
+        if (field.number) {
+            *field.number = value;
+        } else {
+            CheckIgnored(field);
+        }
+        return true;
+    }
+
+    bool on_bool(bool value, json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_bool(value);
+            return true;
+        }
+        CheckIgnored(FindField());
+        return true;
+    }
+
+    bool on_null(json::error_code&) {
+        if (IsInLootTypes()) {
+            loot_types_.push_null();
+            return true;
+        }
+        CheckIgnored(FindField());
+        return true;
+    }
+
+    bool on_comment_part(json::string_view, json::error_code&) {
+        return true;
+    }
+
+    bool on_comment(json::string_view, json::error_code&) {
+        return true;
+    }
+
+private:
+    enum class Scope {
+        ROOT,
+        LOOT_CONFIG,
+        MAPS,
+        MAP,
+        LOOT_TYPES,
+        ROADS,
+        ROAD,
+        BUILDINGS,
+        BUILDING,
+        OFFICES,
+        OFFICE,
+        // Values the game does not use, with everything nested in them
+        SKIPPED
+    };
+
+    // Where the scalar at the current position is stored, all pointers are null if it is not used
+    struct Field {
+        std::optional<std::string>* string = nullptr;
+        std::optional<std::int64_t>* integer = nullptr;
+        std::optional<double>* number = nullptr;
+
+        bool IsUsed() const noexcept {
+            return string || integer || number;
+        }
+    };
+
+    struct PendingRoad {
+        std::optional<std::int64_t> x0, y0, x1, y1;
+    };
+
+    struct PendingBuilding {
+        std::optional<std::int64_t> x, y, w, h;
+    };
+
+    struct PendingOffice {
+        std::optional<std::string> id;
+        std::optional<std::int64_t> x, y, offset_x, offset_y;
+    };
+
+    struct PendingMap {
+        std::optional<std::string> id;
+        std::optional<std::string> name;
+        std::optional<double> dog_speed;
+        std::optional<std::int64_t> bag_capacity;
+        std::optional<json::array> loot_types;
+        std::optional<model::Map::Roads> roads;
+        std::optional<std::vector<model::Building>> buildings;
+        std::optional<std::vector<model::Office>> offices;
+    };
+
+    extra_data::Payload& payload_;
+    std::vector<Scope> scopes_;
+    std::string key_;
+    bool key_in_parts_ = false;
+    std::string string_;
+    bool string_in_parts_ = false;
+    json::value_stack loot_types_;
+
+    std::optional<double> default_dog_speed_;
+    std::optional<std::int64_t> default_bag_capacity_;
+    bool has_loot_config_ = false;
+    std::optional<double> period_;
+    std::optional<double> probability_;
+    std::optional<std::vector<PendingMap>> maps_;
+    PendingRoad road_;
+    PendingBuilding building_;
+    PendingOffice office_;
+
+    // Strings and keys with escapes or split across buffers arrive in parts before the last one
+    static void AppendPart(std::string& str, json::string_view part, bool& in_parts) {
+        if (!in_parts) {
+            str.clear();
+            in_parts = true;
+        }
+        str.append(part.data(), part.size());
+    }
+
+    static void AppendLastPart(std::string& str, json::string_view part, bool& in_parts) {
+        if (!in_parts) {
+            str.clear();
+        }
+        str.append(part.data(), part.size());
+        in_parts = false;
+    }
+
+    static bool IsObjectScope(Scope scope) noexcept {
+        return scope != Scope::MAPS && scope != Scope::ROADS && scope != Scope::BUILDINGS && scope != Scope::OFFICES;
+    }
+
+    static std::string_view GetArrayName(Scope scope) noexcept {
+        switch (scope) {
+            case Scope::MAPS:
+                return "maps"sv;
+            case Scope::ROADS:
+                return "roads"sv;
+            case Scope::BUILDINGS:
+                return "buildings"sv;
+            default:
+                return "offices"sv;
+        }
+    }
+
+    bool IsInLootTypes() const noexcept {
+        return !scopes_.empty() && scopes_.back() == Scope::LOOT_TYPES;
+    }
+
+    PendingMap& GetMap() {
+        return maps_->back();
+    }
+
+    // Scope of the container that starts at the current position
+    Scope GetValueScope() const {
+        if (scopes_.empty()) {
+            return Scope::ROOT;
+        }
+        switch (scopes_.back()) {
+            case Scope::ROOT:
+                if (key_ == "lootGeneratorConfig"sv) {
+                    return Scope::LOOT_CONFIG;
+                }
+                if (key_ == "maps"sv) {
+                    return Scope::MAPS;
+                }
+                break;
+            case Scope::MAPS:
+                return Scope::MAP;
+            case Scope::MAP:
+                if (key_ == "lootTypes"sv) {
+                    return Scope::LOOT_TYPES;
+                }
+                if (key_ == "roads"sv) {
+                    return Scope::ROADS;
+                }
+                if (key_ == "buildings"sv) {
+                    return Scope::BUILDINGS;
+                }
+                if (key_ == "offices"sv) {
+                    return Scope::OFFICES;
+                }
+                break;
+            case Scope::ROADS:
+                return Scope::ROAD;
+            case Scope::BUILDINGS:
+                return Scope::BUILDING;
+            case Scope::OFFICES:
+                return Scope::OFFICE;
+            default:
+                break;
+        }
+        return Scope::SKIPPED;
+    }
+
+    Field FindField() {
+        if (scopes_.empty()) {
+            throw std::runtime_error("Game config is not an object");
+        }
+        switch (scopes_.back()) {
+            case Scope::ROOT:
+                if (key_ == "defaultDogSpeed"sv) {
+                    return {.number = &default_dog_speed_};
+                }
+                if (key_ == "defaultBagCapacity"sv) {
+                    return {.integer = &default_bag_capacity_};
+                }
+                break;
+            case Scope::LOOT_CONFIG:
+                if (key_ == "period"sv) {
+                    return {.number = &period_};
+                }
+                if (key_ == "probability"sv) {
+                    return {.number = &probability_};
+                }
+                break;
+            case Scope::MAP:
+                if (key_ == "id"sv) {
+                    return {.string = &GetMap().id};
+                }
+                if (key_ == "name"sv) {
+                    return {.string = &GetMap().name};
+                }
+                if (key_ == "dogSpeed"sv) {
+                    return {.number = &GetMap().dog_speed};
+                }
+                if (key_ == "bagCapacity"sv) {
+                    return {.integer = &GetMap().bag_capacity};
+                }
+                break;
+            case Scope::ROAD:
+                if (key_ == "x0"sv) {
+                    return {.integer = &road_.x0};
+                }
+                if (key_ == "y0"sv) {
+                    return {.integer = &road_.y0};
+                }
+                if (key_ == "x1"sv) {
+                    return {.integer = &road_.x1};
+                }
+                if (key_ == "y1"sv) {
+                    return {.integer = &road_.y1};
+                }
+                break;
+            case Scope::BUILDING:
+                if (key_ == "x"sv) {
+                    return {.integer = &building_.x};
+                }
+                if (key_ == "y"sv) {
+                    return {.integer = &building_.y};
+                }
+                if (key_ == "w"sv) {
+                    return {.integer = &building_.w};
+                }
+                if (key_ == "h"sv) {
+                    return {.integer = &building_.h};
+                }
+                break;
+            case Scope::OFFICE:
+                if (key_ == "id"sv) {
+                    return {.string = &office_.id};
+                }
+                if (key_ == "x"sv) {
+                    return {.integer = &office_.x};
+                }
+                if (key_ == "y"sv) {
+                    return {.integer = &office_.y};
+                }
+                if (key_ == "offsetX"sv) {
+                    return {.integer = &office_.offset_x};
+                }
+                if (key_ == "offsetY"sv) {
+                    return {.integer = &office_.offset_y};
+                }
+                break;
+            default:
+                break;
+        }
+        return {};
+    }
+
+    // A scalar is only ignored where the game does not expect any value or expects a container
+    void CheckIgnored(const Field& field) const {
+        if (!IsObjectScope(scopes_.back())) {
+            throw std::runtime_error("Game config has an invalid element of "s + std::string{GetArrayName(scopes_.back())});
+        }
+        if (field.IsUsed() || GetValueScope() != Scope::SKIPPED) {
+            throw std::runtime_error("Game config has an invalid value of "s + key_);
+        }
+    }
+
+    void BeginContainer(bool is_object) {
+        if (IsInLootTypes()) {
+            // The value stack makes a container from the values pushed since its start once it ends
+            scopes_.push_back(Scope::LOOT_TYPES);
+            return;
+        }
+        const auto scope = GetValueScope();
+        if (scope == Scope::LOOT_TYPES) {
+            if (is_object) {
+                throw std::runtime_error("Game config has an invalid value of lootTypes");
+            }
+            loot_types_.reset();
+        } else if (scope != Scope::SKIPPED && IsObjectScope(scope) != is_object) {
+            throw std::runtime_error(scopes_.empty() ? "Game config is not an object"s : "Game config has an invalid value of "s + key_);
+        }
+        scopes_.push_back(scope);
+        switch (scope) {
+            case Scope::LOOT_CONFIG:
+                has_loot_config_ = true;
+                break;
+            case Scope::MAPS:
+                maps_.emplace();
+                break;
+            case Scope::MAP:
+                maps_->emplace_back();
+                break;
+            case Scope::ROADS:
+                GetMap().roads.emplace();
+                break;
+            case Scope::ROAD:
+                road_ = {};
+                break;
+            case Scope::BUILDINGS:
+                GetMap().buildings.emplace();
+                break;
+            case Scope::BUILDING:
+                building_ = {};
+                break;
+            case Scope::OFFICES:
+                GetMap().offices.emplace();
+                break;
+            case Scope::OFFICE:
+                office_ = {};
+                break;
+            default:
+                break;
+        }
+    }
+
+    void EndContainer(bool is_object, std::size_t size) {
+        const auto scope = scopes_.back();
+        scopes_.pop_back();
+        switch (scope) {
+            case Scope::LOOT_TYPES:
+                if (is_object) {
+                    loot_types_.push_object(size);
+                } else {
+                    loot_types_.push_array(size);
+                }
+                if (!IsInLootTypes()) {
+                    auto loot_types = loot_types_.release();
+                    GetMap().loot_types.emplace(std::move(loot_types.as_array()));
+                }
+                break;
+            case Scope::ROAD: {
+                const model::Point start{static_cast<model::Coord>(Require(road_.x0, "x0"sv)),
+                                         static_cast<model::Coord>(Require(road_.y0, "y0"sv))};
+                if (road_.x1) {
+                    GetMap().roads->emplace_back(model::Road::Direction::HORIZONTAL, start, static_cast<model::Coord>(*road_.x1));
+                } else {
+                    GetMap().roads->emplace_back(model::Road::Direction::VERTICAL, start,
+                                                 static_cast<model::Coord>(Require(road_.y1, "y1"sv)));
+                }
+                break;
+            }
+            case Scope::BUILDING: {
+                const model::Point position{static_cast<model::Coord>(Require(building_.x, "x"sv)),
+                                            static_cast<model::Coord>(Require(building_.y, "y"sv))};
+                const model::Size building_size{static_cast<model::Dimension>(Require(building_.w, "w"sv)),
+                                                static_cast<model::Dimension>(Require(building_.h, "h"sv))};
+                GetMap().buildings->emplace_back(model::Rectangle{position, building_size});
+                break;
+            }
+            case Scope::OFFICE: {
+                const model::Point position{static_cast<model::Coord>(Require(office_.x, "x"sv)),
+                                            static_cast<model::Coord>(Require(office_.y, "y"sv))};
+                const model::Offset offset{static_cast<model::Dimension>(Require(office_.offset_x, "offsetX"sv)),
+                                           static_cast<model::Dimension>(Require(office_.offset_y, "offsetY"sv))};
+                GetMap().offices->emplace_back(model::Office::Id(Require(office_.id, "id"sv)), position, offset);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+};
+
+model::Game GameConfigHandler::MakeGame() {
+    const double default_dog_speed = default_dog_speed_.value_or(1.);
+    const auto default_bag_capacity = default_bag_capacity_.value_or(0);
+    model::GeneratorSettings loot_settings{};
+    if (has_loot_config_) {
+        loot_settings = {Require(period_, "period"sv), Require(probability_, "probability"sv)};
+    }
+
+    if (!maps_) {
+        throw std::runtime_error("Game config has no maps");
+    }
+    model::Game game;
+    for (auto& pending : *maps_) {
+        model::Map map(model::Map::Id(Require(pending.id, "id"sv)), Require(pending.name, "name"sv),
+                       pending.dog_speed.value_or(default_dog_speed),
+                       static_cast<std::size_t>(pending.bag_capacity.value_or(default_bag_capacity)));
+
+        unsigned loot_types_count = 0;
+        std::vector<unsigned> values;
+        if (pending.loot_types) {
+            loot_types_count = pending.loot_types->size() - 1;
+            FillValues(*pending.loot_types, values);
+            payload_.map_id_loot_types.emplace(map.GetId(), std::move(*pending.loot_types));
+        }
+
+        map.AddRoads(Require(pending.roads, "roads"sv));
+        // The roads have been copied to the map
+        pending.roads.reset();
+        for (const auto& building : Require(pending.buildings, "buildings"sv)) {
+            map.AddBuilding(building);
+        }
+        for (const auto& office : Require(pending.offices, "offices"sv)) {
+            map.AddOffice(office);
+        }
+        map.AddLoot(loot_settings, loot_types_count, values);
+
+        game.AddMap(std::move(map));
+    }
+    return game;
+}
+
+}  // namespace
+
 void SetRoads(const json::array& json_roads, model::Map& map) {
-    using namespace std::literals;
-    for (const auto& json_road : json_roads) {
-        model::Point start;
-        start.x = json_road.as_object().at("x0").as_int64();
-        start.y = json_road.as_object().at("y0").as_int64();
-        if (auto search = json_road.as_object().find("x1"); search != json_road.as_object().end()) {
-            model::Coord end_x;
-            end_x = json_road.as_object().at("x1").as_int64();
-            model::Road road(model::Road::Direction::HORIZONTAL, {start.x, start.y}, end_x);
-            map.AddRoad(road);
+    model::Map::Roads roads;
+    roads.reserve(json_roads.size());
+    for (const auto& json_value : json_roads) {
+        const auto& json_road = json_value.as_object();
+        const model::Point start{static_cast<model::Coord>(json_road.at("x0").as_int64()),
+                                 static_cast<model::Coord>(json_road.at("y0").as_int64())};
+        if (const auto* end_x = json_road.if_contains("x1")) {
+            roads.emplace_back(model::Road::Direction::HORIZONTAL, start, static_cast<model::Coord>(end_x->as_int64()));
         } else {
-            model::Coord end_y;
-            end_y = json_road.as_object().at("y1").as_int64();
-            model::Road road(model::Road::Direction::VERTICAL, {start.x, start.y}, end_y);
-            map.AddRoad(road);
+            roads.emplace_back(model::Road::Direction::VERTICAL, start, static_cast<model::Coord>(json_road.at("y1").as_int64()));
         }
     }
+    // The spawn sampler is built once for all roads of the map
+    map.AddRoads(roads);
 }
 
 void SetBuildings(const json::array& json_buildings, model::Map& map) {
-    model::Point position;
-    model::Size size;
-    for (const auto& json_building : json_buildings) {
-        position.x = json_building.as_object().at("x").as_int64();
-        position.y = json_building.as_object().at("y").as_int64();
-        size.width = json_building.as_object().at("w").as_int64();
-        size.height = json_building.as_object().at("h").as_int64();
-        model::Building building({position, size});
-        map.AddBuilding(building);
+    for (const auto& json_value : json_buildings) {
+        const auto& json_building = json_value.as_object();
+        const model::Point position{static_cast<model::Coord>(json_building.at("x").as_int64()),
+                                    static_cast<model::Coord>(json_building.at("y").as_int64())};
+        const model::Size size{static_cast<model::Dimension>(json_building.at("w").as_int64()),
+                               static_cast<model::Dimension>(json_building.at("h").as_int64())};
+        map.AddBuilding(model::Building({position, size}));
     }
 }
 
 void SetOffices(const json::array& json_offices, model::Map& map) {
-    std::string id;
-    model::Point position;
-    model::Offset offset;
-    for (const auto& json_office : json_offices) {
-        id = json_office.as_object().at("id").as_string().c_str();
-        position.x = json_office.as_object().at("x").as_int64();
-        position.y = json_office.as_object().at("y").as_int64();
-        offset.dx = json_office.as_object().at("offsetX").as_int64();
-        offset.dy = json_office.as_object().at("offsetY").as_int64();
-        model::Office office(model::Office::Id(id), position, offset);
-        map.AddOffice(office);
+    for (const auto& json_value : json_offices) {
+        const auto& json_office = json_value.as_object();
+        const model::Point position{static_cast<model::Coord>(json_office.at("x").as_int64()),
+                                    static_cast<model::Coord>(json_office.at("y").as_int64())};
+        const model::Offset offset{static_cast<model::Dimension>(json_office.at("offsetX").as_int64()),
+                                   static_cast<model::Dimension>(json_office.at("offsetY").as_int64())};
+        map.AddOffice(model::Office(model::Office::Id(std::string{json_office.at("id").as_string()}), position, offset));
     }
 }
 
@@ -61,70 +619,97 @@ void FillValues(const json::array& loot_types, std::vector<unsigned int>& values
 }
 
 model::Game LoadGame(const std::filesystem::path& json_path, extra_data::Payload& payload) {
-    using namespace std::literals;
+    const auto json_file = MapFile(json_path);
+    return ParseGame({json_file.data(), json_file.size()}, payload);
+}
 
-    std::ifstream json_file(json_path, std::ios::binary);
-    if (!json_file.is_open()) {
-        throw std::runtime_error("Failed to open file"s + json_path.string());
+boost::iostreams::mapped_file_source MapFile(const std::filesystem::path& path) {
+    // The file is parsed straight from the mapped pages instead of being read into a string first
+    boost::iostreams::mapped_file_source file;
+    try {
+        if (std::filesystem::file_size(path) == 0) {
+            throw std::runtime_error("File is empty");
+        }
+        file.open(path.string());
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to open file"s + path.string());
     }
+    return file;
+}
 
-    std::string json_string((std::istreambuf_iterator<char>(json_file)), std::istreambuf_iterator<char>());
-    json::value json_value = json::parse(json_string);
+model::Game ParseGame(std::string_view json_content, extra_data::Payload& payload) {
+    json::basic_parser<GameConfigHandler> parser{json::parse_options{}, payload};
+    json::error_code ec;
+    const auto parsed = parser.write_some(false, json_content.data(), json_content.size(), ec);
+    if (!ec && parsed != json_content.size()) {
+        ec = json::error::extra_data;
+    }
+    if (ec) {
+        throw std::runtime_error("Failed to parse game config: "s + ec.message());
+    }
+    return parser.handler().MakeGame();
+}
+
+model::Game ParseGameDocument(std::string_view json_content, extra_data::Payload& payload) {
+    // All values of the document are allocated from one arena and released together once the game is built
+    json::monotonic_resource resource{std::max<std::size_t>(json_content.size(), MIN_ARENA_SIZE)};
+    json::stream_parser parser;
+    parser.reset(&resource);
+    parser.write(json_content.data(), json_content.size());
+    parser.finish();
+    const json::value json_value = parser.release();
+    const auto& json_game = json_value.as_object();
     model::Game game;
 
     double default_dog_speed = 1.;
-    if (json_value.as_object().contains("defaultDogSpeed")) {
-        default_dog_speed = json_value.as_object().at("defaultDogSpeed").as_double();
+    if (const auto* value = json_game.if_contains("defaultDogSpeed")) {
+        default_dog_speed = value->as_double();
     }
 
-    double period, probability;
-    if (json_value.as_object().contains("lootGeneratorConfig")) {
-        json::object loot_config = json_value.as_object().at("lootGeneratorConfig").as_object();
+    // Omitted keys get the same defaults as in ParseGame
+    double period = 0.;
+    double probability = 0.;
+    if (const auto* value = json_game.if_contains("lootGeneratorConfig")) {
+        const auto& loot_config = value->as_object();
         period = loot_config.at("period").as_double();
         probability = loot_config.at("probability").as_double();
     }
 
-    size_t default_bag_capacity;
-    if (json_value.as_object().contains("defaultBagCapacity")) {
-        default_bag_capacity = json_value.as_object().at("defaultBagCapacity").as_int64();
+    size_t default_bag_capacity = 0;
+    if (const auto* value = json_game.if_contains("defaultBagCapacity")) {
+        default_bag_capacity = value->as_int64();
     }
 
-    json::array json_maps = json_value.as_object().at("maps").as_array();
-    for (const auto& json_map : json_maps){
-        std::string id = json_map.as_object().at("id").as_string().c_str();
-        std::string name = json_map.as_object().at("name").as_string().c_str();
+    for (const auto& json_value_map : json_game.at("maps").as_array()) {
+        const auto& json_map = json_value_map.as_object();
+        std::string id{json_map.at("id").as_string()};
+        std::string name{json_map.at("name").as_string()};
 
         double dog_speed = default_dog_speed;
-        if (json_map.as_object().contains("dogSpeed")) {
-            dog_speed = json_map.as_object().at("dogSpeed").as_double();
+        if (const auto* value = json_map.if_contains("dogSpeed")) {
+            dog_speed = value->as_double();
         }
 
         size_t bag_capacity = default_bag_capacity;
-        if (json_map.as_object().contains("bagCapacity")) {
-            bag_capacity = json_map.as_object().at("bagCapacity").as_int64();
+        if (const auto* value = json_map.if_contains("bagCapacity")) {
+            bag_capacity = value->as_int64();
         }
 
-        unsigned loot_types_count;
+        unsigned loot_types_count = 0;
         std::vector<unsigned> values;
-        if (json_map.as_object().contains("lootTypes")) {
-            json::array loot_types = json_map.as_object().at("lootTypes").as_array();
+        if (const auto* value = json_map.if_contains("lootTypes")) {
+            const auto& loot_types = value->as_array();
             loot_types_count = loot_types.size() - 1;
-            payload.map_id_loot_types.emplace(model::Map::Id(id), loot_types);
+            // The payload outlives the arena, so the loot types are copied to the default storage
+            payload.map_id_loot_types.emplace(model::Map::Id(id), json::array(loot_types, json::storage_ptr{}));
 
             FillValues(loot_types, values);
         }
 
         model::Map map(model::Map::Id(id), name, dog_speed, bag_capacity);
-
-        json::array json_roads = json_map.as_object().at("roads").as_array();
-        SetRoads(json_roads, map);
-
-        json::array json_buildings = json_map.as_object().at("buildings").as_array();
-        SetBuildings(json_buildings, map);
-
-        json::array json_offices = json_map.as_object().at("offices").as_array();
-        SetOffices(json_offices, map);
-
+        SetRoads(json_map.at("roads").as_array(), map);
+        SetBuildings(json_map.at("buildings").as_array(), map);
+        SetOffices(json_map.at("offices").as_array(), map);
         map.AddLoot({period, probability}, loot_types_count, values);
 
         game.AddMap(std::move(map));
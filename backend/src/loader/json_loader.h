@@ -1,7 +1,9 @@
 #pragma once
 
 #include <filesystem>
+#include <string_view>
 
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/json.hpp>
 
 #include "../model/model.h"
@@ -21,4 +23,15 @@ void FillValues(const json::array& loot_types, std::vector<unsigned int>& values
 
 model::Game LoadGame(const std::filesystem::path& json_path, extra_data::Payload& payload);
 
+// Builds the maps while the config is parsed, only the loot types become json values.
+// Throws std::runtime_error if the config is malformed or misses a required value
+model::Game ParseGame(std::string_view json_content, extra_data::Payload& payload);
+
+// Builds the game from a DOM of the whole config. Slower and uses more memory than ParseGame,
+// it is kept as the reference the streaming parser is checked and measured against
+model::Game ParseGameDocument(std::string_view json_content, extra_data::Payload& payload);
+
+// Maps the whole file for reading, throws std::runtime_error if it is missing or empty
+boost::iostreams::mapped_file_source MapFile(const std::filesystem::path& path);
+
 }  // namespace json_loader
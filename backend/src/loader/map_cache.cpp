@@ -0,0 +1,360 @@
+#include "map_cache.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <boost/crc.hpp>
+
+#include "json_loader.h"
+
+namespace json_loader {
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC = {'G', 'M', 'A', 'P', 'C', 'A', 'C', 'H'};
+
+// Plain records of the image, the model objects are built from them
+struct RoadRecord {
+    std::int32_t horizontal;
+    model::Coord x;
+    model::Coord y;
+    model::Coord end;
+};
+
+struct BuildingRecord {
+    model::Coord x;
+    model::Coord y;
+    model::Dimension width;
+    model::Dimension height;
+};
+
+struct OfficeRecord {
+    model::Coord x;
+    model::Coord y;
+    model::Dimension dx;
+    model::Dimension dy;
+};
+
+class ImageWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(value));
+    }
+
+    template <typename T>
+    void WriteVector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Write(static_cast<std::uint64_t>(values.size()));
+        WriteBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void WriteString(std::string_view str) {
+        Write(static_cast<std::uint64_t>(str.size()));
+        WriteBytes(str.data(), str.size());
+    }
+
+    const std::string& GetData() const noexcept {
+        return data_;
+    }
+
+private:
+    std::string data_;
+
+    void WriteBytes(const void* data, std::size_t size) {
+        data_.append(static_cast<const char*>(data), size);
+    }
+};
+
+class ImageReader {
+public:
+    explicit ImageReader(std::string_view data)
+        : data_{data} {
+    }
+
+    template <typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, ReadBytes(sizeof(value)).data(), sizeof(value));
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> ReadVector() {
+        std::vector<T> values;
+        ReadRecords<T>([&values](std::size_t count) { values.reserve(count); },
+                       [&values](const T& value) { values.push_back(value); });
+        return values;
+    }
+
+    // Passes the records one by one straight from the image, so they are not copied into a vector first
+    template <typename T, typename Reserve, typename Consume>
+    void ReadRecords(Reserve&& reserve, Consume&& consume) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto count = Read<std::uint64_t>();
+        if (count > (data_.size() - position_) / sizeof(T)) {
+            throw std::runtime_error("Map cache is truncated");
+        }
+        const auto bytes = ReadBytes(static_cast<std::size_t>(count) * sizeof(T));
+        reserve(static_cast<std::size_t>(count));
+        for (std::size_t offset = 0; offset != bytes.size(); offset += sizeof(T)) {
+            T value;
+            std::memcpy(&value, bytes.data() + offset, sizeof(T));
+            consume(value);
+        }
+    }
+
+    std::string_view ReadString() {
+        return ReadBytes(static_cast<std::size_t>(Read<std::uint64_t>()));
+    }
+
+    std::string_view ReadBytes(std::size_t size) {
+        if (data_.size() - position_ < size) {
+            throw std::runtime_error("Map cache is truncated");
+        }
+        auto bytes = data_.substr(position_, size);
+        position_ += size;
+        return bytes;
+    }
+
+    bool IsAtEnd() const noexcept {
+        return position_ == data_.size();
+    }
+
+private:
+    std::string_view data_;
+    std::size_t position_ = 0;
+};
+
+constexpr std::size_t HEADER_SIZE = MAGIC.size() + sizeof(std::uint32_t) + sizeof(std::uint64_t)
+                                    + sizeof(std::uint32_t) + sizeof(std::uint64_t);
+
+std::uint32_t GetChecksum(std::string_view data) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+void WriteMap(ImageWriter& writer, const model::Map& map, const extra_data::Payload& payload) {
+    writer.WriteString(*map.GetId());
+    writer.WriteString(map.GetName());
+    writer.Write(map.GetDogSpeed());
+    writer.Write(static_cast<std::uint64_t>(map.GetBagCapacity()));
+
+    std::vector<RoadRecord> roads;
+    roads.reserve(map.GetRoads().size());
+    for (const auto& road : map.GetRoads()) {
+        const auto& start = road.GetStart();
+        roads.push_back({road.IsHorizontal() ? 1 : 0, start.x, start.y, road.IsHorizontal() ? road.GetEnd().x : road.GetEnd().y});
+    }
+    writer.WriteVector(roads);
+    writer.WriteVector(map.GetRoadSampler().GetProbabilities());
+    writer.WriteVector(map.GetRoadSampler().GetAliases());
+    const auto& junctions = map.GetJunctions().GetIndex();
+    writer.WriteVector(junctions.crossings[0]);
+    writer.WriteVector(junctions.crossings[1]);
+    writer.WriteVector(junctions.starts);
+    writer.WriteVector(junctions.ends);
+    writer.WriteVector(junctions.vertical_lines);
+
+    std::vector<BuildingRecord> buildings;
+    buildings.reserve(map.GetBuildings().size());
+    for (const auto& building : map.GetBuildings()) {
+        const auto& bounds = building.GetBounds();
+        buildings.push_back({bounds.position.x, bounds.position.y, bounds.size.width, bounds.size.height});
+    }
+    writer.WriteVector(buildings);
+
+    writer.Write(static_cast<std::uint64_t>(map.GetOffices().size()));
+    for (const auto& office : map.GetOffices()) {
+        writer.WriteString(*office.GetId());
+        writer.Write(OfficeRecord{office.GetPosition().x, office.GetPosition().y, office.GetOffset().dx, office.GetOffset().dy});
+    }
+
+    const auto& loot = map.GetLoot();
+    writer.Write(static_cast<std::uint8_t>(loot ? 1 : 0));
+    if (loot) {
+        writer.Write(loot->GetSettings());
+        writer.Write(loot->GetLootTypesCount());
+        writer.WriteVector(loot->GetValues());
+    }
+
+    // Loot types are only sent to clients, so they are kept as JSON text
+    const auto it = payload.map_id_loot_types.find(map.GetId());
+    writer.Write(static_cast<std::uint8_t>(it != payload.map_id_loot_types.end() ? 1 : 0));
+    if (it != payload.map_id_loot_types.end()) {
+        writer.WriteString(json::serialize(it->second));
+    }
+}
+
+model::Map ReadMap(ImageReader& reader, extra_data::Payload& payload) {
+    model::Map::Id id{std::string{reader.ReadString()}};
+    std::string name{reader.ReadString()};
+    const auto dog_speed = reader.Read<double>();
+    const auto bag_capacity = reader.Read<std::uint64_t>();
+    model::Map map{id, std::move(name), dog_speed, static_cast<std::size_t>(bag_capacity)};
+
+    model::Map::Roads roads;
+    reader.ReadRecords<RoadRecord>([&roads](std::size_t count) { roads.reserve(count); },
+                                   [&roads](const RoadRecord& record) {
+        roads.emplace_back(record.horizontal ? model::Road::Direction::HORIZONTAL : model::Road::Direction::VERTICAL,
+                           model::Point{record.x, record.y}, record.end);
+    });
+    auto probabilities = reader.ReadVector<double>();
+    auto aliases = reader.ReadVector<std::uint32_t>();
+    model::RoadJunctions::Index junctions;
+    junctions.crossings[0] = reader.ReadVector<model::RoadJunctions::LinePoint>();
+    junctions.crossings[1] = reader.ReadVector<model::RoadJunctions::LinePoint>();
+    junctions.starts = reader.ReadVector<model::RoadJunctions::LinePoint>();
+    junctions.ends = reader.ReadVector<model::RoadJunctions::LinePoint>();
+    junctions.vertical_lines = reader.ReadVector<model::RoadJunctions::LinePoint>();
+    try {
+        util::AliasTable road_sampler;
+        road_sampler.Assign(std::move(probabilities), std::move(aliases));
+        map.SetRoads(std::move(roads), std::move(road_sampler), model::RoadJunctions{std::move(junctions)});
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(e.what());
+    }
+
+    reader.ReadRecords<BuildingRecord>([](std::size_t) {}, [&map](const BuildingRecord& record) {
+        map.AddBuilding(model::Building{{{record.x, record.y}, {record.width, record.height}}});
+    });
+
+    const auto office_count = reader.Read<std::uint64_t>();
+    for (std::uint64_t i = 0; i != office_count; ++i) {
+        model::Office::Id office_id{std::string{reader.ReadString()}};
+        const auto record = reader.Read<OfficeRecord>();
+        map.AddOffice(model::Office{std::move(office_id), {record.x, record.y}, {record.dx, record.dy}});
+    }
+
+    if (reader.Read<std::uint8_t>() != 0) {
+        const auto settings = reader.Read<model::GeneratorSettings>();
+        const auto loot_types_count = reader.Read<unsigned int>();
+        map.AddLoot(settings, loot_types_count, reader.ReadVector<unsigned int>());
+    }
+
+    if (reader.Read<std::uint8_t>() != 0) {
+        payload.map_id_loot_types.emplace(id, json::parse(reader.ReadString()).as_array());
+    }
+    return map;
+}
+
+}  // namespace
+
+std::uint64_t HashConfig(std::string_view content) noexcept {
+    constexpr std::uint64_t prime = 0x100000001B3ull;
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    const auto add_bytes = [&hash](const char* data, std::size_t size) {
+        for (std::size_t i = 0; i != size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+        }
+    };
+    // An image of another format is never taken for the one of the same config
+    add_bytes(reinterpret_cast<const char*>(&MAP_CACHE_VERSION), sizeof(MAP_CACHE_VERSION));
+    add_bytes(content.data(), content.size());
+    return hash;
+}
+
+std::filesystem::path GetMapCachePath(const std::filesystem::path& json_path) {
+    auto cache_path = json_path;
+    cache_path += ".mapcache";
+    return cache_path;
+}
+
+void SaveMapCache(const model::Game& game, const extra_data::Payload& payload, std::uint64_t config_hash,
+                  const std::filesystem::path& cache_path) {
+    ImageWriter body;
+    body.Write(static_cast<std::uint64_t>(game.GetMaps().size()));
+    for (const auto& map : game.GetMaps()) {
+        WriteMap(body, *map, payload);
+    }
+    const auto& data = body.GetData();
+
+    // Servers started at the same time never see a partially written image
+    auto temp_path = cache_path;
+    temp_path += "_tmp";
+    {
+        std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+        if (!file.is_open()) {
+            throw std::runtime_error("Unable to open map cache for writing: " + temp_path.string());
+        }
+        const auto checksum = GetChecksum(data);
+        const auto size = static_cast<std::uint64_t>(data.size());
+        file.write(MAGIC.data(), MAGIC.size());
+        file.write(reinterpret_cast<const char*>(&MAP_CACHE_VERSION), sizeof(MAP_CACHE_VERSION));
+        file.write(reinterpret_cast<const char*>(&config_hash), sizeof(config_hash));
+        file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Failed to write map cache: " + temp_path.string());
+        }
+    }
+    std::filesystem::rename(temp_path, cache_path);
+}
+
+std::optional<model::Game> LoadMapCache(const std::filesystem::path& cache_path, std::uint64_t config_hash,
+                                        extra_data::Payload& payload) {
+    if (!std::filesystem::exists(cache_path)) {
+        return std::nullopt;
+    }
+    const auto file = MapFile(cache_path);
+    const std::string_view data{file.data(), file.size()};
+    if (data.size() < HEADER_SIZE || data.substr(0, MAGIC.size()) != std::string_view{MAGIC.data(), MAGIC.size()}) {
+        throw std::runtime_error("Not a map cache: " + cache_path.string());
+    }
+    ImageReader header{data.substr(MAGIC.size(), HEADER_SIZE - MAGIC.size())};
+    if (header.Read<std::uint32_t>() != MAP_CACHE_VERSION || header.Read<std::uint64_t>() != config_hash) {
+        return std::nullopt;
+    }
+    const auto checksum = header.Read<std::uint32_t>();
+    const auto body = data.substr(HEADER_SIZE);
+    if (header.Read<std::uint64_t>() != body.size() || GetChecksum(body) != checksum) {
+        throw std::runtime_error("Map cache is damaged: " + cache_path.string());
+    }
+
+    ImageReader reader{body};
+    model::Game game;
+    extra_data::Payload cached_payload;
+    const auto map_count = reader.Read<std::uint64_t>();
+    for (std::uint64_t i = 0; i != map_count; ++i) {
+        game.AddMap(ReadMap(reader, cached_payload));
+    }
+    if (!reader.IsAtEnd()) {
+        throw std::runtime_error("Map cache is damaged: " + cache_path.string());
+    }
+    payload = std::move(cached_payload);
+    return game;
+}
+
+model::Game LoadGameWithCache(const std::filesystem::path& json_path, extra_data::Payload& payload,
+                              const std::function<void(const std::exception& e)>& cache_error_handler) {
+    const auto json_file = MapFile(json_path);
+    const std::string_view content{json_file.data(), json_file.size()};
+    const auto config_hash = HashConfig(content);
+    const auto cache_path = GetMapCachePath(json_path);
+    try {
+        if (auto game = LoadMapCache(cache_path, config_hash, payload)) {
+            return std::move(*game);
+        }
+    } catch (const std::exception& e) {
+        cache_error_handler(e);
+    }
+
+    auto game = ParseGame(content, payload);
+    try {
+        SaveMapCache(game, payload, config_hash, cache_path);
+    } catch (const std::exception& e) {
+        cache_error_handler(e);
+    }
+    return game;
+}
+
+}  // namespace json_loader
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+#include "../model/model.h"
+#include "../util/extra_data.h"
+
+namespace json_loader {
+
+// Binary image of the maps of a config: roads with their spawn sampler and junctions, buildings, offices and
+// loot settings, so that a restart with an unchanged config skips parsing and indexing. The image starts
+// with the hash of the config contents it was compiled from, integers are in the native byte order.
+//
+// header: "GMAPCACH", u32 version, u64 config hash, u32 CRC-32 of the body, u64 body size
+inline constexpr std::uint32_t MAP_CACHE_VERSION = 2;
+
+// Byte-wise FNV-1a 64 of the cache format version and the config contents
+std::uint64_t HashConfig(std::string_view content) noexcept;
+
+std::filesystem::path GetMapCachePath(const std::filesystem::path& json_path);
+
+void SaveMapCache(const model::Game& game, const extra_data::Payload& payload, std::uint64_t config_hash,
+                  const std::filesystem::path& cache_path);
+
+// Returns nothing if the file is missing, was compiled from another config or by another version,
+// throws std::runtime_error if it is damaged
+std::optional<model::Game> LoadMapCache(const std::filesystem::path& cache_path, std::uint64_t config_hash,
+                                        extra_data::Payload& payload);
+
+// Loads the maps from the cache next to the config if it matches the config contents, otherwise
+// parses the config and writes the cache. Errors of the cache are passed to the handler and the
+// config is used instead
+model::Game LoadGameWithCache(const std::filesystem::path& json_path, extra_data::Payload& payload,
+                              const std::function<void(const std::exception& e)>& cache_error_handler);
+
+}  // namespace json_loader
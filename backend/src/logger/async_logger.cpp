@@ -0,0 +1,134 @@
+#include "async_logger.h"
+
+#include <stdexcept>
+
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace logger {
+
+namespace {
+
+// Timestamps have the same format as the ones written by Boost.Log: local time with microseconds
+std::string FormatTime(std::chrono::system_clock::time_point time) {
+    namespace pt = boost::posix_time;
+    const auto since_epoch = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch());
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    const auto utc = pt::from_time_t(static_cast<std::time_t>(seconds.count())) + pt::microseconds((since_epoch - seconds).count());
+    return pt::to_iso_extended_string(boost::date_time::c_local_adjustor<pt::ptime>::utc_to_local(utc));
+}
+
+void AppendLine(std::string& buffer, std::chrono::system_clock::time_point time, std::string_view message, json::object data) {
+    json::object entry;
+    entry["timestamp"] = FormatTime(time);
+    entry["data"] = std::move(data);
+    entry["message"] = message;
+    buffer += json::serialize(entry);
+    buffer += '\n';
+}
+
+// Records are written when the buffer grows over this size even if the queue is not empty yet
+constexpr std::size_t MAX_BATCH_BYTES = 64 * 1024;
+
+}  // namespace
+
+Level ParseLevel(std::string_view name) {
+    if (name == "debug"sv) {
+        return Level::DEBUG;
+    }
+    if (name == "info"sv) {
+        return Level::INFO;
+    }
+    if (name == "warning"sv) {
+        return Level::WARNING;
+    }
+    if (name == "error"sv) {
+        return Level::ERROR;
+    }
+    throw std::invalid_argument("Unknown log level: " + std::string{name});
+}
+
+AsyncLogger::AsyncLogger(std::ostream& out, LoggerOptions options)
+    : out_{out}
+    , level_{options.level}
+    , sample_rate_{options.sample_rate}
+    , flush_interval_{options.flush_interval}
+    , queue_{options.queue_capacity} {
+    if (sample_rate_ == 0) {
+        throw std::invalid_argument("Log sample rate must be positive");
+    }
+    writer_ = std::thread{[this] {
+        Run();
+    }};
+}
+
+AsyncLogger::~AsyncLogger() {
+    Stop();
+}
+
+bool AsyncLogger::Sample() noexcept {
+    return sample_rate_ == 1 || sample_counter_.fetch_add(1, std::memory_order_relaxed) % sample_rate_ == 0;
+}
+
+void AsyncLogger::Log(Level level, std::string_view message, json::object data) {
+    if (!IsEnabled(level) || stopped_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (!queue_.TryPush(Record{std::chrono::system_clock::now(), message, std::move(data)})) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AsyncLogger::Stop() {
+    if (!stopped_.exchange(true) && writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+std::uint64_t AsyncLogger::GetDroppedCount() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+void AsyncLogger::Run() {
+    std::string buffer;
+    while (!stopped_.load(std::memory_order_acquire)) {
+        if (Drain(buffer) == 0) {
+            std::this_thread::sleep_for(flush_interval_);
+        }
+    }
+    // Records pushed before the stop flag has been seen are still written
+    while (Drain(buffer) != 0) {
+    }
+}
+
+std::size_t AsyncLogger::Drain(std::string& buffer) {
+    std::size_t count = 0;
+    while (buffer.size() < MAX_BATCH_BYTES) {
+        auto record = queue_.TryPop();
+        if (!record) {
+            break;
+        }
+        AppendLine(buffer, record->time, record->message, std::move(record->data));
+        ++count;
+    }
+    ReportDropped(buffer);
+    if (!buffer.empty()) {
+        out_.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out_.flush();
+        buffer.clear();
+    }
+    return count;
+}
+
+void AsyncLogger::ReportDropped(std::string& buffer) {
+    const auto dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped == reported_dropped_) {
+        return;
+    }
+    json::object data;
+    data["count"] = dropped - reported_dropped_;
+    AppendLine(buffer, std::chrono::system_clock::now(), "log records dropped"sv, std::move(data));
+    reported_dropped_ = dropped;
+}
+
+}  // namespace logger
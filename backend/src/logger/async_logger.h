@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <boost/json.hpp>
+
+#include "../util/mpsc_queue.h"
+
+namespace logger {
+
+namespace json = boost::json;
+using namespace std::literals;
+
+enum class Level {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+// Accepts "debug", "info", "warning" and "error"
+Level ParseLevel(std::string_view name);
+
+struct LoggerOptions {
+    Level level = Level::INFO;
+    // Only every sample_rate-th sampled record is written, 1 writes all of them
+    unsigned int sample_rate = 1;
+    std::size_t queue_capacity = 1 << 16;
+    // How long the writer sleeps when the queue is empty
+    std::chrono::milliseconds flush_interval = 10ms;
+};
+
+// Writes JSON log lines {"timestamp", "data", "message"} from a dedicated thread.
+// Logging threads only copy the record into a lock-free queue, the writer serializes the records
+// and writes them in batches with one flush per batch. When the queue is full records are dropped
+// rather than blocking the caller, the number of dropped records is logged by the writer
+class AsyncLogger {
+public:
+    AsyncLogger(std::ostream& out, LoggerOptions options);
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Writes all queued records
+    ~AsyncLogger();
+
+    bool IsEnabled(Level level) const noexcept {
+        return level >= level_;
+    }
+
+    // Returns true once per sample_rate calls, high volume records are logged only when it does
+    bool Sample() noexcept;
+
+    // The message must outlive the logger, e.g. be a string literal
+    void Log(Level level, std::string_view message, json::object data);
+
+    // Writes all queued records and stops the writer, records logged afterwards are dropped
+    void Stop();
+
+    std::uint64_t GetDroppedCount() const noexcept;
+
+private:
+    struct Record {
+        std::chrono::system_clock::time_point time;
+        std::string_view message;
+        json::object data;
+    };
+
+    std::ostream& out_;
+    Level level_;
+    unsigned int sample_rate_;
+    std::chrono::milliseconds flush_interval_;
+    util::MpscQueue<Record> queue_;
+    std::atomic<std::uint64_t> sample_counter_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t reported_dropped_ = 0;
+    std::atomic<bool> stopped_{false};
+    std::thread writer_;
+
+    void Run();
+
+    // Writes the records available in the queue, returns their number
+    std::size_t Drain(std::string& buffer);
+
+    void ReportDropped(std::string& buffer);
+};
+
+}  // namespace logger
@@ -13,14 +13,13 @@
 #include <boost/log/utility/setup/common_attributes.hpp>
 #include <boost/date_time.hpp>
 #include <boost/program_options.hpp>
-#include <boost/archive/text_oarchive.hpp>
-#include <boost/archive/text_iarchive.hpp>
-#include <boost/serialization/unordered_map.hpp>
-#include <boost/serialization/vector.hpp>
 
 #include "loader/json_loader.h"
+#include "loader/map_cache.h"
+#include "logger/async_logger.h"
 #include "handler/request_handler.h"
-#include "serialization/model_serialization.h"
+#include "serialization/journal.h"
+#include "serialization/snapshot_writer.h"
 
 namespace sys = boost::system;
 namespace fs = std::filesystem;
@@ -49,26 +48,35 @@ void Init() {
     );
 }
 
-void LogIn(const json::object& custom_data) {
-    if (auto it = custom_data.find("URI"); it != custom_data.end()) {
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, custom_data)
-                                << "request received"sv;
-    } else if (auto it = custom_data.find("response_time"); it != custom_data.end()) {
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, custom_data)
-                                << "response sent"sv;
-    } else if (auto it = custom_data.find("text"); it != custom_data.end()) {
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, custom_data)
-                                << "error"sv;
+// Requests and responses are logged on the hot path, so they go through the asynchronous logger.
+// They are sampled by the server before their records are built
+void LogIn(logger::AsyncLogger& async_logger, json::object custom_data) {
+    if (custom_data.contains("URI")) {
+        async_logger.Log(logger::Level::INFO, "request received"sv, std::move(custom_data));
+    } else if (custom_data.contains("response_time")) {
+        async_logger.Log(logger::Level::INFO, "response sent"sv, std::move(custom_data));
+    } else if (custom_data.contains("text")) {
+        async_logger.Log(logger::Level::WARNING, "error"sv, std::move(custom_data));
     }
 }
 
 struct Args {
     unsigned int tick_period;
     std::string config_file_path;
+    bool map_cache;
     std::string root;
     bool random_positions;
     std::string state_file;
+    std::string state_format;
     unsigned int save_state_period;
+    std::size_t max_session_players;
+    std::optional<std::uint64_t> random_seed;
+    unsigned int fixed_time_step;
+    std::string input_log_file;
+    bool journal;
+    std::string log_level;
+    unsigned int log_sample_rate;
+    bool admin_api;
 };
 
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
@@ -79,10 +87,20 @@ struct Args {
         ("help,h", "produce help message")
         ("tick-period,t", po::value<unsigned int>(&args.tick_period)->default_value(0), "set tick period in milliseconds")
         ("config-file,c", po::value<std::string>(&args.config_file_path), "set config file path")
+        ("map-cache", po::bool_switch(&args.map_cache), "keep compiled maps next to the config file and load them while the config is unchanged")
         ("www-root,w", po::value<std::string>(&args.root), "set static files root")
         ("randomize-spawn-points", po::bool_switch(&args.random_positions), "spawn dogs at random positions")
         ("state-file", po::value<std::string>(&args.state_file), "set path to the state file")
-        ("save-state-period", po::value<unsigned int>(&args.save_state_period), "set period for automatic state saving in milliseconds");
+        ("state-format", po::value<std::string>(&args.state_format)->default_value("binary"s), "set format of saved state files: binary or text, both are read on start")
+        ("save-state-period", po::value<unsigned int>(&args.save_state_period), "set period for automatic state saving in milliseconds")
+        ("max-session-players", po::value<std::size_t>(&args.max_session_players)->default_value(0), "set maximum number of players in one game session, 0 means no limit")
+        ("random-seed", po::value<std::uint64_t>(), "set seed for random events to make game sessions reproducible")
+        ("fixed-time-step", po::value<unsigned int>(&args.fixed_time_step)->default_value(0), "advance the game in fixed steps of the given milliseconds, 0 means the whole tick")
+        ("input-log", po::value<std::string>(&args.input_log_file), "record joins, actions and ticks to the file for an offline replay")
+        ("journal", po::bool_switch(&args.journal), "record joins, actions and ticks between state snapshots and replay them on start, needs the binary state file")
+        ("log-level", po::value<std::string>(&args.log_level)->default_value("info"s), "set minimum level of request logs: debug, info, warning or error")
+        ("log-sample-rate", po::value<unsigned int>(&args.log_sample_rate)->default_value(1), "log only every n-th request and response")
+        ("admin-api", po::bool_switch(&args.admin_api), "enable /api/v1/admin endpoints with tick profiles and traces");
     // variables_map stores option values after parsing
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -91,35 +109,10 @@ struct Args {
         std::cout << desc;
         return std::nullopt;
     }
-    return args;
-}
-
-void Save(const app::Application& app, const std::string& filename) {
-    std::string temp_filename = filename + "_tmp";
-    {
-        std::ofstream file(temp_filename);
-        if (file.is_open()) {
-            boost::archive::text_oarchive ar(file);
-            serialization::ApplicationRepr app_repr{app};
-            ar << app_repr;
-        } else {
-            throw std::runtime_error("Unable to open temporary file for writing");
-        }
-    }
-    fs::rename(temp_filename, filename);
-}
-
-void Load(app::Application& app, const std::string& filename) {
-    {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open file: " + filename);
-        }
-        boost::archive::text_iarchive ar{file};
-        serialization::ApplicationRepr restored_app_repr;
-        ar >> restored_app_repr;
-        restored_app_repr.Restore(app);
+    if (vm.contains("random-seed"s)) {
+        args.random_seed = vm["random-seed"s].as<std::uint64_t>();
     }
+    return args;
 }
 
 namespace {
@@ -135,6 +128,23 @@ void RunAsyncOperations(unsigned int n, const Fn& fn) {
     fn();
 }
 
+// Each SIGHUP starts a reload of the maps, the signal is waited for again until the io_context stops
+void WaitReloadSignal(net::signal_set& signals, const std::function<bool()>& reload_maps) {
+    signals.async_wait([&signals, &reload_maps](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
+        if (ec) {
+            return;
+        }
+        if (!reload_maps) {
+            BOOST_LOG_TRIVIAL(warning) << logging::add_value(additional_data, json::object{})
+                                       << "maps can't be reloaded while the input log or the journal is recorded"sv;
+        } else if (!reload_maps()) {
+            BOOST_LOG_TRIVIAL(warning) << logging::add_value(additional_data, json::object{})
+                                       << "maps are being reloaded already"sv;
+        }
+        WaitReloadSignal(signals, reload_maps);
+    });
+}
+
 }  // namespace
 
 int main(int argc, const char* argv[]) {
@@ -146,23 +156,84 @@ int main(int argc, const char* argv[]) {
             }
 
             Init();
-            auto data_collection = [](const json::object& custom_data) {
-                LogIn(custom_data);
+            // The logger is created before io_context, so it outlives all sessions that log through it
+            logger::AsyncLogger async_logger{std::clog, {logger::ParseLevel(args->log_level), args->log_sample_rate}};
+            auto data_collection = [&async_logger](json::object custom_data) {
+                LogIn(async_logger, std::move(custom_data));
+            };
+            auto record_sampler = [&async_logger] {
+                return async_logger.IsEnabled(logger::Level::INFO) && async_logger.Sample();
             };
 
-            // Download the map from the file and build a game model
+            // Download the map from the file and build a game model, the maps are loaded the same way on reload
+            auto load_game = [&args](extra_data::Payload& payload) {
+                if (!args->map_cache) {
+                    return json_loader::LoadGame(args->config_file_path, payload);
+                }
+                return json_loader::LoadGameWithCache(args->config_file_path, payload, [](const std::exception& e) {
+                    json::value custom_data{{"exception"s, e.what()}};
+                    BOOST_LOG_TRIVIAL(warning) << logging::add_value(additional_data, custom_data)
+                                               << "map cache is not used"sv;
+                });
+            };
             extra_data::Payload payload;
-            model::Game game = json_loader::LoadGame(args->config_file_path, payload);
+            auto game = std::make_unique<model::Game>(load_game(payload));
+            if (args->journal && (args->state_file.empty() || args->save_state_period == 0
+                                  || serialization::ParseSnapshotFormat(args->state_format) != serialization::SnapshotFormat::BINARY)) {
+                throw std::invalid_argument("The journal needs the state file in the binary format and the save state period");
+            }
+            if (args->journal && !args->input_log_file.empty()) {
+                throw std::invalid_argument("The journal and the input log can not be recorded together");
+            }
+            // A replay needs the seed, so it is chosen here when the input log is on and the seed is not set
+            if ((!args->input_log_file.empty() || args->journal) && !args->random_seed) {
+                args->random_seed = util::NondeterministicSeed();
+            }
+            if (args->random_seed) {
+                game->SetRandomSeed(*args->random_seed);
+            }
 
-            app::Application app{std::make_unique<model::Game>(game), args->random_positions};
+            app::Application app{std::move(game), args->random_positions, args->max_session_players};
+            app.SetFixedTimeStep(milliseconds(args->fixed_time_step));
+            std::optional<app::InputLogHeader> input_log_header;
+            if (args->random_seed) {
+                input_log_header = app::InputLogHeader{*args->random_seed, args->fixed_time_step,
+                                                       static_cast<std::uint32_t>(args->max_session_players),
+                                                       args->random_positions};
+            }
+            std::ofstream input_log_file;
+            std::optional<app::InputLogWriter> input_log;
+            if (!args->input_log_file.empty()) {
+                input_log_file.open(args->input_log_file, std::ios::binary | std::ios::trunc);
+                if (!input_log_file.is_open()) {
+                    throw std::runtime_error("Failed to open input log: " + args->input_log_file);
+                }
+                input_log.emplace(input_log_file, *input_log_header);
+                app.SetInputLog(&(*input_log));
+            }
+            // The registry is created before io_context, because sessions destroyed with it still report to the registry
+            metrics::Registry metrics_registry;
             // Initialize io_context
             const unsigned int num_threads = std::thread::hardware_concurrency();
             net::io_context ioc(num_threads);
             bool is_state_file_set = args->state_file.empty();
+            const std::string journal_path = args->state_file + ".journal"s;
             // When the server starts with the path to an existing status file, it should restore this state
-            if (!is_state_file_set && fs::exists(args->state_file)) {
+            // and then repeat what has been recorded to the journal after it
+            if (!is_state_file_set && (fs::exists(args->state_file) || args->journal)) {
                 try {
-                    Load(app, args->state_file);
+                    std::optional<serialization::JournalCheckpoint> checkpoint;
+                    if (fs::exists(args->state_file)) {
+                        checkpoint = serialization::LoadSnapshot(app, args->state_file);
+                    }
+                    if (args->journal) {
+                        if (checkpoint) {
+                            app.SetPendingTime(milliseconds{checkpoint->pending_time});
+                        }
+                        serialization::ReplayJournal(journal_path, checkpoint ? checkpoint->segment : 0, app, *input_log_header);
+                        // Replaying the ticks has reseeded new sessions from the recorded seeds
+                        app.GetGame()->SetRandomSeed(*args->random_seed);
+                    }
                 } catch (const std::runtime_error& e) {
                     json::value custom_data{{"exception"s, e.what()}};
                     BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, custom_data)
@@ -170,11 +241,41 @@ int main(int argc, const char* argv[]) {
                     return EXIT_FAILURE;
                 }
             }
+            // New segments follow the replayed ones, which are removed once a snapshot covers them
+            std::optional<serialization::Journal> journal;
+            if (args->journal) {
+                const auto segments = serialization::FindJournalSegments(journal_path);
+                journal.emplace(journal_path, *input_log_header, segments.empty() ? 0 : segments.back() + 1);
+                app.SetInputLog(&journal->GetWriter());
+            }
+            // Snapshots are written in the background, the writer finishes the last one when it is destroyed
+            std::optional<serialization::SnapshotWriter> snapshot_writer;
+            if (!is_state_file_set) {
+                snapshot_writer.emplace(args->state_file, serialization::ParseSnapshotFormat(args->state_format), [](const std::exception& e) {
+                    json::value custom_data{{"exception"s, e.what()}};
+                    BOOST_LOG_TRIVIAL(error) << logging::add_value(additional_data, custom_data)
+                                             << "state saving failed"sv;
+                }, [&journal_path](const std::optional<serialization::JournalCheckpoint>& checkpoint) {
+                    if (checkpoint) {
+                        serialization::RemoveJournalSegments(journal_path, checkpoint->segment);
+                    }
+                });
+            }
             // The lambda function will be called whenever the Application sends a tick signal
-            sig::scoped_connection conn = app.DoOnTick([total = 0ms, &args, &app](milliseconds delta) mutable {
+            sig::scoped_connection conn = app.DoOnTick([total = 0ms, &args, &app, &journal, &snapshot_writer](milliseconds delta) mutable {
                 total += delta;
-                if (total >= milliseconds(args->save_state_period)) {
-                    Save(app, args->state_file);
+                if (journal) {
+                    journal->Flush();
+                }
+                if (total >= milliseconds(args->save_state_period) && snapshot_writer) {
+                    // Only capturing the state stays on the tick thread
+                    auto timer = app.MeasureStateSaving();
+                    std::optional<serialization::JournalCheckpoint> checkpoint;
+                    if (journal) {
+                        checkpoint = serialization::JournalCheckpoint{journal->Rotate(), app.GetPendingTime().count()};
+                        app.SetInputLog(&journal->GetWriter());
+                    }
+                    snapshot_writer->Submit(serialization::ApplicationRepr{app}, checkpoint);
                     total = 0ms;
                 }
             });
@@ -195,14 +296,34 @@ int main(int argc, const char* argv[]) {
                 }
             });
 
+            auto api_strand = net::make_strand(ioc);
+            // The maps are swapped in on the strand between ticks. A replay of the input log or the journal
+            // starts from the maps in the config, so it could not reproduce sessions created after a reload
+            std::function<bool()> reload_maps;
+            if (args->input_log_file.empty() && !args->journal) {
+                auto map_reloader = std::make_shared<MapReloader>(ioc, api_strand, app, payload, load_game, [](std::uint32_t maps_version) {
+                    json::value custom_data{{"mapsVersion"s, maps_version}};
+                    BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, custom_data)
+                                            << "maps reloaded"sv;
+                }, [](const std::exception& e) {
+                    json::value custom_data{{"exception"s, e.what()}};
+                    BOOST_LOG_TRIVIAL(error) << logging::add_value(additional_data, custom_data)
+                                             << "maps reload failed"sv;
+                });
+                reload_maps = [map_reloader] {
+                    return map_reloader->Reload();
+                };
+            }
+            net::signal_set reload_signals(ioc, SIGHUP);
+            WaitReloadSignal(reload_signals, reload_maps);
+
             bool is_save_state_period_set = args->save_state_period != 0;
             bool is_tick_period_set = args->tick_period != 0;
-            ApiHandlerParams params{payload, app, is_state_file_set, is_save_state_period_set, is_tick_period_set};
+            ApiHandlerParams params{payload, app, is_state_file_set, is_save_state_period_set, is_tick_period_set, args->admin_api, metrics_registry, reload_maps};
 
             // Creating an API Request Handler Manager
             api_handler::ApiHandlerManager api_handler_manager{params};
 
-            auto api_strand = net::make_strand(ioc);
             if (params.is_tick_period_set) {
                 auto ticker = std::make_shared<Ticker>(api_strand, milliseconds(args->tick_period),
                     [&api_handler_manager](milliseconds delta) {
@@ -212,9 +333,8 @@ int main(int argc, const char* argv[]) {
             }
 
             fs::path static_files_root{args->root};
-            detail::DurationMeasure measure;
             // Creating an HTTP request handler
-            auto handler = std::make_shared<http_handler::RequestHandler>(api_handler_manager, static_files_root, api_strand, measure, data_collection);
+            auto handler = std::make_shared<http_handler::RequestHandler>(api_handler_manager, static_files_root, api_strand, metrics_registry);
             const auto address = net::ip::make_address("0.0.0.0");
             constexpr net::ip::port_type port = 8080;
             json::object custom_data;
@@ -223,8 +343,16 @@ int main(int argc, const char* argv[]) {
             BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, custom_data)
                                     << "server started"sv;
             // Start the HTTP request handler by delegating them to the request handler
-            http_server::ServeHttp(ioc, {address, port}, data_collection, [handler](auto&& req, auto&& send) {
-                (*handler)(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send));
+            auto connection_observer = [&metrics_registry](int delta) {
+                metrics_registry.AddConnections(delta);
+            };
+            auto request_observer = [&metrics_registry](const http_server::RequestTiming& timing) {
+                metrics_registry.RecordRequest(metrics::GetEndpoint(timing.GetTarget()), timing.GetStatus(),
+                                               {timing.GetQueueTime(), timing.GetHandlerTime(), timing.GetWriteTime()});
+            };
+            http_server::ServeHttp(ioc, {address, port}, data_collection, record_sampler, connection_observer, request_observer,
+                                   [handler](auto&& req, auto&& timing, auto&& send) {
+                (*handler)(std::forward<decltype(req)>(req), std::forward<decltype(timing)>(timing), std::forward<decltype(send)>(send));
             });
             // Starting processing of asynchronous operations
             RunAsyncOperations(std::max(1u, num_threads), [&ioc] {
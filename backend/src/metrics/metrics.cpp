@@ -0,0 +1,164 @@
+#include "metrics.h"
+
+#include <sstream>
+
+namespace metrics {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::array<std::string_view, ENDPOINT_COUNT> ENDPOINT_LABELS = {
+    "/api/v1/maps"sv,
+    "/api/v1/maps/{id}"sv,
+    "/api/v1/game/join"sv,
+    "/api/v1/game/players"sv,
+    "/api/v1/game/state"sv,
+    "/api/v1/game/player/action"sv,
+    "/api/v1/game/player/actions"sv,
+    "/api/v1/game/tick"sv,
+    "/metrics"sv,
+    "api_other"sv,
+    "static"sv
+};
+
+// Upper bounds of the exported histogram buckets in microseconds
+constexpr std::array<std::uint64_t, 14> BUCKET_BOUNDS = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+};
+
+std::uint64_t ToMicroseconds(Registry::Duration duration) noexcept {
+    const auto count = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    return count < 0 ? 0 : static_cast<std::uint64_t>(count);
+}
+
+void WriteHeader(std::ostream& out, std::string_view name, std::string_view type, std::string_view help) {
+    out << "# HELP "sv << name << ' ' << help << '\n'
+        << "# TYPE "sv << name << ' ' << type << '\n';
+}
+
+void WriteHistogram(std::ostream& out, std::string_view name, std::string_view labels, const util::Histogram& histogram) {
+    const std::string_view separator = labels.empty() ? ""sv : ","sv;
+    for (auto bound : BUCKET_BOUNDS) {
+        out << name << "_bucket{"sv << labels << separator << "le=\""sv << bound << "\"} "sv
+            << histogram.GetCountAtOrBelow(bound) << '\n';
+    }
+    out << name << "_bucket{"sv << labels << separator << "le=\"+Inf\"} "sv << histogram.GetCount() << '\n';
+    const auto braces = labels.empty() ? ""s : "{"s + std::string{labels} + "}"s;
+    out << name << "_sum"sv << braces << ' ' << histogram.GetSum() << '\n'
+        << name << "_count"sv << braces << ' ' << histogram.GetCount() << '\n';
+}
+
+}  // namespace
+
+Endpoint GetEndpoint(std::string_view target) noexcept {
+    if (auto query = target.find('?'); query != std::string_view::npos) {
+        target = target.substr(0, query);
+    }
+    static constexpr auto map_prefix = "/api/v1/maps/"sv;
+    if (target.starts_with(map_prefix) && target.size() > map_prefix.size()) {
+        return Endpoint::MAP_BY_ID;
+    }
+    for (std::size_t i = 0; i != static_cast<std::size_t>(Endpoint::API_OTHER); ++i) {
+        if (target == ENDPOINT_LABELS[i]) {
+            return static_cast<Endpoint>(i);
+        }
+    }
+    return target.starts_with("/api/"sv) ? Endpoint::API_OTHER : Endpoint::STATIC;
+}
+
+std::string_view GetEndpointLabel(Endpoint endpoint) noexcept {
+    return ENDPOINT_LABELS[static_cast<std::size_t>(endpoint)];
+}
+
+void Registry::RecordRequest(Endpoint endpoint, unsigned status, const RequestPhases& phases) noexcept {
+    auto& metrics = endpoints_[static_cast<std::size_t>(endpoint)];
+    metrics.requests.fetch_add(1, std::memory_order_relaxed);
+    if (status >= 500) {
+        metrics.server_errors.fetch_add(1, std::memory_order_relaxed);
+    } else if (status >= 400) {
+        metrics.client_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    metrics.latency.Record(ToMicroseconds(phases.queue + phases.handler + phases.write));
+    metrics.queue.Record(ToMicroseconds(phases.queue));
+    metrics.handler.Record(ToMicroseconds(phases.handler));
+    metrics.write.Record(ToMicroseconds(phases.write));
+}
+
+void Registry::RecordTick(Duration duration) noexcept {
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+    tick_duration_.Record(ToMicroseconds(duration));
+}
+
+void Registry::SetGameState(std::size_t sessions, std::size_t dogs, std::size_t lost_objects) noexcept {
+    sessions_.store(sessions, std::memory_order_relaxed);
+    dogs_.store(dogs, std::memory_order_relaxed);
+    lost_objects_.store(lost_objects, std::memory_order_relaxed);
+}
+
+void Registry::AddConnections(std::int64_t delta) noexcept {
+    connections_.fetch_add(delta, std::memory_order_relaxed);
+}
+
+std::uint64_t Registry::GetRequestCount(Endpoint endpoint) const noexcept {
+    return endpoints_[static_cast<std::size_t>(endpoint)].requests.load(std::memory_order_relaxed);
+}
+
+std::int64_t Registry::GetConnections() const noexcept {
+    return connections_.load(std::memory_order_relaxed);
+}
+
+std::string Registry::Serialize() const {
+    std::ostringstream out;
+
+    WriteHeader(out, "game_server_requests_total"sv, "counter"sv, "Number of handled HTTP requests."sv);
+    for (std::size_t i = 0; i != ENDPOINT_COUNT; ++i) {
+        out << "game_server_requests_total{endpoint=\""sv << ENDPOINT_LABELS[i] << "\"} "sv
+            << endpoints_[i].requests.load(std::memory_order_relaxed) << '\n';
+    }
+
+    WriteHeader(out, "game_server_request_errors_total"sv, "counter"sv, "Number of requests answered with an error status."sv);
+    for (std::size_t i = 0; i != ENDPOINT_COUNT; ++i) {
+        out << "game_server_request_errors_total{endpoint=\""sv << ENDPOINT_LABELS[i] << "\",class=\"4xx\"} "sv
+            << endpoints_[i].client_errors.load(std::memory_order_relaxed) << '\n'
+            << "game_server_request_errors_total{endpoint=\""sv << ENDPOINT_LABELS[i] << "\",class=\"5xx\"} "sv
+            << endpoints_[i].server_errors.load(std::memory_order_relaxed) << '\n';
+    }
+
+    WriteHeader(out, "game_server_request_duration_microseconds"sv, "histogram"sv, "Time from receiving a request to sending its response."sv);
+    for (std::size_t i = 0; i != ENDPOINT_COUNT; ++i) {
+        const auto labels = "endpoint=\""s + std::string{ENDPOINT_LABELS[i]} + "\""s;
+        WriteHistogram(out, "game_server_request_duration_microseconds"sv, labels, endpoints_[i].latency);
+    }
+
+    WriteHeader(out, "game_server_request_phase_duration_microseconds"sv, "histogram"sv,
+                "Time a request spent waiting for its handler (queue), being handled (handler) and being written (write)."sv);
+    for (std::size_t i = 0; i != ENDPOINT_COUNT; ++i) {
+        const auto endpoint = "endpoint=\""s + std::string{ENDPOINT_LABELS[i]} + "\",phase=\""s;
+        WriteHistogram(out, "game_server_request_phase_duration_microseconds"sv, endpoint + "queue\""s, endpoints_[i].queue);
+        WriteHistogram(out, "game_server_request_phase_duration_microseconds"sv, endpoint + "handler\""s, endpoints_[i].handler);
+        WriteHistogram(out, "game_server_request_phase_duration_microseconds"sv, endpoint + "write\""s, endpoints_[i].write);
+    }
+
+    WriteHeader(out, "game_server_tick_duration_microseconds"sv, "histogram"sv, "Time spent updating all game sessions in one tick."sv);
+    WriteHistogram(out, "game_server_tick_duration_microseconds"sv, ""sv, tick_duration_);
+
+    WriteHeader(out, "game_server_ticks_total"sv, "counter"sv, "Number of game ticks."sv);
+    out << "game_server_ticks_total "sv << ticks_.load(std::memory_order_relaxed) << '\n';
+
+    WriteHeader(out, "game_server_game_sessions"sv, "gauge"sv, "Number of game sessions."sv);
+    out << "game_server_game_sessions "sv << sessions_.load(std::memory_order_relaxed) << '\n';
+
+    WriteHeader(out, "game_server_dogs"sv, "gauge"sv, "Number of dogs in all sessions."sv);
+    out << "game_server_dogs "sv << dogs_.load(std::memory_order_relaxed) << '\n';
+
+    WriteHeader(out, "game_server_lost_objects"sv, "gauge"sv, "Number of lost objects lying on the maps."sv);
+    out << "game_server_lost_objects "sv << lost_objects_.load(std::memory_order_relaxed) << '\n';
+
+    WriteHeader(out, "game_server_connections"sv, "gauge"sv, "Number of open client connections."sv);
+    out << "game_server_connections "sv << connections_.load(std::memory_order_relaxed) << '\n';
+
+    return out.str();
+}
+
+}  // namespace metrics
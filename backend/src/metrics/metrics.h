@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "../util/histogram.h"
+
+namespace metrics {
+
+enum class Endpoint : std::size_t {
+    MAPS,
+    MAP_BY_ID,
+    GAME_JOIN,
+    GAME_PLAYERS,
+    GAME_STATE,
+    PLAYER_ACTION,
+    PLAYER_ACTIONS,
+    GAME_TICK,
+    METRICS,
+    // Unknown /api/ targets
+    API_OTHER,
+    STATIC
+};
+
+inline constexpr std::size_t ENDPOINT_COUNT = static_cast<std::size_t>(Endpoint::STATIC) + 1;
+
+// Endpoints are reduced to a fixed set of labels, so map ids and query strings never create new series
+Endpoint GetEndpoint(std::string_view target) noexcept;
+
+std::string_view GetEndpointLabel(Endpoint endpoint) noexcept;
+
+using Duration = std::chrono::steady_clock::duration;
+
+// Where a request spent its time: waiting for the API strand, in the handler and writing the response
+struct RequestPhases {
+    Duration queue{};
+    Duration handler{};
+    Duration write{};
+};
+
+// Server metrics in the Prometheus text exposition format. All updates are lock-free,
+// so the registry can be shared by all threads serving connections and the game strand
+class Registry {
+public:
+    using Duration = metrics::Duration;
+
+    Registry() = default;
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    void RecordRequest(Endpoint endpoint, unsigned status, const RequestPhases& phases) noexcept;
+
+    void RecordTick(Duration duration) noexcept;
+
+    void SetGameState(std::size_t sessions, std::size_t dogs, std::size_t lost_objects) noexcept;
+
+    void AddConnections(std::int64_t delta) noexcept;
+
+    std::uint64_t GetRequestCount(Endpoint endpoint) const noexcept;
+    std::int64_t GetConnections() const noexcept;
+
+    std::string Serialize() const;
+
+private:
+    struct EndpointMetrics {
+        std::atomic<std::uint64_t> requests{0};
+        std::atomic<std::uint64_t> client_errors{0};
+        std::atomic<std::uint64_t> server_errors{0};
+        util::Histogram latency;
+        util::Histogram queue;
+        util::Histogram handler;
+        util::Histogram write;
+    };
+
+    std::array<EndpointMetrics, ENDPOINT_COUNT> endpoints_;
+    util::Histogram tick_duration_;
+    std::atomic<std::uint64_t> ticks_{0};
+    std::atomic<std::uint64_t> sessions_{0};
+    std::atomic<std::uint64_t> dogs_{0};
+    std::atomic<std::uint64_t> lost_objects_{0};
+    std::atomic<std::int64_t> connections_{0};
+};
+
+}  // namespace metrics
@@ -1,6 +1,9 @@
 #include "model.h"
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <queue>
 #include <stdexcept>
 #include <chrono>
 
@@ -55,6 +58,147 @@ const geom::Point2D& Road::GetMax() const noexcept {
     return max_;
 }
 
+CompactRoad::CompactRoad(const Road& road) noexcept
+    : min_along{road.IsHorizontal() ? road.GetMin().x : road.GetMin().y}
+    , max_along{road.IsHorizontal() ? road.GetMax().x : road.GetMax().y}
+    , fixed{road.IsHorizontal() ? road.GetStart().y : road.GetStart().x}
+    , start{road.IsHorizontal() ? road.GetStart().x : road.GetStart().y}
+    , end{road.IsHorizontal() ? road.GetEnd().x : road.GetEnd().y}
+    , horizontal{road.IsHorizontal()} {
+}
+
+namespace {
+
+using LinePoint = RoadJunctions::LinePoint;
+
+bool LinePointLess(const LinePoint& lhs, const LinePoint& rhs) noexcept {
+    return lhs.fixed < rhs.fixed || (lhs.fixed == rhs.fixed && lhs.along < rhs.along);
+}
+
+// Sorts the points and keeps the greatest road of the ones at the same point
+void SortUnique(std::vector<LinePoint>& points) {
+    std::sort(points.begin(), points.end(), [](const LinePoint& lhs, const LinePoint& rhs) {
+        return LinePointLess(lhs, rhs) || (!LinePointLess(rhs, lhs) && lhs.road > rhs.road);
+    });
+    points.erase(std::unique(points.begin(), points.end(), [](const LinePoint& lhs, const LinePoint& rhs) {
+        return lhs.fixed == rhs.fixed && lhs.along == rhs.along;
+    }), points.end());
+}
+
+// Splits the lines the roads of one axis lie on into pieces covered by the same greatest road, NO_ROAD between roads
+std::vector<LinePoint> BuildPieces(const std::vector<CompactRoad>& roads, bool horizontal) {
+    std::vector<std::uint32_t> by_start;
+    for (std::uint32_t i = 0; i != roads.size(); ++i) {
+        if (roads[i].horizontal == horizontal) {
+            by_start.push_back(i);
+        }
+    }
+    const auto min_along = [&roads](std::uint32_t road) {
+        return std::min(roads[road].start, roads[road].end);
+    };
+    const auto max_along = [&roads](std::uint32_t road) {
+        return std::max(roads[road].start, roads[road].end);
+    };
+    std::sort(by_start.begin(), by_start.end(), [&roads, &min_along](std::uint32_t lhs, std::uint32_t rhs) {
+        return roads[lhs].fixed < roads[rhs].fixed || (roads[lhs].fixed == roads[rhs].fixed && min_along(lhs) < min_along(rhs));
+    });
+
+    std::vector<LinePoint> pieces;
+    std::vector<Coord> bounds;
+    // Roads covering the current point, the greatest first. The ones ended are dropped once they come first
+    std::priority_queue<std::pair<std::uint32_t, Coord>> covering;
+    for (auto line = by_start.begin(); line != by_start.end();) {
+        const Coord fixed = roads[*line].fixed;
+        const auto line_end = std::find_if(line, by_start.end(), [&roads, fixed](std::uint32_t road) {
+            return roads[road].fixed != fixed;
+        });
+        bounds.clear();
+        for (auto it = line; it != line_end; ++it) {
+            bounds.push_back(min_along(*it));
+            bounds.push_back(max_along(*it) + 1);
+        }
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+        covering = {};
+        for (const Coord along : bounds) {
+            for (; line != line_end && min_along(*line) <= along; ++line) {
+                covering.emplace(*line, max_along(*line));
+            }
+            while (!covering.empty() && covering.top().second < along) {
+                covering.pop();
+            }
+            const auto road = covering.empty() ? RoadJunctions::NO_ROAD : covering.top().first;
+            if (pieces.empty() || pieces.back().fixed != fixed || pieces.back().road != road) {
+                pieces.push_back({fixed, along, road});
+            }
+        }
+    }
+    return pieces;
+}
+
+}  // namespace
+
+RoadJunctions::RoadJunctions(const std::vector<CompactRoad>& roads)
+    : index_{{BuildPieces(roads, true), BuildPieces(roads, false)}, {}, {}, {}} {
+    for (std::uint32_t i = 0; i != roads.size(); ++i) {
+        const auto& road = roads[i];
+        if (road.horizontal) {
+            index_.starts.push_back({road.fixed, road.start, i});
+            index_.ends.push_back({road.fixed, road.end, i});
+        } else {
+            index_.vertical_lines.push_back({road.fixed, 0, i});
+        }
+    }
+    SortUnique(index_.starts);
+    SortUnique(index_.ends);
+    SortUnique(index_.vertical_lines);
+}
+
+RoadJunctions::RoadJunctions(Index index) noexcept
+    : index_{std::move(index)} {
+}
+
+const RoadJunctions::Index& RoadJunctions::GetIndex() const noexcept {
+    return index_;
+}
+
+std::uint32_t RoadJunctions::FindPoint(const std::vector<LinePoint>& points, Coord fixed, Coord along) noexcept {
+    const LinePoint point{fixed, along, NO_ROAD};
+    const auto it = std::lower_bound(points.begin(), points.end(), point, LinePointLess);
+    return it != points.end() && it->fixed == fixed && it->along == along ? it->road : NO_ROAD;
+}
+
+std::uint32_t RoadJunctions::FindPiece(const std::vector<LinePoint>& pieces, Coord fixed, Coord along) noexcept {
+    const LinePoint point{fixed, along, NO_ROAD};
+    const auto it = std::upper_bound(pieces.begin(), pieces.end(), point, LinePointLess);
+    return it != pieces.begin() && std::prev(it)->fixed == fixed ? std::prev(it)->road : NO_ROAD;
+}
+
+// The same bounds as the road turned to has across the move, ROAD_HALF_WIDTH < 0.5, so at most one coordinate matches
+std::optional<std::size_t> RoadJunctions::FindTurn(const CompactRoad& from, bool horizontal_move, double across) const noexcept {
+    const auto fixed = static_cast<Coord>(std::lround(across));
+    if (across < fixed - ROAD_HALF_WIDTH || across > fixed + ROAD_HALF_WIDTH) {
+        return std::nullopt;
+    }
+
+    std::uint32_t road = NO_ROAD;
+    if (from.horizontal != horizontal_move) {
+        // A road of the other axis crossing the current one
+        road = FindPiece(index_.crossings[horizontal_move ? 0 : 1], fixed, from.fixed);
+    } else if (from.horizontal) {
+        // A road ending where the current one starts or starting where it ends
+        const auto ending = FindPoint(index_.ends, fixed, from.start);
+        const auto starting = FindPoint(index_.starts, fixed, from.end);
+        road = ending == NO_ROAD ? starting : (starting == NO_ROAD ? ending : std::max(ending, starting));
+    } else if (from.fixed == 0 || fixed == 0) {
+        // Vertical roads keep the x of the end they were given in the config as 0, so a vertical road is continued
+        // by any other one when one of them lies on x == 0. Replays of recorded games depend on it
+        road = FindPoint(index_.vertical_lines, fixed, 0);
+    }
+    return road == NO_ROAD ? std::nullopt : std::optional<std::size_t>{road};
+}
+
 Building::Building(Rectangle bounds) noexcept
     : bounds_{bounds} {
 }
@@ -99,31 +243,36 @@ const geom::Point2D& LostObject::GetPosition() const noexcept {
     return pos_;
 }
 
+namespace {
+
+loot_gen::LootGenerator::TimeInterval GetGeneratorInterval(const GeneratorSettings& settings) {
+    const double second = 1000.;
+    return std::chrono::duration_cast<loot_gen::LootGenerator::TimeInterval>(std::chrono::duration<double>{settings.period * second});
+}
+
+}  // namespace
+
 Loot::Loot(const GeneratorSettings& settings, unsigned int loot_types_count, const std::vector<unsigned int>& values) noexcept
     : settings_{settings.period, settings.probability}
     , loot_types_count_{loot_types_count}
-    , values_(values) {
+    , values_(values)
+    , generator_{GetGeneratorInterval(settings), settings.probability} {
 }
 
-unsigned int Loot::GetLootCount(unsigned int looter_count) const noexcept {
-    // Updating the value
+unsigned int Loot::GetLootCount(loot_gen::LootGenerator::TimeInterval time_delta, unsigned int looter_count) {
     looter_count_ = looter_count;
-    // Сalculating the time interval that has elapsed since the previous call to Generate()
-    auto now = std::chrono::steady_clock::now();
-    auto time_delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_generate_time_);
-    last_generate_time_ = now;
-    // Calculate the amount of loot that should appear on the map after a given time interval
-    const double second = 1000.;
-    auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::duration<double>{settings_.period * second});
-    loot_gen::LootGenerator generator(interval, settings_.probability);
-    loot_count_ = generator.Generate(time_delta, loot_count_, looter_count_);
-    return loot_count_;
+    // The generator keeps the time without loot between ticks, so rare spawns are not lost
+    return generator_.Generate(time_delta, static_cast<unsigned int>(objects_.size()), looter_count_);
 }
 
 unsigned int Loot::GetLooterCount() const noexcept {
     return looter_count_;
 }
 
+loot_gen::LootGenerator::TimeInterval Loot::GetTimeWithoutLoot() const noexcept {
+    return generator_.GetTimeWithoutLoot();
+}
+
 unsigned int Loot::GetLootTypesCount() const noexcept {
     return loot_types_count_;
 }
@@ -132,10 +281,22 @@ unsigned int Loot::GetValue(unsigned int type) const noexcept {
     return values_.at(type);
 }
 
+const GeneratorSettings& Loot::GetSettings() const noexcept {
+    return settings_;
+}
+
+const std::vector<unsigned int>& Loot::GetValues() const noexcept {
+    return values_;
+}
+
 const Loot::LostObjects& Loot::GetLostObjects() const noexcept {
     return objects_;
 }
 
+std::uint32_t Loot::GetNextId() const noexcept {
+    return next_id_;
+}
+
 Loot::LostObjectPtr Loot::AddLostObject(unsigned int type, const geom::Point2D& pos)  {
     std::uint32_t id = next_id_;
     ++next_id_;
@@ -153,8 +314,8 @@ void Loot::SetNextId(std::uint32_t next_id) {
     next_id_ = next_id;
 }
 
-void Loot::SetLootCount(unsigned int loot_count) {
-    loot_count_ = loot_count;
+void Loot::SetTimeWithoutLoot(loot_gen::LootGenerator::TimeInterval time_without_loot) {
+    generator_.SetTimeWithoutLoot(time_without_loot);
 }
 
 void Loot::RemoveLostObject(const Loot::LostObjectPtr& object) {
@@ -196,6 +357,14 @@ const Map::Roads& Map::GetRoads() const noexcept {
     return roads_;
 }
 
+const Map::CompactRoads& Map::GetCompactRoads() const noexcept {
+    return compact_roads_;
+}
+
+const RoadJunctions& Map::GetJunctions() const noexcept {
+    return junctions_;
+}
+
 const Map::Offices& Map::GetOffices() const noexcept {
     return offices_;
 }
@@ -204,8 +373,67 @@ const Map::LootPtr& Map::GetLoot() const noexcept {
     return loot_;
 }
 
+std::size_t Map::GetRandomRoadIndex(util::RandomEngine& engine) const {
+    if (!roads_finalized_) {
+        throw std::logic_error("Map roads are not finalized");
+    }
+    if (road_sampler_.empty()) {
+        throw std::out_of_range("Map has no roads");
+    }
+    return road_sampler_.Sample(engine);
+}
+
+const util::AliasTable& Map::GetRoadSampler() const noexcept {
+    return road_sampler_;
+}
+
 void Map::AddRoad(const Road& road) {
     roads_.emplace_back(road);
+    compact_roads_.emplace_back(road);
+    roads_finalized_ = false;
+}
+
+void Map::AddRoads(const Roads& roads) {
+    roads_.insert(roads_.end(), roads.begin(), roads.end());
+    compact_roads_.reserve(roads_.size());
+    for (const auto& road : roads) {
+        compact_roads_.emplace_back(road);
+    }
+    roads_finalized_ = false;
+}
+
+void Map::FinalizeRoads() {
+    if (roads_finalized_) {
+        return;
+    }
+    std::vector<double> areas;
+    areas.reserve(roads_.size());
+    for (const auto& road : roads_) {
+        areas.emplace_back((road.GetMax().x - road.GetMin().x) * (road.GetMax().y - road.GetMin().y));
+    }
+    road_sampler_.Build(areas);
+    junctions_ = RoadJunctions{compact_roads_};
+    roads_finalized_ = true;
+}
+
+void Map::SetRoads(Roads roads, util::AliasTable road_sampler, RoadJunctions junctions) {
+    if (road_sampler.size() != roads.size()) {
+        throw std::invalid_argument("Road sampler does not match the roads");
+    }
+    const auto& index = junctions.GetIndex();
+    for (const auto* points : {&index.crossings[0], &index.crossings[1], &index.starts, &index.ends, &index.vertical_lines}) {
+        for (const auto& point : *points) {
+            if (point.road != RoadJunctions::NO_ROAD && point.road >= roads.size()) {
+                throw std::invalid_argument("Junctions do not match the roads");
+            }
+        }
+    }
+    // Compact roads are a per-road transform, cheaper to redo than to load
+    roads_ = std::move(roads);
+    compact_roads_ = CompactRoads(roads_.begin(), roads_.end());
+    junctions_ = std::move(junctions);
+    road_sampler_ = std::move(road_sampler);
+    roads_finalized_ = true;
 }
 
 void Map::AddBuilding(const Building& building) {
@@ -287,196 +515,98 @@ void Dog::SetCurrentRoadsIndex(std::size_t index) {
     current_index_ = index;
 }
 
-void Dog::SetPositionWhenMovingWest(const Map::Roads& roads, int delta) {
-    double new_x, new_y;
+// A dog that leaves its road across one of the edges turns to a road that it enters there, if any,
+// and stops at the edge of the road it ends up on
+void Dog::SetPositionWhenMovingWest(const Map& map, int delta) {
+    const auto& roads = map.GetCompactRoads();
     const double second = 1000.;
-    new_x = GetPosition().x + GetSpeed().x * (delta / second);
-    new_y = GetPosition().y;
-    geom::Point2D new_pos;
-    new_pos = {new_x, new_y};
+    const geom::Point2D new_pos{GetPosition().x + GetSpeed().x * (delta / second), GetPosition().y};
 
     const auto& current_road = roads.at(GetCurrentRoadsIndex());
     if (IsWithinRoadBounds(new_pos, current_road)) {
-        SetPosition({new_pos.x, new_pos.y});
-    } else {
-        for (std::size_t i = 0; i != roads.size(); ++i) {
-            // Checking for the transition between vertical and horizontal roads
-            // We check whether the new position is in the range of the next road
-            if (current_road.IsVertical() && roads[i].IsHorizontal() &&
-                new_pos.y >= roads[i].GetMin().y && new_pos.y <= roads[i].GetMax().y) {
-                if (current_road.GetStart().x <= roads[i].GetEnd().x && current_road.GetStart().x >= roads[i].GetStart().x) {
-                    // We check whether the new position is located beyond the minimum boundary of the current road
-                    if (new_pos.x < current_road.GetMin().x) {
-                        SetCurrentRoadsIndex(i);
-                    }
-                } else if (current_road.GetStart().x <= roads[i].GetStart().x && current_road.GetStart().x >= roads[i].GetEnd().x) {
-                    if (new_pos.x < current_road.GetMin().x) {
-                        SetCurrentRoadsIndex(i);
-                    }
-                }
-            // Checking for the transition between roads with the same direction
-            } else if (current_road.IsHorizontal() && roads[i].IsHorizontal() &&
-                       new_pos.y >= roads[i].GetMin().y && new_pos.y <= roads[i].GetMax().y) {
-                // We check whether the current road continues to the next one
-                if (current_road.GetStart().x == roads[i].GetEnd().x ||
-                    current_road.GetEnd().x == roads[i].GetStart().x) {
-                        if (new_pos.x < current_road.GetMin().x) {
-                            SetCurrentRoadsIndex(i);
-                        }
-                }
-            }
-        }
-        std::size_t ci = GetCurrentRoadsIndex();
-        if (new_pos.x < roads.at(ci).GetMin().x) {
-            new_x = roads.at(ci).GetMin().x;
-            SetSpeed({0.0, 0.0});
+        SetPosition(new_pos);
+        return;
+    }
+    if (new_pos.x < current_road.GetMinX()) {
+        if (const auto turn = map.GetJunctions().FindTurn(current_road, true, new_pos.y)) {
+            SetCurrentRoadsIndex(*turn);
         }
-        SetPosition({new_x, new_y});
     }
+    double new_x = new_pos.x;
+    if (const double min_x = roads.at(GetCurrentRoadsIndex()).GetMinX(); new_pos.x < min_x) {
+        new_x = min_x;
+        SetSpeed({0.0, 0.0});
+    }
+    SetPosition({new_x, new_pos.y});
 }
 
-void Dog::SetPositionWhenMovinggEast(const Map::Roads& roads, int delta) {
-    double new_x, new_y;
+void Dog::SetPositionWhenMovinggEast(const Map& map, int delta) {
+    const auto& roads = map.GetCompactRoads();
     const double second = 1000.;
-    new_x = GetPosition().x + GetSpeed().x * (delta / second);
-    new_y = GetPosition().y;
-    geom::Point2D new_pos;
-    new_pos = {new_x, new_y};
+    const geom::Point2D new_pos{GetPosition().x + GetSpeed().x * (delta / second), GetPosition().y};
 
     const auto& current_road = roads.at(GetCurrentRoadsIndex());
     if (IsWithinRoadBounds(new_pos, current_road)) {
-        SetPosition({new_pos.x, new_pos.y});
-    } else {
-        for (std::size_t i = 0; i != roads.size(); ++i) {
-            // Checking for the transition between vertical and horizontal roads
-            // We check whether the new position is in the range of the next road
-            if (current_road.IsVertical() && roads[i].IsHorizontal() &&
-                new_pos.y >= roads[i].GetMin().y && new_pos.y <= roads[i].GetMax().y) {
-                if (current_road.GetStart().x <= roads[i].GetEnd().x && current_road.GetStart().x >= roads[i].GetStart().x) {
-                    // We check whether the new position is located beyond the maximum boundary of the current road
-                    if (new_pos.x > current_road.GetMax().x) {
-                        SetCurrentRoadsIndex(i);
-                    }
-                } else if (current_road.GetStart().x <= roads[i].GetStart().x && current_road.GetStart().x >= roads[i].GetEnd().x) {
-                    if (new_pos.x > current_road.GetMax().x) {
-                        SetCurrentRoadsIndex(i);
-                    }
-                }
-            // Checking for the transition between roads with the same direction
-            } else if (current_road.IsHorizontal() && roads[i].IsHorizontal() &&
-                       new_pos.y >= roads[i].GetMin().y && new_pos.y <= roads[i].GetMax().y) {
-                // We check whether the current road continues to the next one
-                if (current_road.GetStart().x == roads[i].GetEnd().x ||
-                    current_road.GetEnd().x == roads[i].GetStart().x) {
-                        if (new_pos.x > current_road.GetMax().x) {
-                            SetCurrentRoadsIndex(i);
-                        }
-                }
-            }
-        }
-        std::size_t ci = GetCurrentRoadsIndex();
-        if (new_pos.x > roads.at(ci).GetMax().x) {
-            new_x = roads.at(ci).GetMax().x;
-            SetSpeed({0.0, 0.0});
+        SetPosition(new_pos);
+        return;
+    }
+    if (new_pos.x > current_road.GetMaxX()) {
+        if (const auto turn = map.GetJunctions().FindTurn(current_road, true, new_pos.y)) {
+            SetCurrentRoadsIndex(*turn);
         }
-        SetPosition({new_x, new_y});
     }
+    double new_x = new_pos.x;
+    if (const double max_x = roads.at(GetCurrentRoadsIndex()).GetMaxX(); new_pos.x > max_x) {
+        new_x = max_x;
+        SetSpeed({0.0, 0.0});
+    }
+    SetPosition({new_x, new_pos.y});
 }
 
-void Dog::SetPositionWhenMovingNorth(const Map::Roads& roads, int delta) {
-    double new_x, new_y;
+void Dog::SetPositionWhenMovingNorth(const Map& map, int delta) {
+    const auto& roads = map.GetCompactRoads();
     const double second = 1000.;
-    new_x = GetPosition().x;
-    new_y = GetPosition().y + GetSpeed().y * (delta / second);
-    geom::Point2D new_pos;
-    new_pos = {new_x, new_y};
+    const geom::Point2D new_pos{GetPosition().x, GetPosition().y + GetSpeed().y * (delta / second)};
 
     const auto& current_road = roads.at(GetCurrentRoadsIndex());
     if (IsWithinRoadBounds(new_pos, current_road)) {
-        SetPosition({new_pos.x, new_pos.y});
-    } else {
-        for (std::size_t i = 0; i != roads.size(); ++i) {
-            // Checking for the transition between horizontal and vertical roads
-            // We check whether the new position is in the range of the next road
-            if (current_road.IsHorizontal() && roads[i].IsVertical() &&
-                new_pos.x >= roads[i].GetMin().x && new_pos.x <= roads[i].GetMax().x) {
-                if (current_road.GetStart().y <= roads[i].GetEnd().y && current_road.GetStart().y >= roads[i].GetStart().y) {
-                    // We check whether the new position is located beyond the minimum boundary of the current road
-                    if (new_pos.y < current_road.GetMin().y) {
-                        SetCurrentRoadsIndex(i);
-                    }
-                } else if (current_road.GetStart().y <= roads[i].GetStart().y && current_road.GetStart().y >= roads[i].GetEnd().y) {
-                    if (new_pos.y < current_road.GetMin().y) {
-                        SetCurrentRoadsIndex(i);
-                    }
-                }
-            // Checking for the transition between roads with the same direction
-            } else if (current_road.IsVertical() && roads[i].IsVertical() &&
-                       new_pos.x >= roads[i].GetMin().x && new_pos.x <= roads[i].GetMax().x) {
-                // We check whether the current road continues to the next one
-                if (current_road.GetStart().x == roads[i].GetEnd().x ||
-                    current_road.GetEnd().x == roads[i].GetStart().x) {
-                        if (new_pos.y < current_road.GetMin().y) {
-                            SetCurrentRoadsIndex(i);
-                        }
-                }
-            }
-        }
-        std::size_t ci = GetCurrentRoadsIndex();
-        if (new_pos.y < roads.at(ci).GetMin().y) {
-            new_y = roads.at(ci).GetMin().y;
-            SetSpeed({0.0, 0.0});
+        SetPosition(new_pos);
+        return;
+    }
+    if (new_pos.y < current_road.GetMinY()) {
+        if (const auto turn = map.GetJunctions().FindTurn(current_road, false, new_pos.x)) {
+            SetCurrentRoadsIndex(*turn);
         }
-        SetPosition({new_x, new_y});
     }
+    double new_y = new_pos.y;
+    if (const double min_y = roads.at(GetCurrentRoadsIndex()).GetMinY(); new_pos.y < min_y) {
+        new_y = min_y;
+        SetSpeed({0.0, 0.0});
+    }
+    SetPosition({new_pos.x, new_y});
 }
 
-void Dog::SetPositionWhenMovingSouth(const Map::Roads& roads, int delta) {
-    double new_x, new_y;
+void Dog::SetPositionWhenMovingSouth(const Map& map, int delta) {
+    const auto& roads = map.GetCompactRoads();
     const double second = 1000.;
-    new_x = GetPosition().x;
-    new_y = GetPosition().y + GetSpeed().y * (delta / second);
-    geom::Point2D new_pos;
-    new_pos = {new_x, new_y};
+    const geom::Point2D new_pos{GetPosition().x, GetPosition().y + GetSpeed().y * (delta / second)};
 
     const auto& current_road = roads.at(GetCurrentRoadsIndex());
     if (IsWithinRoadBounds(new_pos, current_road)) {
-        SetPosition({new_pos.x, new_pos.y});
-    } else {
-        for (std::size_t i = 0; i != roads.size(); ++i) {
-            // Checking for the transition between horizontal and vertical roads
-            // We check whether the new position is in the range of the next road
-            if (current_road.IsHorizontal() && roads[i].IsVertical() &&
-                new_pos.x >= roads[i].GetMin().x && new_pos.x <= roads[i].GetMax().x) {
-                if (current_road.GetStart().y <= roads[i].GetEnd().y && current_road.GetStart().y >= roads[i].GetStart().y) {
-                    // We check whether the new position is located beyond the maximum boundary of the current road
-                    if (new_pos.y > current_road.GetMax().y) {
-                        SetCurrentRoadsIndex(i);
-                    }
-                } else if (current_road.GetStart().y <= roads[i].GetStart().y && current_road.GetStart().y >= roads[i].GetEnd().y) {
-                    if (new_pos.y > current_road.GetMax().y) {
-                        SetCurrentRoadsIndex(i);
-                    }
-                }
-            // Checking for the transition between roads with the same direction
-            } else if (current_road.IsVertical() && roads[i].IsVertical() &&
-                       new_pos.x >= roads[i].GetMin().x && new_pos.x <= roads[i].GetMax().x) {
-                // We check whether the current road continues to the next one
-                if (current_road.GetStart().x == roads[i].GetEnd().x ||
-                    current_road.GetEnd().x == roads[i].GetStart().x) {
-                        if (new_pos.y > current_road.GetMax().y) {
-                            SetCurrentRoadsIndex(i);
-                        }
-                }
-            }
-        }
-        std::size_t ci = GetCurrentRoadsIndex();
-        if (new_pos.y > roads.at(ci).GetMax().y) {
-            new_y = roads.at(ci).GetMax().y;
-            SetSpeed({0.0, 0.0});
+        SetPosition(new_pos);
+        return;
+    }
+    if (new_pos.y > current_road.GetMaxY()) {
+        if (const auto turn = map.GetJunctions().FindTurn(current_road, false, new_pos.x)) {
+            SetCurrentRoadsIndex(*turn);
         }
-        SetPosition({new_x, new_y});
     }
+    double new_y = new_pos.y;
+    if (const double max_y = roads.at(GetCurrentRoadsIndex()).GetMaxY(); new_pos.y > max_y) {
+        new_y = max_y;
+        SetSpeed({0.0, 0.0});
+    }
+    SetPosition({new_pos.x, new_y});
 }
 
 std::size_t Dog::GetBagCapacity() const noexcept {
@@ -519,8 +649,19 @@ GameState::GameState(GameSession::DogPtr dog_ptr)
     : current_dog_ptr{dog_ptr} {
 }
 
-GameSession::GameSession(const Map& map) noexcept
-    : map_{&map} {
+GameSession::GameSession(MapPtr map)
+    : GameSession(Id{0u}, std::move(map)) {
+}
+
+GameSession::GameSession(Id id, MapPtr map)
+    : GameSession(id, std::move(map), util::NondeterministicSeed()) {
+}
+
+GameSession::GameSession(Id id, MapPtr map, std::uint64_t seed)
+    : id_{id}
+    , map_{std::move(map)}
+    , loot_{map_->GetLoot() ? std::make_shared<Loot>(*map_->GetLoot()) : nullptr}
+    , random_engine_{seed} {
 }
 
 GameSession::DogPtr GameSession::AddDog(const std::string& name, const geom::Point2D& pos, std::size_t index) {
@@ -535,8 +676,24 @@ GameSession::DogPtr GameSession::AddDog(const std::string& name, const geom::Poi
     return dog_ptr;
 }
 
+const GameSession::Id& GameSession::GetId() const noexcept {
+    return id_;
+}
+
 const Map* GameSession::GetMap() const noexcept {
-    return map_;
+    return map_.get();
+}
+
+const Map::LootPtr& GameSession::GetLoot() const noexcept {
+    return loot_;
+}
+
+util::RandomEngine& GameSession::GetRandomEngine() noexcept {
+    return random_engine_;
+}
+
+const util::RandomEngine& GameSession::GetRandomEngine() const noexcept {
+    return random_engine_;
 }
 
 const GameSession::Dogs& GameSession::GetDogs() const noexcept {
@@ -565,24 +722,45 @@ void GameSession::SetNextId(std::uint32_t next_id) {
     next_id_ = next_id;
 }
 
-void GameSession::UpdateGameState(int delta) {
-    UpdateDogs(delta);
-    UpdateLostObjects();
-    ProcessGatherEvents();
-    ProcessReturnToBaseEvents();
+const GameSession::TickPhaseStats& GameSession::GetTickPhaseStats() const noexcept {
+    return tick_phase_stats_;
+}
+
+void GameSession::UpdateGameState(int delta, util::TraceRecorder* trace) {
+    // Session tracks are shifted by one, the first track belongs to the work done for the whole server
+    const auto track = *id_ + 1;
+    auto timer = [this, trace, track](TickPhase phase) {
+        return util::ScopedTimer{tick_phase_stats_[static_cast<std::size_t>(phase)], trace, GetTickPhaseName(phase), track};
+    };
+    {
+        auto scope = timer(TickPhase::UPDATE_DOGS);
+        UpdateDogs(delta);
+    }
+    {
+        auto scope = timer(TickPhase::UPDATE_LOST_OBJECTS);
+        UpdateLostObjects(delta);
+    }
+    {
+        auto scope = timer(TickPhase::GATHER_EVENTS);
+        ProcessGatherEvents();
+    }
+    {
+        auto scope = timer(TickPhase::RETURN_TO_BASE_EVENTS);
+        ProcessReturnToBaseEvents();
+    }
 }
 
 void GameSession::SetLocationDogs(const DogPtr& dog_ptr, int delta) {
-    const auto& roads = GetMap()->GetRoads();
+    const auto& map = *GetMap();
     const auto& dir = dog_ptr->GetDirection();
     if (dir == model::Dog::Direction::WEST){
-        dog_ptr->SetPositionWhenMovingWest(roads, delta);
+        dog_ptr->SetPositionWhenMovingWest(map, delta);
     } else if (dir == model::Dog::Direction::EAST) {
-        dog_ptr->SetPositionWhenMovinggEast(roads, delta);
+        dog_ptr->SetPositionWhenMovinggEast(map, delta);
     } else if (dir == model::Dog::Direction::NORTH) {
-        dog_ptr->SetPositionWhenMovingNorth(roads, delta);
+        dog_ptr->SetPositionWhenMovingNorth(map, delta);
     } else if (dir == model::Dog::Direction::SOUTH) {
-        dog_ptr->SetPositionWhenMovingSouth(roads, delta);
+        dog_ptr->SetPositionWhenMovingSouth(map, delta);
     }
 }
 
@@ -609,13 +787,13 @@ void GameSession::UpdateDogs(int delta) {
     }
 }
 
-void GameSession::UpdateLostObjects() {
+void GameSession::UpdateLostObjects(int delta) {
     unsigned int looter_count = gatherers_.size();
-    const auto& loot = map_->GetLoot();
-    const auto loot_count = loot->GetLootCount(looter_count);
+    const auto& loot = loot_;
+    const auto loot_count = loot->GetLootCount(loot_gen::LootGenerator::TimeInterval{delta}, looter_count);
     for (unsigned int i = 0u; i < loot_count; ++i) {
-        auto type = GetRandomType(loot->GetLootTypesCount());
-        auto pos = GetRandomPosition(map_->GetRoads().at(GetRandomIndex(map_->GetRoads().size())));
+        auto type = GetRandomType(loot->GetLootTypesCount(), random_engine_);
+        auto pos = GetRandomPosition(map_->GetRoads().at(map_->GetRandomRoadIndex(random_engine_)), random_engine_);
         if (auto lost_object = loot->AddLostObject(type, pos); lost_object) {
             items_.emplace_back(collision_detector::Item{
                                                             lost_object->GetPosition(),
@@ -642,7 +820,7 @@ void GameSession::ProcessGatherEvents() {
             }
         );
     }
-    const auto& lost_objects =  map_->GetLoot()->GetLostObjects();
+    const auto& lost_objects = loot_->GetLostObjects();
     for (const auto& event : events) {
         if (auto it = std::find_if(lost_objects.begin(), lost_objects.end(),
                                         [&event](const auto& obj_ptr) {
@@ -650,7 +828,7 @@ void GameSession::ProcessGatherEvents() {
                                         }
             ); it != lost_objects.end()) {
             if (dogs_.at(event.gatherer_id)->PutToBag({model::FoundObject::Id{*((*it)->GetId())}, (*it)->GetType()})) {
-                map_->GetLoot()->RemoveLostObject((*it));
+                loot_->RemoveLostObject((*it));
             }
         }
     }
@@ -677,19 +855,20 @@ void GameSession::ProcessReturnToBaseEvents() {
 
         const auto& dog_ptr = *it;
         for (const auto& found_object : dog_ptr->GetBagContent()) {
-            dog_ptr->AddScore(map_->GetLoot()->GetValue(found_object.type));
+            dog_ptr->AddScore(loot_->GetValue(found_object.type));
         }
         dog_ptr->EmptyBag();
     }
 }
 
 void Game::AddMap(Map map) {
+    map.FinalizeRoads();
     const size_t index = maps_.size();
     if (auto [it, inserted] = map_id_to_index_.emplace(map.GetId(), index); !inserted) {
         throw std::invalid_argument("Map with id "s + *map.GetId() + " already exists"s);
     } else {
         try {
-            maps_.emplace_back(std::move(map));
+            maps_.emplace_back(std::make_shared<const Map>(std::move(map)));
         } catch (...) {
             map_id_to_index_.erase(it);
             throw;
@@ -697,68 +876,156 @@ void Game::AddMap(Map map) {
     }
 }
 
-void Game::AddGameSession(const model::Map* map) {
-    sessions_.emplace_back(std::make_shared<GameSession>((*map)));
+void Game::ReplaceMaps(Maps maps) {
+    // The index is built aside, so the current maps stay untouched if the new set is rejected
+    MapIdToIndex map_id_to_index;
+    for (std::size_t i = 0; i != maps.size(); ++i) {
+        if (!maps[i]) {
+            throw std::invalid_argument("Map is missing");
+        }
+        if (!map_id_to_index.emplace(maps[i]->GetId(), i).second) {
+            throw std::invalid_argument("Map with id "s + *maps[i]->GetId() + " already exists"s);
+        }
+    }
+    maps_ = std::move(maps);
+    map_id_to_index_ = std::move(map_id_to_index);
+    // Sessions on the replaced maps get no new players
+    map_id_to_vacant_session_indices_.clear();
+    ++maps_version_;
+}
+
+Game::GameSessionPtr Game::AddGameSession(MapPtr map) {
+    return AddGameSession(std::move(map), GameSession::Id{next_session_id_});
+}
+
+Game::GameSessionPtr Game::AddGameSession(MapPtr map, GameSession::Id id) {
+    const size_t index = sessions_.size();
+    const auto map_id = map->GetId();
+    const bool is_current_map = FindMap(map_id) == map;
+    if (session_id_to_index_.contains(id)) {
+        throw std::invalid_argument("Game session with id "s + std::to_string(*id) + " already exists"s);
+    }
+    try {
+        map_id_to_session_indices_.try_emplace(map_id).first->second.push_back(index);
+        if (is_current_map) {
+            map_id_to_vacant_session_indices_.try_emplace(map_id).first->second.push_back(index);
+        }
+        session_id_to_index_.emplace(id, index);
+        const std::uint64_t seed = random_seed_ ? util::MixSeed(*random_seed_, *id) : util::NondeterministicSeed();
+        sessions_.emplace_back(std::make_shared<GameSession>(id, std::move(map), seed));
+    } catch (...) {
+        // Only an allocation can fail here. A map listed in the index always has at least one session
+        RemoveSessionIndex(map_id_to_session_indices_, map_id, index);
+        RemoveSessionIndex(map_id_to_vacant_session_indices_, map_id, index);
+        session_id_to_index_.erase(id);
+        throw;
+    }
+    next_session_id_ = std::max(next_session_id_, *id + 1);
+    return sessions_.back();
+}
+
+void Game::RemoveSessionIndex(MapIdToSessionIndices& indices, const Map::Id& map_id, size_t index) noexcept {
+    if (auto it = indices.find(map_id); it != indices.end()) {
+        if (!it->second.empty() && it->second.back() == index) {
+            it->second.pop_back();
+        }
+        if (it->second.empty()) {
+            indices.erase(it);
+        }
+    }
+}
+
+void Game::SetRandomSeed(std::uint64_t seed) noexcept {
+    random_seed_ = seed;
 }
 
 const Game::Maps& Game::GetMaps() const noexcept {
     return maps_;
 }
 
+std::uint32_t Game::GetMapsVersion() const noexcept {
+    return maps_version_;
+}
+
 const Game::GameSessions& Game::GetGameSessions() const noexcept {
     return sessions_;
 }
 
-const Map* Game::FindMap(const Map::Id& id) const noexcept {
+Game::MapPtr Game::FindMap(const Map::Id& id) const noexcept {
     if (auto it = map_id_to_index_.find(id); it != map_id_to_index_.end()) {
-        return &maps_.at(it->second);
+        return maps_.at(it->second);
     }
     return nullptr;
 }
 
 Game::GameSessionPtr Game::FindGameSession(const Map::Id& id) const noexcept {
-    auto it = std::find_if(sessions_.begin(), sessions_.end(), [&id](const Game::GameSessionPtr& session) {
-        return session->GetMap()->GetId() == id;
-    });
-
-    if (it != sessions_.end()) {
-        return (*it);
+    const auto map = FindMap(id);
+    if (auto it = map_id_to_session_indices_.find(id); map && it != map_id_to_session_indices_.end()) {
+        for (const auto index : it->second) {
+            if (const auto& session = sessions_.at(index); session->GetMap() == map.get()) {
+                return session;
+            }
+        }
     }
     return nullptr;
 }
 
-std::size_t GetRandomIndex(std::size_t count) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<std::size_t> dis(0, (count - 1));
-    std::size_t i = (dis(gen));
-    return i;
+Game::GameSessionPtr Game::FindGameSession(const GameSession::Id& id) const noexcept {
+    if (auto it = session_id_to_index_.find(id); it != session_id_to_index_.end()) {
+        return sessions_.at(it->second);
+    }
+    return nullptr;
 }
 
-geom::Point2D GetRandomPosition(const Road& road) {
-    double x_min = road.GetMin().x;
-    double x_max = road.GetMax().x;
-    double y_min = road.GetMin().y;
-    double y_max = road.GetMax().y;
+void Game::SetMaxSessionDogs(std::size_t max_dogs) noexcept {
+    max_session_dogs_ = max_dogs;
+}
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+Game::GameSessionPtr Game::FindVacantGameSession(const Map::Id& id) {
+    auto it = map_id_to_vacant_session_indices_.find(id);
+    if (it == map_id_to_vacant_session_indices_.end()) {
+        return nullptr;
+    }
+    // Dogs never leave a session, so a session found full is dropped from the list for good
+    // and each session is passed over at most once
+    auto& indices = it->second;
+    while (!indices.empty()) {
+        const auto& session = sessions_.at(indices.back());
+        if (max_session_dogs_ == 0 || session->GetDogs().size() < max_session_dogs_) {
+            return session;
+        }
+        indices.pop_back();
+    }
+    return nullptr;
+}
 
-    std::uniform_real_distribution<double> x_dis(x_min, x_max);
-    std::uniform_real_distribution<double> y_dis(y_min, y_max);
+std::size_t GetRandomIndex(std::size_t count, util::RandomEngine& engine) {
+    return static_cast<std::size_t>(engine.NextIndex(count));
+}
 
-    double random_x, random_y;
-    random_x = x_dis(gen);
-    random_y = y_dis(gen);
+geom::Point2D GetRandomPosition(const Road& road, util::RandomEngine& engine) {
+    double random_x = engine.NextDouble(road.GetMin().x, road.GetMax().x);
+    double random_y = engine.NextDouble(road.GetMin().y, road.GetMax().y);
     return {random_x, random_y};
 }
 
-unsigned int GetRandomType(unsigned int loot_types_count) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<unsigned int> dis(0u, loot_types_count);
-    const unsigned int type = (dis(gen));
-    return type;
+unsigned int GetRandomType(unsigned int loot_types_count, util::RandomEngine& engine) {
+    // loot_types_count is the index of the last loot type, so it is included in the range
+    return static_cast<unsigned int>(engine.NextIndex(static_cast<std::uint64_t>(loot_types_count) + 1));
+}
+
+std::string_view GetTickPhaseName(TickPhase phase) noexcept {
+    switch (phase) {
+        case TickPhase::UPDATE_DOGS:
+            return "UpdateDogs"sv;
+        case TickPhase::UPDATE_LOST_OBJECTS:
+            return "UpdateLostObjects"sv;
+        case TickPhase::GATHER_EVENTS:
+            return "ProcessGatherEvents"sv;
+        case TickPhase::RETURN_TO_BASE_EVENTS:
+            return "ProcessReturnToBaseEvents"sv;
+    }
+    return "Unknown"sv;
 }
 
 }  // namespace model
@@ -1,13 +1,19 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <memory>
-#include <random>
+#include <optional>
 #include <string>
 #include <map>
 #include <unordered_map>
 #include <vector>
 
+#include "../util/alias_table.h"
 #include "../util/geom.h"
+#include "../util/profiler.h"
+#include "../util/random.h"
 #include "../util/tagged.h"
 #include "../generator/loot_generator.h"
 #include "../detector/collision_detector.h"
@@ -49,6 +55,9 @@ struct FoundObject {
     [[nodiscard]] auto operator<=>(const FoundObject&) const = default;
 };
 
+// Distance from the axis of a road to its edge
+inline constexpr double ROAD_HALF_WIDTH = 0.4;
+
 class Road {
 public:
     enum class Direction {
@@ -73,11 +82,98 @@ private:
     Point end_;
     geom::Point2D min_;
     geom::Point2D max_;
-    static constexpr double offset_from_axis_{0.4};
+    static constexpr double offset_from_axis_{ROAD_HALF_WIDTH};
 
     void SetBounds();
 };
 
+// Road laid out for the movement of dogs, which reads it at every tick.
+// Two records fill a cache line and the accessors are inline. The bounds along the axis are kept,
+// the bounds across it are fixed ± ROAD_HALF_WIDTH, both equal to the bounds of the Road it is made of
+struct alignas(32) CompactRoad {
+    double min_along;
+    double max_along;
+    // y of a horizontal road, x of a vertical one
+    Coord fixed;
+    // Coordinates along the axis as given in the config, the start may be greater than the end
+    Coord start;
+    Coord end;
+    bool horizontal;
+
+    explicit CompactRoad(const Road& road) noexcept;
+
+    double GetMinAcross() const noexcept {
+        return fixed - ROAD_HALF_WIDTH;
+    }
+
+    double GetMaxAcross() const noexcept {
+        return fixed + ROAD_HALF_WIDTH;
+    }
+
+    double GetMinX() const noexcept {
+        return horizontal ? min_along : GetMinAcross();
+    }
+
+    double GetMaxX() const noexcept {
+        return horizontal ? max_along : GetMaxAcross();
+    }
+
+    double GetMinY() const noexcept {
+        return horizontal ? GetMinAcross() : min_along;
+    }
+
+    double GetMaxY() const noexcept {
+        return horizontal ? GetMaxAcross() : max_along;
+    }
+};
+
+static_assert(sizeof(CompactRoad) == 32);
+
+// Roads that a dog leaving a road across one of its edges may turn to, indexed once when the roads are finalized.
+// The dog turns to a road crossing its road or continuing it at the coordinate across its move,
+// of several ones to the one with the greatest index, as it used to turn to the last matching road of the map
+class RoadJunctions {
+public:
+    static constexpr std::uint32_t NO_ROAD = std::numeric_limits<std::uint32_t>::max();
+
+    // A point on the line `fixed` across the axis of the roads, `along` it
+    struct LinePoint {
+        Coord fixed;
+        Coord along;
+        std::uint32_t road;
+    };
+
+    // Lookup tables of the junctions, all sorted by LinePoint::fixed and then by LinePoint::along
+    struct Index {
+        // For the horizontal and the vertical roads: pieces of their lines from `along` up to the next piece,
+        // each covered by the same greatest road
+        std::array<std::vector<LinePoint>, 2> crossings;
+        // Greatest horizontal road starting and ending at a point
+        std::vector<LinePoint> starts;
+        std::vector<LinePoint> ends;
+        // Greatest vertical road on every line, `along` is 0
+        std::vector<LinePoint> vertical_lines;
+    };
+
+    RoadJunctions() = default;
+    explicit RoadJunctions(const std::vector<CompactRoad>& roads);
+    // Takes the index built for the same roads before, e.g. it is loaded from the map cache
+    explicit RoadJunctions(Index index) noexcept;
+
+    const Index& GetIndex() const noexcept;
+
+    // Road that a dog leaving the road `from` along x (horizontal_move) or y turns to at the given coordinate across its move
+    std::optional<std::size_t> FindTurn(const CompactRoad& from, bool horizontal_move, double across) const noexcept;
+
+private:
+    // Greatest road at the point or NO_ROAD
+    static std::uint32_t FindPoint(const std::vector<LinePoint>& points, Coord fixed, Coord along) noexcept;
+    // Greatest road covering the point or NO_ROAD
+    static std::uint32_t FindPiece(const std::vector<LinePoint>& pieces, Coord fixed, Coord along) noexcept;
+
+    Index index_;
+};
+
 class Building {
 public:
     explicit Building(Rectangle bounds) noexcept;
@@ -129,17 +225,22 @@ public:
 
     Loot(const GeneratorSettings& settings, unsigned int loot_types_count, const std::vector<unsigned int>& values) noexcept;
 
-    unsigned int GetLootCount(unsigned int looter_count) const noexcept;
+    // Returns the number of lost objects to spawn after time_delta of simulated time
+    unsigned int GetLootCount(loot_gen::LootGenerator::TimeInterval time_delta, unsigned int looter_count);
     unsigned int GetLooterCount() const noexcept;
+    loot_gen::LootGenerator::TimeInterval GetTimeWithoutLoot() const noexcept;
     unsigned int GetLootTypesCount() const noexcept;
     unsigned int GetValue(unsigned int type) const noexcept;
+    const GeneratorSettings& GetSettings() const noexcept;
+    const std::vector<unsigned int>& GetValues() const noexcept;
     const LostObjects& GetLostObjects() const noexcept;
+    std::uint32_t GetNextId() const noexcept;
 
     LostObjectPtr AddLostObject(unsigned int type, const geom::Point2D& pos);
 
     void SetLostObjects(const LostObjects& objects);
     void SetNextId(std::uint32_t next_id);
-    void SetLootCount(unsigned int loot_count);
+    void SetTimeWithoutLoot(loot_gen::LootGenerator::TimeInterval time_without_loot);
 
     void RemoveLostObject(const LostObjectPtr& object);
 
@@ -147,9 +248,8 @@ private:
     GeneratorSettings settings_;
     unsigned int loot_types_count_;
     std::vector<unsigned int> values_;
-    mutable unsigned int looter_count_;
-    mutable unsigned int loot_count_;
-    mutable std::chrono::steady_clock::time_point last_generate_time_ = std::chrono::steady_clock::now();
+    loot_gen::LootGenerator generator_;
+    unsigned int looter_count_{0u};
     std::uint32_t next_id_{0u};
     LostObjects objects_;
 };
@@ -158,22 +258,43 @@ class Map {
 public:
     using Id = util::Tagged<std::string, Map>;
     using Roads = std::vector<Road>;
+    using CompactRoads = std::vector<CompactRoad>;
     using Buildings = std::vector<Building>;
     using Offices = std::vector<Office>;
     using LootPtr = std::shared_ptr<Loot>;
 
     Map(Id id, std::string name, double dog_speed, std::size_t bag_capacity) noexcept;
 
+    // A map is built once and then shared by the game and its sessions, so it is never copied
+    Map(const Map&) = delete;
+    Map& operator=(const Map&) = delete;
+    Map(Map&&) = default;
+    Map& operator=(Map&&) = default;
+
     const Id& GetId() const noexcept;
     const std::string& GetName() const noexcept;
     double GetDogSpeed() const noexcept;
     std::size_t GetBagCapacity() const noexcept;
     const Buildings& GetBuildings() const noexcept;
     const Roads& GetRoads() const noexcept;
+    // The same roads in the same order
+    const CompactRoads& GetCompactRoads() const noexcept;
+    // Holds the roads there were at the last FinalizeRoads, a dog never turns to the ones added after it
+    const RoadJunctions& GetJunctions() const noexcept;
     const Offices& GetOffices() const noexcept;
     const LootPtr& GetLoot() const noexcept;
 
+    // Picks a road with probability proportional to its area, so longer roads get more spawns.
+    // Throws std::logic_error if roads were added after the last FinalizeRoads
+    std::size_t GetRandomRoadIndex(util::RandomEngine& engine) const;
+    const util::AliasTable& GetRoadSampler() const noexcept;
+
     void AddRoad(const Road& road);
+    void AddRoads(const Roads& roads);
+    // Builds the road sampler and the junctions once all the roads are added, Game::AddMap does it for the maps it takes
+    void FinalizeRoads();
+    // Replaces the roads, the sampler and the junctions must have been built for them, e.g. they are loaded from the map cache
+    void SetRoads(Roads roads, util::AliasTable road_sampler, RoadJunctions junctions);
     void AddBuilding(const Building& building);
     void AddOffice(const Office& office);
     void AddLoot(const GeneratorSettings& settings, unsigned int loot_types_count, const std::vector<unsigned int>& values);
@@ -186,6 +307,10 @@ private:
     double dog_speed_;
     std::size_t bag_capacity_;
     Roads roads_;
+    CompactRoads compact_roads_;
+    RoadJunctions junctions_;
+    util::AliasTable road_sampler_;
+    bool roads_finalized_{true};
     Buildings buildings_;
     OfficeIdToIndex warehouse_id_to_index_;
     Offices offices_;
@@ -194,6 +319,10 @@ private:
 
 bool IsWithinRoadBounds(const geom::Point2D& pos, const model::Road& road);
 
+inline bool IsWithinRoadBounds(const geom::Point2D& pos, const CompactRoad& road) noexcept {
+    return pos.x >= road.GetMinX() && pos.x <= road.GetMaxX() && pos.y >= road.GetMinY() && pos.y <= road.GetMaxY();
+}
+
 class Dog {
 public:
     using Id = util::Tagged<std::uint32_t, Dog>;
@@ -222,10 +351,10 @@ public:
     void SetDirection(Direction dir);
     void SetCurrentRoadsIndex(std::size_t index);
 
-    void SetPositionWhenMovingWest(const Map::Roads& roads, int delta);
-    void SetPositionWhenMovinggEast(const Map::Roads& roads, int delta);
-    void SetPositionWhenMovingNorth(const Map::Roads& roads, int delta);
-    void SetPositionWhenMovingSouth(const Map::Roads& roads, int delta);
+    void SetPositionWhenMovingWest(const Map& map, int delta);
+    void SetPositionWhenMovinggEast(const Map& map, int delta);
+    void SetPositionWhenMovingNorth(const Map& map, int delta);
+    void SetPositionWhenMovingSouth(const Map& map, int delta);
 
     std::size_t GetBagCapacity() const noexcept;
     const BagContent& GetBagContent() const noexcept;
@@ -255,38 +384,69 @@ private:
 
 struct GameState;
 
-std::size_t GetRandomIndex(std::size_t count);
+std::size_t GetRandomIndex(std::size_t count, util::RandomEngine& engine);
+
+geom::Point2D GetRandomPosition(const Road& road, util::RandomEngine& engine);
 
-geom::Point2D GetRandomPosition(const Road& road);
+unsigned int GetRandomType(unsigned int loot_types_count, util::RandomEngine& engine);
+
+// Phases of GameSession::UpdateGameState in the order of execution
+enum class TickPhase {
+    UPDATE_DOGS,
+    UPDATE_LOST_OBJECTS,
+    GATHER_EVENTS,
+    RETURN_TO_BASE_EVENTS
+};
 
-unsigned int GetRandomType(unsigned int loot_types_count);
+inline constexpr std::size_t TICK_PHASE_COUNT = static_cast<std::size_t>(TickPhase::RETURN_TO_BASE_EVENTS) + 1;
+
+std::string_view GetTickPhaseName(TickPhase phase) noexcept;
 
 class GameSession {
 public:
+    using Id = util::Tagged<std::uint32_t, GameSession>;
     using DogPtr = std::shared_ptr<Dog>;
     using Dogs = std::vector<DogPtr>;
     using GameStateList = std::map<std::uint32_t, GameState>;
     using Gatherers = std::vector<collision_detector::Gatherer>;
     using Items = std::vector<collision_detector::Item>;
     using Bases = std::vector<collision_detector::Item>;
+    using TickPhaseStats = std::array<util::PhaseStats, TICK_PHASE_COUNT>;
+
+    using MapPtr = std::shared_ptr<const Map>;
+
+    explicit GameSession(MapPtr map);
+
+    GameSession(Id id, MapPtr map);
 
-    explicit GameSession(const Map& map) noexcept;
+    GameSession(Id id, MapPtr map, std::uint64_t seed);
 
     DogPtr AddDog(const std::string& name, const geom::Point2D& pos, std::size_t index);
 
+    const Id& GetId() const noexcept;
     const Map* GetMap() const noexcept;
+    const Map::LootPtr& GetLoot() const noexcept;
+    util::RandomEngine& GetRandomEngine() noexcept;
+    const util::RandomEngine& GetRandomEngine() const noexcept;
     const Dogs& GetDogs() const noexcept;
     const GameStateList& GetGameStateList() const noexcept;
     const Items& GetItems() const noexcept;
+    const TickPhaseStats& GetTickPhaseStats() const noexcept;
 
     void SetNextId(std::uint32_t next_id);
     void SetDogs(const Dogs& dogs);
     void SetItems(const Items& items);
 
-    void UpdateGameState(int delta);
+    // Phases are timed into the session stats, and into the trace if it is given
+    void UpdateGameState(int delta, util::TraceRecorder* trace = nullptr);
 
 private:
-    const Map* map_;
+    Id id_;
+    // The session keeps the version of the map it was created on, even after the game's maps are reloaded
+    MapPtr map_;
+    // Each session spawns and tracks lost objects on its own copy of the map's loot settings
+    Map::LootPtr loot_;
+    util::RandomEngine random_engine_;
     std::uint32_t next_id_{0u};
     Dogs dogs_;
 
@@ -294,12 +454,13 @@ private:
     Gatherers gatherers_;
     Items items_;
     Bases bases_;
+    TickPhaseStats tick_phase_stats_;
 
     void SetLocationDogs(const DogPtr& dog_ptr, int delta);
 
     void UpdateDogs(int delta);
 
-    void UpdateLostObjects();
+    void UpdateLostObjects(int delta);
 
     void ProcessGatherEvents();
 
@@ -314,27 +475,68 @@ struct GameState {
 
 class Game {
 public:
-    using Maps = std::vector<Map>;
+    using MapPtr = std::shared_ptr<const Map>;
+    using Maps = std::vector<MapPtr>;
     using GameSessionPtr = std::shared_ptr<GameSession>;
     using GameSessions = std::vector<GameSessionPtr>;
 
+    Game() = default;
+    // A copy would share the sessions with the original, so the game is only moved
+    Game(const Game&) = delete;
+    Game& operator=(const Game&) = delete;
+    Game(Game&&) = default;
+    Game& operator=(Game&&) = default;
+
     void AddMap(Map map);
 
-    void AddGameSession(const model::Map* map);
+    // Swaps in a new version of all maps at once. Existing sessions go on with the maps they were created on,
+    // players join only sessions on the new maps, and maps missing from the new set can't be joined anymore
+    void ReplaceMaps(Maps maps);
+
+    GameSessionPtr AddGameSession(MapPtr map);
+
+    GameSessionPtr AddGameSession(MapPtr map, GameSession::Id id);
+
+    // Makes random events in new sessions reproducible: each session derives its seed from this one and its id
+    void SetRandomSeed(std::uint64_t seed) noexcept;
 
     const Maps& GetMaps() const noexcept;
+    // Starts at 0 and grows by one with each ReplaceMaps
+    std::uint32_t GetMapsVersion() const noexcept;
     const GameSessions& GetGameSessions() const noexcept;
 
-    const Map* FindMap(const Map::Id& id) const noexcept;
+    MapPtr FindMap(const Map::Id& id) const noexcept;
+    // Returns the oldest session on the current version of the map
     GameSessionPtr FindGameSession(const Map::Id& id) const noexcept;
+    GameSessionPtr FindGameSession(const GameSession::Id& id) const noexcept;
+
+    // Limits the number of dogs in one session, 0 means no limit. Sessions found full are not looked at again,
+    // so the limit is set before players join
+    void SetMaxSessionDogs(std::size_t max_dogs) noexcept;
+
+    // Returns the newest session on the current version of the map that has room for one more dog
+    GameSessionPtr FindVacantGameSession(const Map::Id& id);
 
 private:
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
+    using SessionIdHasher = util::TaggedHasher<GameSession::Id>;
+    using SessionIdToIndex = std::unordered_map<GameSession::Id, size_t, SessionIdHasher>;
+    using MapIdToSessionIndices = std::unordered_map<Map::Id, std::vector<size_t>, MapIdHasher>;
+
+    static void RemoveSessionIndex(MapIdToSessionIndices& indices, const Map::Id& map_id, size_t index) noexcept;
 
     Maps maps_;
     MapIdToIndex map_id_to_index_;
+    std::uint32_t maps_version_{0u};
     GameSessions sessions_;
+    SessionIdToIndex session_id_to_index_;
+    MapIdToSessionIndices map_id_to_session_indices_;
+    // Sessions on the current maps that had room when they were last looked at, the newest is the last
+    MapIdToSessionIndices map_id_to_vacant_session_indices_;
+    std::size_t max_session_dogs_{0u};
+    std::uint32_t next_session_id_{0u};
+    std::optional<std::uint64_t> random_seed_;
 };
 
 }  // namespace model
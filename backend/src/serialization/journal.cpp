@@ -0,0 +1,138 @@
+#include "journal.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <stdexcept>
+
+#include "../app/app.h"
+
+namespace serialization {
+
+namespace fs = std::filesystem;
+
+Journal::Journal(std::string path, const app::InputLogHeader& header, std::uint64_t segment)
+    : path_{std::move(path)}
+    , header_{header}
+    , segment_{segment} {
+    Open();
+}
+
+std::uint64_t Journal::GetSegment() const noexcept {
+    return segment_;
+}
+
+app::InputLogWriter& Journal::GetWriter() noexcept {
+    return *writer_;
+}
+
+std::uint64_t Journal::Rotate() {
+    writer_.reset();
+    file_.close();
+    ++segment_;
+    Open();
+    return segment_;
+}
+
+void Journal::Flush() {
+    writer_->Flush();
+}
+
+void Journal::Open() {
+    const auto segment_path = GetJournalSegmentPath(path_, segment_);
+    file_.open(segment_path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        throw std::runtime_error("Failed to open journal segment: " + segment_path);
+    }
+    writer_.emplace(file_, header_);
+}
+
+std::string GetJournalSegmentPath(const std::string& path, std::uint64_t segment) {
+    return path + "." + std::to_string(segment);
+}
+
+std::vector<std::uint64_t> FindJournalSegments(const std::string& path) {
+    const fs::path journal_path{path};
+    const auto directory = journal_path.has_parent_path() ? journal_path.parent_path() : fs::path{"."};
+    const auto prefix = journal_path.filename().string() + ".";
+
+    std::vector<std::uint64_t> segments;
+    if (!fs::is_directory(directory)) {
+        return segments;
+    }
+    for (const auto& entry : fs::directory_iterator{directory}) {
+        const auto name = entry.path().filename().string();
+        if (!entry.is_regular_file() || !name.starts_with(prefix)) {
+            continue;
+        }
+        const auto* begin = name.data() + prefix.size();
+        const auto* end = name.data() + name.size();
+        std::uint64_t segment = 0;
+        if (auto [ptr, ec] = std::from_chars(begin, end, segment); ec == std::errc{} && ptr == end && begin != end) {
+            segments.push_back(segment);
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+void RemoveJournalSegments(const std::string& path, std::uint64_t before) {
+    for (const auto segment : FindJournalSegments(path)) {
+        if (segment >= before) {
+            break;
+        }
+        std::error_code ec;
+        fs::remove(GetJournalSegmentPath(path, segment), ec);
+    }
+}
+
+namespace {
+
+void CheckSegmentSettings(const app::InputLogHeader& header, const app::InputLogHeader& settings, const std::string& segment_path) {
+    if (header.fixed_time_step != settings.fixed_time_step) {
+        throw std::runtime_error("Journal segment " + segment_path + " was recorded with fixed time step "
+                                 + std::to_string(header.fixed_time_step));
+    }
+    if (header.max_session_players != settings.max_session_players) {
+        throw std::runtime_error("Journal segment " + segment_path + " was recorded with at most "
+                                 + std::to_string(header.max_session_players) + " players per session");
+    }
+    if (header.random_positions != settings.random_positions) {
+        throw std::runtime_error("Journal segment " + segment_path + " was recorded with "
+                                 + (header.random_positions ? "random" : "fixed") + " spawn positions");
+    }
+}
+
+}  // namespace
+
+std::size_t ReplayJournal(const std::string& path, std::uint64_t first_segment, app::Application& app,
+                          const app::InputLogHeader& settings) {
+    const auto segments = FindJournalSegments(path);
+    std::size_t replayed = 0;
+    for (std::size_t i = 0; i != segments.size(); ++i) {
+        if (segments[i] < first_segment) {
+            continue;
+        }
+        const auto segment_path = GetJournalSegmentPath(path, segments[i]);
+        std::ifstream file{segment_path, std::ios::binary};
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open journal segment: " + segment_path);
+        }
+        try {
+            app::InputLogReader reader{file};
+            CheckSegmentSettings(reader.GetHeader(), settings, segment_path);
+            // Sessions created by the replayed joins get the same seeds as they had on the server
+            app.GetGame()->SetRandomSeed(reader.GetHeader().random_seed);
+            reader.Replay(app, true);
+        } catch (const app::InputLogTruncatedError&) {
+            // The server may have stopped in the middle of a record of the segment it was writing
+            if (i + 1 != segments.size()) {
+                throw;
+            }
+        }
+        ++replayed;
+    }
+    return replayed;
+}
+
+}  // namespace serialization
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../app/input_log.h"
+
+namespace serialization {
+
+// Append-only journal of joins, actions and ticks recorded between state snapshots.
+// It is a sequence of segment files "<path>.<number>" in the input log format, the next segment
+// is started when a snapshot is captured, so a snapshot and the segments after it restore the
+// latest state. Lost objects, pickups and deliveries are not recorded: sessions are deterministic,
+// so they are repeated by replaying the ticks on the restored state
+class Journal {
+public:
+    // Starts writing the given segment, the file is truncated if it exists
+    Journal(std::string path, const app::InputLogHeader& header, std::uint64_t segment);
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    std::uint64_t GetSegment() const noexcept;
+
+    // The writer is replaced when the journal is rotated
+    app::InputLogWriter& GetWriter() noexcept;
+
+    // Finishes the current segment and starts the next one, returns its number
+    std::uint64_t Rotate();
+
+    void Flush();
+
+private:
+    std::string path_;
+    app::InputLogHeader header_;
+    std::uint64_t segment_;
+    std::ofstream file_;
+    std::optional<app::InputLogWriter> writer_;
+
+    void Open();
+};
+
+std::string GetJournalSegmentPath(const std::string& path, std::uint64_t segment);
+
+// Numbers of the journal segments that exist on disk, in ascending order
+std::vector<std::uint64_t> FindJournalSegments(const std::string& path);
+
+// Removes the segments preceding the given one, they are covered by a written snapshot
+void RemoveJournalSegments(const std::string& path, std::uint64_t before);
+
+// Replays the segments starting from the given one on the restored state, players keep their tokens.
+// The last segment may end with a partially written record, which is ignored; any other damage throws.
+// Segments must have been recorded with the fixed time step, the session size and the spawn mode of the header,
+// otherwise the replay would diverge from the recorded run and std::runtime_error is thrown.
+// Returns the number of replayed segments
+std::size_t ReplayJournal(const std::string& path, std::uint64_t first_segment, app::Application& app,
+                          const app::InputLogHeader& settings);
+
+}  // namespace serialization
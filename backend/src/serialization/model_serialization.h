@@ -1,14 +1,23 @@
+#pragma once
+
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/unordered_map.hpp>
+#include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 
 #include "../app/app.h"
 #include "../model/model.h"
 #include "../detector/collision_detector.h"
+#include "../util/parallel_for.h"
 
 namespace geom {
 
@@ -143,6 +152,8 @@ public:
         for (const auto& object_ptr : loot->GetLostObjects()) {
             objects_.emplace_back(LostObjectRepr(*object_ptr));
         }
+        next_id_ = loot->GetNextId();
+        time_without_loot_ = loot->GetTimeWithoutLoot().count();
     }
 
     void Restore(const model::Map::LootPtr& loot) const {
@@ -153,32 +164,32 @@ public:
         }
         loot->SetLostObjects(objects);
         loot->SetNextId(next_id_);
-        loot->SetLootCount(loot_count_);
+        loot->SetTimeWithoutLoot(loot_gen::LootGenerator::TimeInterval{time_without_loot_});
     }
 
     template <typename Archive>
     void serialize(Archive& ar, [[maybe_unused]] const unsigned int version) {
-        ar& loot_count_;
         ar& next_id_;
         ar& objects_;
+        ar& time_without_loot_;
     }
 
 private:
-    unsigned int loot_count_ = 0u;
     std::uint32_t next_id_ = 0u;
     std::vector<LostObjectRepr> objects_;
+    std::int64_t time_without_loot_ = 0;
 };
 
 class MapRepr {
 public:
     MapRepr() = default;
 
-    explicit MapRepr(const model::Map& map)
-        : loot_(map.GetLoot()) {
+    explicit MapRepr(const model::Map::LootPtr& loot)
+        : loot_(loot) {
     }
 
-    void Restore(const model::Map* map) const {
-        loot_.Restore(map->GetLoot());
+    void Restore(const model::Map::LootPtr& loot) const {
+        loot_.Restore(loot);
     }
 
     template <typename Archive>
@@ -195,8 +206,9 @@ class GameSessionRepr {
 public:
     GameSessionRepr() = default;
 
-    explicit GameSessionRepr(const model::Game::GameSessionPtr& session) {
-        map_ = MapRepr(*(session->GetMap()));
+    explicit GameSessionRepr(const model::Game::GameSessionPtr& session)
+        : id_(*session->GetId()) {
+        map_ = MapRepr(session->GetLoot());
         next_id_ = *(session->GetDogs().back()->GetId());
         ++next_id_;
 
@@ -207,10 +219,17 @@ public:
         for (const auto& item : session->GetItems()) {
             items_.emplace_back(item);
         }
+
+        const auto& state = session->GetRandomEngine().GetState();
+        random_state_.assign(state.begin(), state.end());
+    }
+
+    std::uint32_t GetId() const noexcept {
+        return id_;
     }
 
     void Restore(const model::Game::GameSessionPtr& session) const {
-        map_.Restore(session->GetMap());
+        map_.Restore(session->GetLoot());
         session->SetNextId(next_id_);
 
         model::GameSession::Dogs dogs;
@@ -226,21 +245,30 @@ public:
             items.emplace_back(item);
         }
         session->SetItems(items);
+
+        if (util::RandomEngine::State state; random_state_.size() == state.size()) {
+            std::copy(random_state_.begin(), random_state_.end(), state.begin());
+            session->GetRandomEngine().SetState(state);
+        }
     }
 
     template <typename Archive>
     void serialize(Archive& ar, [[maybe_unused]] const unsigned int version) {
+        ar& id_;
         ar& map_;
         ar& next_id_;
         ar& dogs_;
         ar& items_;
+        ar& random_state_;
     }
 
 private:
+    std::uint32_t id_ = 0u;
     MapRepr map_;
     std::uint32_t next_id_ = 0u;
     std::vector<DogRepr> dogs_;
     std::vector<collision_detector::Item> items_;
+    std::vector<std::uint64_t> random_state_;
 };
 
 class GameRepr {
@@ -248,23 +276,41 @@ public:
     GameRepr() = default;
 
     explicit GameRepr(const std::unique_ptr<model::Game>& game) {
-        for (const auto& map : game->GetMaps()) {
-            if (auto session_ptr = game->FindGameSession(map.GetId()); session_ptr) {
-                id_maps_.emplace_back(*(map.GetId()));
-                sessions_.emplace_back(GameSessionRepr(session_ptr));
-            }
+        for (const auto& session_ptr : game->GetGameSessions()) {
+            id_maps_.emplace_back(*(session_ptr->GetMap()->GetId()));
+            sessions_.emplace_back(GameSessionRepr(session_ptr));
         }
     }
 
+    const std::vector<std::string>& GetMapIds() const noexcept {
+        return id_maps_;
+    }
+
+    const std::vector<GameSessionRepr>& GetSessions() const noexcept {
+        return sessions_;
+    }
+
     void Restore(const std::unique_ptr<model::Game>& game) const {
-        for (const auto& map_id : id_maps_) {
-            if (const auto map_ptr = game->FindMap(model::Map::Id{map_id}); map_ptr) {
-                game->AddGameSession(map_ptr);
-                for (const auto& session_repr : sessions_) {
-                    session_repr.Restore(game->GetGameSessions().back());
-                }
+        RestoreSessions(game, id_maps_, sessions_);
+    }
+
+    // Sessions keep their ids, because players and tokens refer to them, and their order.
+    // They are added to the game one by one, then their contents are restored in parallel,
+    // since every session owns its dogs, loot and random engine
+    static void RestoreSessions(const std::unique_ptr<model::Game>& game,
+                                const std::vector<std::string>& map_ids,
+                                const std::vector<GameSessionRepr>& session_reprs) {
+        std::vector<model::Game::GameSessionPtr> sessions(session_reprs.size());
+        for (std::size_t i = 0; i != session_reprs.size(); ++i) {
+            if (auto map_ptr = game->FindMap(model::Map::Id{map_ids.at(i)}); map_ptr) {
+                sessions[i] = game->AddGameSession(std::move(map_ptr), model::GameSession::Id{session_reprs[i].GetId()});
             }
         }
+        util::ParallelFor(sessions.size(), [&sessions, &session_reprs](std::size_t i) {
+            if (sessions[i]) {
+                session_reprs[i].Restore(sessions[i]);
+            }
+        });
     }
 
     template <typename Archive>
@@ -284,14 +330,14 @@ public:
     PlayersRepr()  = default;
 
     explicit PlayersRepr(const std::unique_ptr<app::Players>& players) {
-        for (const auto& [map_id, player_list] : players->GetMapIdToPlayerList()) {
-            map_id_to_player_list_.emplace(*map_id, player_list);
+        for (const auto& [session_id, player_list] : players->GetSessionIdToPlayerList()) {
+            session_id_to_player_list_.emplace(*session_id, player_list);
         }
     }
 
     void Restore(const std::unique_ptr<model::Game>& game, const std::unique_ptr<app::Players>& players) const {
-        for (const auto& [map_id, player_list] : map_id_to_player_list_) {
-            model::Map::Id id(map_id);
+        for (const auto& [session_id, player_list] : session_id_to_player_list_) {
+            model::GameSession::Id id(session_id);
             if (auto session_ptr = game->FindGameSession(id); session_ptr) {
                 const auto& dogs = session_ptr->GetDogs();
                 for (const auto& dog_ptr : dogs) {
@@ -305,11 +351,11 @@ public:
 
     template <typename Archive>
     void serialize(Archive& ar, [[maybe_unused]] const unsigned int version) {
-        ar& map_id_to_player_list_;
+        ar& session_id_to_player_list_;
     }
 
 private:
-    std::unordered_map<std::string, std::map<std::uint32_t, std::string>> map_id_to_player_list_;
+    std::unordered_map<std::uint32_t, std::map<std::uint32_t, std::string>> session_id_to_player_list_;
 };
 
 class PlayerTokensRepr {
@@ -318,25 +364,27 @@ public:
 
     explicit PlayerTokensRepr(const std::unique_ptr<app::PlayerTokens>& player_tokens) {
         for (const auto& [token, player_ptr] : player_tokens->GetTokenToPlayer()) {
-            token_to_player_.emplace(*token, *(player_ptr->GetDog()->GetId()));
+            token_to_player_.emplace(token.ToHex(), std::make_pair(*(player_ptr->GetGameSession()->GetId()),
+                                                                   *(player_ptr->GetDog()->GetId())));
         }
     }
 
-    void Restore(const std::unique_ptr<model::Game>& game,
+    void Restore([[maybe_unused]] const std::unique_ptr<model::Game>& game,
                  const std::unique_ptr<app::Players>& players,
-                 const std::unique_ptr<app::PlayerTokens>& player_tokens) {
-        const auto& array_of_players = players->GetAddedPlayers();
-        for (const auto& [token, player_id] : token_to_player_) {
-            if (auto it = std::find_if(
-                                        array_of_players.begin(),
-                                        array_of_players.end(),
-                                        [&player_id](const auto& player) {
-                                            return player_id == (*player.GetDog()->GetId());
-                                        }
-                                       );
-                    it != array_of_players.end()) {
-                auto player = *it;
-                player_tokens->SetTokenToPlayer(app::Token{token}, std::make_shared<app::Player>(player));
+                 const std::unique_ptr<app::PlayerTokens>& player_tokens) const {
+        // Players are joined with the tokens through (game session id, dog id)
+        std::unordered_map<std::uint64_t, app::PlayerHandle> id_to_player;
+        id_to_player.reserve(players->GetAddedPlayers().size());
+        for (const auto& player : players->GetAddedPlayers()) {
+            id_to_player.emplace(GetPlayerKey(*player.GetGameSession()->GetId(), *player.GetDog()->GetId()), &player);
+        }
+        for (const auto& [token, ids] : token_to_player_) {
+            const auto binary_token = app::Token::FromHex(token);
+            if (!binary_token) {
+                throw std::runtime_error("Failed to restore player token");
+            }
+            if (auto it = id_to_player.find(GetPlayerKey(ids.first, ids.second)); it != id_to_player.end()) {
+                player_tokens->SetTokenToPlayer(*binary_token, it->second);
             }
         }
     }
@@ -347,9 +395,18 @@ public:
     }
 
 private:
-    std::unordered_map<std::string, std::uint32_t> token_to_player_;
+    static std::uint64_t GetPlayerKey(std::uint32_t session_id, std::uint32_t dog_id) noexcept {
+        return (static_cast<std::uint64_t>(session_id) << 32) | dog_id;
+    }
+
+    // Token -> (game session id, dog id)
+    std::unordered_map<std::string, std::pair<std::uint32_t, std::uint32_t>> token_to_player_;
 };
 
+// Version of the layout of the *Repr classes in text state files. It is raised with every change of the layout,
+// files of other versions are refused instead of being misread. Files without a version have version 0
+inline constexpr unsigned int STATE_FILE_VERSION = 2;
+
 class ApplicationRepr {
 public:
     ApplicationRepr() = default;
@@ -360,6 +417,18 @@ public:
         , player_tokens_{app.GetPlayerTokens()} {
     }
 
+    const GameRepr& GetGame() const noexcept {
+        return game_;
+    }
+
+    const PlayersRepr& GetPlayers() const noexcept {
+        return players_;
+    }
+
+    const PlayerTokensRepr& GetPlayerTokens() const noexcept {
+        return player_tokens_;
+    }
+
     void Restore(app::Application& app) {
         game_.Restore(app.GetGame());
         players_.Restore(app.GetGame(), app.GetPlayers());
@@ -368,6 +437,9 @@ public:
 
     template <typename Archive>
     void serialize(Archive& ar, const unsigned int version) {
+        if (version != STATE_FILE_VERSION) {
+            throw std::runtime_error("Unsupported state file version: " + std::to_string(version));
+        }
         ar & game_;
         ar & players_;
         ar & player_tokens_;
@@ -379,4 +451,6 @@ private:
     PlayerTokensRepr player_tokens_;
 };
 
-}  // namespace serialization
\ No newline at end of file
+}  // namespace serialization
+
+BOOST_CLASS_VERSION(::serialization::ApplicationRepr, ::serialization::STATE_FILE_VERSION)
@@ -0,0 +1,259 @@
+#include "snapshot_format.h"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/crc.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/stream.hpp>
+
+namespace serialization {
+
+using namespace std::literals;
+
+namespace {
+
+namespace io = boost::iostreams;
+
+enum class SectionType : std::uint32_t {
+    GAME_SESSION = 1,
+    PLAYERS = 2,
+    PLAYER_TOKENS = 3,
+    JOURNAL_CHECKPOINT = 4
+};
+
+constexpr std::array<char, 8> MAGIC = {'G', 'S', 'N', 'A', 'P', 'S', 'H', 'T'};
+constexpr std::size_t HEADER_SIZE = MAGIC.size() + 2 * sizeof(std::uint32_t);
+// Each section has its own archive, the snapshot header carries the version instead of the archive header
+constexpr unsigned int ARCHIVE_FLAGS = boost::archive::no_header | boost::archive::no_codecvt;
+// Size of the file buffer, so the snapshot is written with large sequential writes
+constexpr std::size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+template <typename T>
+void WriteValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::uint32_t GetChecksum(std::string_view data) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+template <typename... Reprs>
+void WriteSection(std::ostream& out, std::string& buffer, SectionType type, const Reprs&... reprs) {
+    buffer.clear();
+    {
+        io::stream<io::back_insert_device<std::string>> stream{buffer};
+        boost::archive::binary_oarchive ar{stream, ARCHIVE_FLAGS};
+        (ar << ... << reprs);
+    }
+    WriteValue(out, static_cast<std::uint32_t>(type));
+    WriteValue(out, GetChecksum(buffer));
+    WriteValue(out, static_cast<std::uint64_t>(buffer.size()));
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+struct Section {
+    std::uint32_t index = 0;
+    SectionType type = SectionType::GAME_SESSION;
+    std::uint32_t checksum = 0;
+    std::string_view payload;
+};
+
+void CheckSection(const Section& section) {
+    if (GetChecksum(section.payload) != section.checksum) {
+        throw std::runtime_error("Snapshot section " + std::to_string(section.index) + " is damaged");
+    }
+}
+
+template <typename... Reprs>
+void ReadSection(const Section& section, Reprs&... reprs) {
+    CheckSection(section);
+    io::stream<io::array_source> stream{section.payload.data(), section.payload.size()};
+    boost::archive::binary_iarchive ar{stream, ARCHIVE_FLAGS};
+    (ar >> ... >> reprs);
+}
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::string_view data)
+        : data_{data} {
+    }
+
+    template <typename T>
+    T ReadValue() {
+        T value;
+        std::memcpy(&value, ReadBytes(sizeof(value)).data(), sizeof(value));
+        return value;
+    }
+
+    std::string_view ReadBytes(std::size_t size) {
+        if (data_.size() - position_ < size) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        auto bytes = data_.substr(position_, size);
+        position_ += size;
+        return bytes;
+    }
+
+private:
+    std::string_view data_;
+    std::size_t position_ = 0;
+};
+
+}  // namespace
+
+SnapshotFormat ParseSnapshotFormat(std::string_view name) {
+    if (name == "text"sv) {
+        return SnapshotFormat::TEXT;
+    }
+    if (name == "binary"sv) {
+        return SnapshotFormat::BINARY;
+    }
+    throw std::invalid_argument("Unknown state file format: " + std::string{name});
+}
+
+void WriteBinarySnapshot(const ApplicationRepr& snapshot, std::ostream& out,
+                         const std::optional<JournalCheckpoint>& checkpoint) {
+    const auto& game = snapshot.GetGame();
+    const auto& map_ids = game.GetMapIds();
+    const auto& sessions = game.GetSessions();
+
+    out.write(MAGIC.data(), MAGIC.size());
+    WriteValue(out, BINARY_SNAPSHOT_VERSION);
+    WriteValue(out, static_cast<std::uint32_t>(sessions.size() + (checkpoint ? 3 : 2)));
+
+    // The buffer is reused by all sections, so it grows to the size of the largest one only once
+    std::string buffer;
+    for (std::size_t i = 0; i != sessions.size(); ++i) {
+        WriteSection(out, buffer, SectionType::GAME_SESSION, map_ids.at(i), sessions[i]);
+    }
+    WriteSection(out, buffer, SectionType::PLAYERS, snapshot.GetPlayers());
+    WriteSection(out, buffer, SectionType::PLAYER_TOKENS, snapshot.GetPlayerTokens());
+    if (checkpoint) {
+        WriteSection(out, buffer, SectionType::JOURNAL_CHECKPOINT, checkpoint->segment, checkpoint->pending_time);
+    }
+}
+
+bool IsBinarySnapshot(std::string_view data) noexcept {
+    return data.size() >= MAGIC.size() && data.substr(0, MAGIC.size()) == std::string_view{MAGIC.data(), MAGIC.size()};
+}
+
+std::optional<JournalCheckpoint> ReadBinarySnapshot(std::string_view data, app::Application& app) {
+    if (!IsBinarySnapshot(data) || data.size() < HEADER_SIZE) {
+        throw std::runtime_error("Not a binary snapshot");
+    }
+    SnapshotReader reader{data.substr(MAGIC.size())};
+    if (const auto version = reader.ReadValue<std::uint32_t>(); version != BINARY_SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version: " + std::to_string(version));
+    }
+    const auto section_count = reader.ReadValue<std::uint32_t>();
+    std::vector<Section> sections;
+    std::vector<std::size_t> session_sections;
+    for (std::uint32_t i = 0; i != section_count; ++i) {
+        auto& section = sections.emplace_back();
+        section.index = i;
+        section.type = static_cast<SectionType>(reader.ReadValue<std::uint32_t>());
+        section.checksum = reader.ReadValue<std::uint32_t>();
+        section.payload = reader.ReadBytes(static_cast<std::size_t>(reader.ReadValue<std::uint64_t>()));
+        if (section.type == SectionType::GAME_SESSION) {
+            session_sections.push_back(i);
+        }
+    }
+
+    // Every section is checked and decoded before anything is restored, so a damaged file leaves the application as it was.
+    // Sessions are independent, so they are decoded in parallel
+    std::vector<std::string> map_ids(session_sections.size());
+    std::vector<GameSessionRepr> sessions(session_sections.size());
+    util::ParallelFor(session_sections.size(), [&](std::size_t i) {
+        ReadSection(sections[session_sections[i]], map_ids[i], sessions[i]);
+    });
+    std::optional<PlayersRepr> players;
+    std::optional<PlayerTokensRepr> player_tokens;
+    std::optional<JournalCheckpoint> checkpoint;
+    for (const auto& section : sections) {
+        switch (section.type) {
+            case SectionType::GAME_SESSION:
+                break;
+            case SectionType::PLAYERS:
+                ReadSection(section, players.emplace());
+                break;
+            case SectionType::PLAYER_TOKENS:
+                ReadSection(section, player_tokens.emplace());
+                break;
+            case SectionType::JOURNAL_CHECKPOINT:
+                checkpoint.emplace();
+                ReadSection(section, checkpoint->segment, checkpoint->pending_time);
+                break;
+            default:
+                CheckSection(section);
+        }
+    }
+    if (!players || !player_tokens) {
+        throw std::runtime_error("Snapshot has no players");
+    }
+
+    GameRepr::RestoreSessions(app.GetGame(), map_ids, sessions);
+    players->Restore(app.GetGame(), app.GetPlayers());
+    player_tokens->Restore(app.GetGame(), app.GetPlayers(), app.GetPlayerTokens());
+    return checkpoint;
+}
+
+void SaveSnapshot(const ApplicationRepr& snapshot, const std::string& filename, SnapshotFormat format,
+                  const std::optional<JournalCheckpoint>& checkpoint) {
+    std::string temp_filename = filename + "_tmp";
+    {
+        std::vector<char> buffer(WRITE_BUFFER_SIZE);
+        std::ofstream file;
+        file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.open(temp_filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Unable to open temporary file for writing");
+        }
+        if (format == SnapshotFormat::BINARY) {
+            WriteBinarySnapshot(snapshot, file, checkpoint);
+        } else {
+            boost::archive::text_oarchive ar(file);
+            ar << snapshot;
+        }
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Failed to write state to " + temp_filename);
+        }
+    }
+    std::filesystem::rename(temp_filename, filename);
+}
+
+std::optional<JournalCheckpoint> LoadSnapshot(app::Application& app, const std::string& filename) {
+    if (std::filesystem::file_size(filename) == 0) {
+        throw std::runtime_error("State file is empty: " + filename);
+    }
+    io::mapped_file_source file;
+    try {
+        file.open(filename);
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+    const std::string_view data{file.data(), file.size()};
+    if (IsBinarySnapshot(data)) {
+        return ReadBinarySnapshot(data, app);
+    }
+    // State files written before the binary format are text archives
+    io::stream<io::array_source> stream{data.data(), data.size()};
+    boost::archive::text_iarchive ar{stream};
+    ApplicationRepr repr;
+    ar >> repr;
+    repr.Restore(app);
+    return std::nullopt;
+}
+
+}  // namespace serialization
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "model_serialization.h"
+
+namespace serialization {
+
+enum class SnapshotFormat {
+    TEXT,
+    BINARY
+};
+
+// Accepts "text" and "binary"
+SnapshotFormat ParseSnapshotFormat(std::string_view name);
+
+// Where the journal continues the snapshot. Only binary snapshots keep it
+struct JournalCheckpoint {
+    // Number of the first journal segment recorded after the snapshot has been captured
+    std::uint64_t segment = 0;
+    // Milliseconds of ticks that were not simulated yet in the fixed time step mode
+    std::int64_t pending_time = 0;
+};
+
+// Binary snapshot layout, integers are in the byte order of the machine that has written the file:
+//   header:  magic "GSNAPSHT", u32 format version, u32 number of sections
+//   section: u32 section type, u32 CRC-32 of the payload, u64 payload size, payload
+// There is a section per game session, followed by the players, the player tokens and the journal checkpoint.
+// Payloads are Boost binary archives of the *Repr classes, sections of unknown types are skipped
+inline constexpr std::uint32_t BINARY_SNAPSHOT_VERSION = 2;
+
+void WriteBinarySnapshot(const ApplicationRepr& snapshot, std::ostream& out,
+                         const std::optional<JournalCheckpoint>& checkpoint = std::nullopt);
+
+bool IsBinarySnapshot(std::string_view data) noexcept;
+
+// Sessions are decoded and restored in parallel, then the players and the tokens are joined to them.
+// Throws std::runtime_error if the data is truncated, damaged or has an unsupported version
+std::optional<JournalCheckpoint> ReadBinarySnapshot(std::string_view data, app::Application& app);
+
+// Writes the snapshot to a temporary file and renames it, so the file always holds a complete state
+void SaveSnapshot(const ApplicationRepr& snapshot, const std::string& filename, SnapshotFormat format,
+                  const std::optional<JournalCheckpoint>& checkpoint = std::nullopt);
+
+// Maps the file into memory and restores the state from it, the format is detected from the contents
+std::optional<JournalCheckpoint> LoadSnapshot(app::Application& app, const std::string& filename);
+
+}  // namespace serialization
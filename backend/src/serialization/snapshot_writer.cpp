@@ -0,0 +1,81 @@
+#include "snapshot_writer.h"
+
+namespace serialization {
+
+SnapshotWriter::SnapshotWriter(std::string filename, SnapshotFormat format, ErrorHandler error_handler,
+                               WrittenHandler written_handler)
+    : filename_{std::move(filename)}
+    , format_{format}
+    , error_handler_{std::move(error_handler)}
+    , written_handler_{std::move(written_handler)} {
+    thread_ = std::thread{[this] {
+        Run();
+    }};
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard lock{mutex_};
+        stopped_ = true;
+    }
+    condition_.notify_all();
+    thread_.join();
+}
+
+void SnapshotWriter::Submit(ApplicationRepr snapshot, std::optional<JournalCheckpoint> checkpoint) {
+    {
+        std::lock_guard lock{mutex_};
+        pending_.emplace(std::move(snapshot), checkpoint);
+    }
+    condition_.notify_all();
+}
+
+void SnapshotWriter::Flush() {
+    std::unique_lock lock{mutex_};
+    condition_.wait(lock, [this] {
+        return !pending_ && !writing_;
+    });
+}
+
+std::uint64_t SnapshotWriter::GetWrittenCount() const {
+    std::lock_guard lock{mutex_};
+    return written_count_;
+}
+
+void SnapshotWriter::Run() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+        condition_.wait(lock, [this] {
+            return pending_ || stopped_;
+        });
+        if (!pending_) {
+            return;
+        }
+        auto [snapshot, checkpoint] = std::move(*pending_);
+        pending_.reset();
+        writing_ = true;
+        lock.unlock();
+
+        bool written = true;
+        try {
+            SaveSnapshot(snapshot, filename_, format_, checkpoint);
+            if (written_handler_) {
+                written_handler_(checkpoint);
+            }
+        } catch (const std::exception& e) {
+            written = false;
+            if (error_handler_) {
+                error_handler_(e);
+            }
+        }
+
+        lock.lock();
+        writing_ = false;
+        if (written) {
+            ++written_count_;
+        }
+        condition_.notify_all();
+    }
+}
+
+}  // namespace serialization
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "snapshot_format.h"
+
+namespace serialization {
+
+// Writes state snapshots from a background thread. A snapshot is captured into ApplicationRepr
+// at a tick boundary, which is a plain copy of the state, and the slow part - serialization
+// and file output - runs while the game keeps ticking
+class SnapshotWriter {
+public:
+    using ErrorHandler = std::function<void(const std::exception& e)>;
+    // Called from the writer thread after the snapshot has been written, e.g. to drop the journal it covers
+    using WrittenHandler = std::function<void(const std::optional<JournalCheckpoint>& checkpoint)>;
+
+    SnapshotWriter(std::string filename, SnapshotFormat format, ErrorHandler error_handler,
+                   WrittenHandler written_handler = {});
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Writes the pending snapshot before the thread is stopped
+    ~SnapshotWriter();
+
+    // A snapshot that has not been taken by the writer yet is replaced, since only the latest state matters
+    void Submit(ApplicationRepr snapshot, std::optional<JournalCheckpoint> checkpoint = std::nullopt);
+
+    // Blocks until all submitted snapshots are written
+    void Flush();
+
+    std::uint64_t GetWrittenCount() const;
+
+private:
+    std::string filename_;
+    SnapshotFormat format_;
+    ErrorHandler error_handler_;
+    WrittenHandler written_handler_;
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::optional<std::pair<ApplicationRepr, std::optional<JournalCheckpoint>>> pending_;
+    bool writing_ = false;
+    bool stopped_ = false;
+    std::uint64_t written_count_ = 0;
+    std::thread thread_;
+
+    void Run();
+};
+
+}  // namespace serialization
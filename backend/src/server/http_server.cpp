@@ -6,9 +6,80 @@
 
 namespace http_server {
 
-SessionBase::SessionBase(tcp::socket&& socket, std::function<void(const json::object&)> data_collection)
+namespace {
+
+std::int64_t ToMicroseconds(RequestTiming::Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+}  // namespace
+
+RequestTiming::RequestTiming(std::string target)
+    : target_(std::move(target))
+    , received_(Clock::now())
+    , handler_started_(received_)
+    , response_ready_(received_)
+    , written_(received_) {
+}
+
+void RequestTiming::MarkHandlerStarted() noexcept {
+    handler_started_ = Clock::now();
+}
+
+void RequestTiming::MarkResponseReady(unsigned status, std::string content_type) {
+    status_ = status;
+    content_type_ = std::move(content_type);
+    response_ready_ = Clock::now();
+}
+
+void RequestTiming::MarkWritten() noexcept {
+    written_ = Clock::now();
+}
+
+const std::string& RequestTiming::GetTarget() const noexcept {
+    return target_;
+}
+
+unsigned RequestTiming::GetStatus() const noexcept {
+    return status_;
+}
+
+const std::string& RequestTiming::GetContentType() const noexcept {
+    return content_type_;
+}
+
+RequestTiming::Clock::duration RequestTiming::GetQueueTime() const noexcept {
+    return handler_started_ - received_;
+}
+
+RequestTiming::Clock::duration RequestTiming::GetHandlerTime() const noexcept {
+    return response_ready_ - handler_started_;
+}
+
+RequestTiming::Clock::duration RequestTiming::GetWriteTime() const noexcept {
+    return written_ - response_ready_;
+}
+
+RequestTiming::Clock::duration RequestTiming::GetTotalTime() const noexcept {
+    return written_ - received_;
+}
+
+SessionBase::SessionBase(tcp::socket&& socket, DataCollection data_collection, RecordSampler record_sampler,
+                         ConnectionObserver connection_observer, RequestObserver request_observer)
     : stream_(std::move(socket))
-    , data_collection_(data_collection) {
+    , data_collection_(std::move(data_collection))
+    , record_sampler_(std::move(record_sampler))
+    , connection_observer_(std::move(connection_observer))
+    , request_observer_(std::move(request_observer)) {
+    if (connection_observer_) {
+        connection_observer_(1);
+    }
+}
+
+SessionBase::~SessionBase() {
+    if (connection_observer_) {
+        connection_observer_(-1);
+    }
 }
 
 void SessionBase::Run() {
@@ -29,6 +100,18 @@ void SessionBase::Read() {
                      beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis()));
 }
 
+bool SessionBase::IsRecordSampled() const {
+    return !record_sampler_ || record_sampler_();
+}
+
+void SessionBase::CollectError(const beast::error_code& ec, std::string_view where) {
+    json::object custom_data;
+    custom_data.emplace("code", std::to_string(ec.value()));
+    custom_data.emplace("text", ec.message());
+    custom_data.emplace("where", where);
+    data_collection_(std::move(custom_data));
+}
+
 void SessionBase::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
     using namespace std::literals;
     if (ec == http::error::end_of_stream) {
@@ -36,45 +119,53 @@ void SessionBase::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t byte
         return Close();
     }
     if (ec) {
-        json::object custom_data;
-        custom_data.emplace("code", std::to_string(ec.value()));
-        custom_data.emplace("text", ec.message());
-        custom_data.emplace("where", "read");
-        data_collection_(custom_data);
+        CollectError(ec, "read"sv);
 
         return;
     }
 
-    json::object custom_data;
-    custom_data.emplace("ip", stream_.socket().remote_endpoint().address().to_string());
-    custom_data.emplace("URI", std::string{request_.target()});
-    custom_data.emplace("method", std::string{request_.method_string()});
-    data_collection_(custom_data);
+    timing_ = std::make_shared<RequestTiming>(std::string{request_.target()});
+
+    if (IsRecordSampled()) {
+        json::object custom_data;
+        custom_data.emplace("ip", stream_.socket().remote_endpoint().address().to_string());
+        custom_data.emplace("URI", std::string{request_.target()});
+        custom_data.emplace("method", std::string{request_.method_string()});
+        data_collection_(std::move(custom_data));
+    }
 
-    HandleRequest(std::move(request_));
+    HandleRequest(std::move(request_), timing_);
 }
 
 void SessionBase::Close() {
     beast::error_code ec;
     stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
     if (ec) {
-        json::object custom_data;
-        custom_data.emplace("code", std::to_string(ec.value()));
-        custom_data.emplace("text", ec.message());
-        custom_data.emplace("where", "close");
-        data_collection_(custom_data);
+        CollectError(ec, "close"sv);
 
         return;
     }
 }
 
 void SessionBase::OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+    if (auto timing = std::move(timing_)) {
+        timing->MarkWritten();
+        if (!ec && IsRecordSampled()) {
+            json::object custom_data;
+            custom_data.emplace("response_time", ToMicroseconds(timing->GetTotalTime()));
+            custom_data.emplace("queue_time", ToMicroseconds(timing->GetQueueTime()));
+            custom_data.emplace("handler_time", ToMicroseconds(timing->GetHandlerTime()));
+            custom_data.emplace("write_time", ToMicroseconds(timing->GetWriteTime()));
+            custom_data.emplace("code", timing->GetStatus());
+            custom_data.emplace("content_type", timing->GetContentType());
+            data_collection_(std::move(custom_data));
+        }
+        if (request_observer_) {
+            request_observer_(*timing);
+        }
+    }
     if (ec) {
-        json::object custom_data;
-        custom_data.emplace("code", std::to_string(ec.value()));
-        custom_data.emplace("text", ec.message());
-        custom_data.emplace("where", "write");
-        data_collection_(custom_data);
+        CollectError(ec, "write"sv);
 
         return;
     }
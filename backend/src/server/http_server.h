@@ -1,7 +1,10 @@
 #pragma once
 
+#include <chrono>
 #include <iostream>
 #include <functional>
+#include <memory>
+#include <string>
 
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
@@ -19,6 +22,54 @@ namespace json = boost::json;
 using tcp = net::ip::tcp;
 using namespace std::literals;
 
+// Called with +1 when a connection is accepted and with -1 when it is destroyed
+using ConnectionObserver = std::function<void(int delta)>;
+
+// Receives the records of requests, responses and network errors
+using DataCollection = std::function<void(json::object data)>;
+
+// Called before the record of a request or a response is built, it is built and collected only if true is returned.
+// There is a record per request and response, so the ones not wanted cost nothing. Errors are always collected
+using RecordSampler = std::function<bool()>;
+
+// Timestamps of a single request, from the moment it has been read until its response has been written.
+// A session handles one request at a time, and the steps are ordered by the executors, so no locking is needed
+class RequestTiming {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RequestTiming(std::string target);
+
+    // Called by the request handler when it starts working on the request, e.g. once it runs on the API strand
+    void MarkHandlerStarted() noexcept;
+
+    void MarkResponseReady(unsigned status, std::string content_type);
+
+    void MarkWritten() noexcept;
+
+    const std::string& GetTarget() const noexcept;
+    unsigned GetStatus() const noexcept;
+    const std::string& GetContentType() const noexcept;
+
+    // Time between reading the request and the start of its handler
+    Clock::duration GetQueueTime() const noexcept;
+    Clock::duration GetHandlerTime() const noexcept;
+    Clock::duration GetWriteTime() const noexcept;
+    Clock::duration GetTotalTime() const noexcept;
+
+private:
+    std::string target_;
+    unsigned status_ = 0;
+    std::string content_type_;
+    Clock::time_point received_;
+    Clock::time_point handler_started_;
+    Clock::time_point response_ready_;
+    Clock::time_point written_;
+};
+
+// Called after the response to a request has been written
+using RequestObserver = std::function<void(const RequestTiming& timing)>;
+
 class SessionBase {
 public:
     SessionBase(const SessionBase&) = delete;
@@ -29,14 +80,18 @@ public:
 protected:
     using HttpRequest = http::request<http::string_body>;
 
-    explicit SessionBase(tcp::socket&& socket, std::function<void(const json::object&)> data_collection);
+    SessionBase(tcp::socket&& socket, DataCollection data_collection, RecordSampler record_sampler,
+                ConnectionObserver connection_observer, RequestObserver request_observer);
 
-    ~SessionBase() = default;
+    ~SessionBase();
 
     template <typename Body, typename Fields>
     void Write(http::response<Body, Fields>&& response) {
         // The write is performed asynchronously, so we move response to the heap
         auto safe_response = std::make_shared<http::response<Body, Fields>>(std::move(response));
+        if (timing_) {
+            timing_->MarkResponseReady(safe_response->result_int(), std::string{(*safe_response)[http::field::content_type]});
+        }
 
         auto self = GetSharedThis();
         http::async_write(stream_, *safe_response,
@@ -48,19 +103,27 @@ protected:
 private:
     beast::tcp_stream stream_;
     beast::flat_buffer buffer_;
-    std::function<void(const json::object&)> data_collection_;
+    DataCollection data_collection_;
+    RecordSampler record_sampler_;
+    ConnectionObserver connection_observer_;
+    RequestObserver request_observer_;
     HttpRequest request_;
+    std::shared_ptr<RequestTiming> timing_;
 
 private:
     void Read();
 
+    bool IsRecordSampled() const;
+
+    void CollectError(const beast::error_code& ec, std::string_view where);
+
     void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read);
 
     void Close();
 
     void OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written);
 
-    virtual void HandleRequest(HttpRequest&& request) = 0;
+    virtual void HandleRequest(HttpRequest&& request, std::shared_ptr<RequestTiming> timing) = 0;
 
     virtual std::shared_ptr<SessionBase> GetSharedThis() = 0;
 };
@@ -69,8 +132,10 @@ template <typename RequestHandler>
 class Session : public SessionBase, public std::enable_shared_from_this<Session<RequestHandler>> {
 public:
     template <typename Handler>
-    Session(tcp::socket&& socket, std::function<void(const json::object&)> data_collection, Handler&& request_handler)
-        : SessionBase(std::move(socket), data_collection)
+    Session(tcp::socket&& socket, DataCollection data_collection, RecordSampler record_sampler, ConnectionObserver connection_observer,
+            RequestObserver request_observer, Handler&& request_handler)
+        : SessionBase(std::move(socket), std::move(data_collection), std::move(record_sampler), std::move(connection_observer),
+                      std::move(request_observer))
         , request_handler_(std::forward<Handler>(request_handler)) {
     }
 
@@ -82,11 +147,11 @@ private:
         return this->shared_from_this();
     }
 
-    void HandleRequest(HttpRequest&& request) override {
+    void HandleRequest(HttpRequest&& request, std::shared_ptr<RequestTiming> timing) override {
         // Capture a smart pointer to the current Session object in the lambda,
         // to extend the lifetime of the session until the lambda is called.
         // A generic lambda function is used, capable of accepting a response of any type
-        request_handler_(std::move(request), [self = this->shared_from_this()](auto&& response) {
+        request_handler_(std::move(request), std::move(timing), [self = this->shared_from_this()](auto&& response) {
             self->Write(std::move(response));
         });
     }
@@ -96,11 +161,15 @@ template <typename RequestHandler>
 class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
 public:
     template <typename Handler>
-    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, std::function<void(const json::object&)> data_collection, Handler&& request_handler)
+    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, DataCollection data_collection, RecordSampler record_sampler,
+             ConnectionObserver connection_observer, RequestObserver request_observer, Handler&& request_handler)
         : ioc_(ioc)
         // The handlers for asynchronous operations of acceptor_ will be called in its strand
         , acceptor_(net::make_strand(ioc))
-        , data_collection_(data_collection)
+        , data_collection_(std::move(data_collection))
+        , record_sampler_(std::move(record_sampler))
+        , connection_observer_(std::move(connection_observer))
+        , request_observer_(std::move(request_observer))
         , request_handler_(std::forward<Handler>(request_handler)) {
         // Open the acceptor using the protocol (IPv4 or IPv6) specified in the endpoint
         acceptor_.open(endpoint.protocol());
@@ -124,7 +193,10 @@ public:
 private:
     net::io_context& ioc_;
     tcp::acceptor acceptor_;
-    std::function<void(const json::object&)> data_collection_;
+    DataCollection data_collection_;
+    RecordSampler record_sampler_;
+    ConnectionObserver connection_observer_;
+    RequestObserver request_observer_;
     RequestHandler request_handler_;
 
 private:
@@ -155,7 +227,7 @@ private:
             custom_data.emplace("text", ec.message());
             custom_data.emplace("where", "accept");
 
-            data_collection_(custom_data);
+            data_collection_(std::move(custom_data));
             return;
         }
 
@@ -167,17 +239,20 @@ private:
     }
 
     void AsyncRunSession(tcp::socket&& socket) {
-        std::make_shared<Session<RequestHandler>>(std::move(socket), data_collection_, request_handler_)->Run();
+        std::make_shared<Session<RequestHandler>>(std::move(socket), data_collection_, record_sampler_, connection_observer_, request_observer_,
+                                                 request_handler_)->Run();
     }
 };
 
 template <typename RequestHandler>
-void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, std::function<void(const json::object&)> data_collection, RequestHandler&& handler) {
+void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, DataCollection data_collection, RecordSampler record_sampler,
+               ConnectionObserver connection_observer, RequestObserver request_observer, RequestHandler&& handler) {
     // Using decay_t, we will exclude references from the RequestHandler type,
     // so that the Listener stores the RequestHandler by value
     using MyListener = Listener<std::decay_t<RequestHandler>>;
 
-    std::make_shared<MyListener>(ioc, endpoint, data_collection, std::forward<RequestHandler>(handler))->Run();
+    std::make_shared<MyListener>(ioc, endpoint, std::move(data_collection), std::move(record_sampler), std::move(connection_observer),
+                                 std::move(request_observer), std::forward<RequestHandler>(handler))->Run();
 }
 
 }  // namespace http_server
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "random.h"
+
+namespace util {
+
+// Samples indices of a discrete distribution in O(1) using Walker's alias method (Vose's construction).
+// The table is built once in O(n) from non-negative weights, each sample takes one index and one real number
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    explicit AliasTable(const std::vector<double>& weights) {
+        Build(weights);
+    }
+
+    void Build(const std::vector<double>& weights) {
+        const std::size_t count = weights.size();
+        probabilities_.assign(count, 1.0);
+        aliases_.resize(count);
+        for (std::size_t i = 0; i != count; ++i) {
+            aliases_[i] = static_cast<std::uint32_t>(i);
+        }
+
+        double total = 0.0;
+        for (double weight : weights) {
+            if (weight < 0.0) {
+                throw std::invalid_argument("Weight must not be negative");
+            }
+            total += weight;
+        }
+        if (count == 0 || total <= 0.0) {
+            // All indices are equally likely
+            return;
+        }
+
+        std::vector<double> scaled(count);
+        std::vector<std::uint32_t> small;
+        std::vector<std::uint32_t> large;
+        small.reserve(count);
+        large.reserve(count);
+        for (std::size_t i = 0; i != count; ++i) {
+            scaled[i] = weights[i] * static_cast<double>(count) / total;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+        }
+
+        while (!small.empty() && !large.empty()) {
+            const auto less = small.back();
+            small.pop_back();
+            const auto more = large.back();
+            probabilities_[less] = scaled[less];
+            aliases_[less] = more;
+            scaled[more] -= 1.0 - scaled[less];
+            if (scaled[more] < 1.0) {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+        // Columns left in either list are full up to rounding errors
+        for (auto index : small) {
+            probabilities_[index] = 1.0;
+        }
+        for (auto index : large) {
+            probabilities_[index] = 1.0;
+        }
+    }
+
+    // The table must not be empty
+    std::size_t Sample(RandomEngine& engine) const noexcept {
+        const auto column = static_cast<std::size_t>(engine.NextIndex(probabilities_.size()));
+        return engine.NextDouble() < probabilities_[column] ? column : aliases_[column];
+    }
+
+    std::size_t size() const noexcept {
+        return probabilities_.size();
+    }
+
+    bool empty() const noexcept {
+        return probabilities_.empty();
+    }
+
+    const std::vector<double>& GetProbabilities() const noexcept {
+        return probabilities_;
+    }
+
+    const std::vector<std::uint32_t>& GetAliases() const noexcept {
+        return aliases_;
+    }
+
+    // Restores a table built before, e.g. saved to a file
+    void Assign(std::vector<double> probabilities, std::vector<std::uint32_t> aliases) {
+        if (probabilities.size() != aliases.size()) {
+            throw std::invalid_argument("Alias table columns differ in size");
+        }
+        for (auto alias : aliases) {
+            if (alias >= aliases.size()) {
+                throw std::invalid_argument("Alias is out of range");
+            }
+        }
+        probabilities_ = std::move(probabilities);
+        aliases_ = std::move(aliases);
+    }
+
+private:
+    std::vector<double> probabilities_;
+    std::vector<std::uint32_t> aliases_;
+};
+
+}  // namespace util
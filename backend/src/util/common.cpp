@@ -1,31 +1,21 @@
 #include "common.h"
 
-namespace detail {
-
-void DurationMeasure::StartMeasurement() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    start_ts_ = std::chrono::system_clock::now();
-}
-
-std::int64_t DurationMeasure::GetDuration() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    end_ts_ = std::chrono::system_clock::now();
-    duration_ = std::chrono::duration_cast<std::chrono::milliseconds>(end_ts_ - start_ts_).count();
-    return duration_;
-}
-
-}  // namespace detail
-
 ApiHandlerParams::ApiHandlerParams(const extra_data::Payload& pl,
                                    app::Application& app,
                                    bool is_state_file,
                                    bool is_save_state_period,
-                                   bool is_tick_period)
+                                   bool is_tick_period,
+                                   bool is_admin_api,
+                                   metrics::Registry& registry,
+                                   std::function<bool()> reload)
     : payload{pl}
     , ref_app{app}
     , is_state_file_set{is_state_file}
     , is_save_state_period_set{is_save_state_period}
-    , is_tick_period_set{is_tick_period} {
+    , is_tick_period_set{is_tick_period}
+    , is_admin_api_enabled{is_admin_api}
+    , metrics{registry}
+    , reload_maps{std::move(reload)} {
 }
 
 Ticker::Ticker(Strand strand, std::chrono::milliseconds period, Handler handler)
@@ -65,6 +55,53 @@ void Ticker::OnTick(sys::error_code ec) {
     }
 }
 
+MapReloader::MapReloader(net::io_context& ioc, Strand strand, app::Application& app, extra_data::Payload& payload,
+                         Loader loader, ReloadedHandler reloaded_handler, ErrorHandler error_handler)
+    : ioc_{ioc}
+    , strand_{strand}
+    , app_{app}
+    , payload_{payload}
+    , loader_{std::move(loader)}
+    , reloaded_handler_{std::move(reloaded_handler)}
+    , error_handler_{std::move(error_handler)} {
+}
+
+bool MapReloader::Reload() {
+    if (is_reloading_.exchange(true)) {
+        return false;
+    }
+    net::post(ioc_, [self = shared_from_this()] {
+        try {
+            extra_data::Payload payload;
+            auto game = self->loader_(payload);
+            net::post(self->strand_, [self, game = std::move(game), payload = std::move(payload)]() mutable {
+                self->Replace(std::move(game), std::move(payload));
+            });
+        } catch (const std::exception& e) {
+            self->Fail(e);
+        }
+    });
+    return true;
+}
+
+void MapReloader::Replace(model::Game game, extra_data::Payload payload) {
+    assert(strand_.running_in_this_thread());
+    try {
+        app_.GetGame()->ReplaceMaps(game.GetMaps());
+        payload_ = std::move(payload);
+    } catch (const std::exception& e) {
+        Fail(e);
+        return;
+    }
+    is_reloading_ = false;
+    reloaded_handler_(app_.GetGame()->GetMapsVersion());
+}
+
+void MapReloader::Fail(const std::exception& e) {
+    is_reloading_ = false;
+    error_handler_(e);
+}
+
 StringResponse MakeBadRequestError(Version version, bool keep_alive, const std::string& code, const std::string& message) {
     StringResponse response;
     response.version(version);
@@ -126,6 +163,21 @@ StringResponse MakeUnauthorizedError(Version version, bool keep_alive, const std
     return response;
 }
 
+StringResponse MakeForbiddenError(Version version, bool keep_alive, const std::string& code, const std::string& message) {
+    StringResponse response;
+    response.version(version);
+    response.keep_alive(keep_alive);
+    response.result(http::status::forbidden);
+    response.set(http::field::content_type, "application/json"sv);
+    response.set(http::field::cache_control, "no-cache");
+    json::object json_error;
+    json_error["code"] = code;
+    json_error["message"] = message;
+    response.body() = json::serialize(json_error);
+    response.content_length(response.body().size());
+    return response;
+}
+
 bool IsGetOrHeadMethod(http::verb method) {
     return method == http::verb::get || method == http::verb::head;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <functional>
@@ -10,6 +11,7 @@
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/beast.hpp>
 #include <boost/json.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -18,6 +20,7 @@
 
 #include "extra_data.h"
 #include "../app/app.h"
+#include "../metrics/metrics.h"
 #include "../server/http_server.h"
 
 namespace net = boost::asio;
@@ -38,35 +41,26 @@ using StringResponse = http::response<http::string_body>;
 // The response, the body of which is presented as a file
 using FileResponse = http::response<http::file_body>;
 
-namespace detail {
-
-class DurationMeasure {
-public:
-    void StartMeasurement();
-
-    std::int64_t GetDuration();
-
-private:
-    std::chrono::system_clock::time_point start_ts_;
-    std::chrono::system_clock::time_point end_ts_;
-    std::int64_t duration_;
-    std::mutex mutex_;
-};
-
-}  // namespace detail
-
 struct ApiHandlerParams {
     const extra_data::Payload& payload;
     app::Application& ref_app;
     bool is_state_file_set;
     bool is_save_state_period_set;
     bool is_tick_period_set;
+    bool is_admin_api_enabled;
+    metrics::Registry& metrics;
+    // Starts reloading the maps in the background, returns false if a reload is running already.
+    // Empty if the maps can't be reloaded
+    std::function<bool()> reload_maps;
 
     ApiHandlerParams(const extra_data::Payload& pl,
                      app::Application& app,
                      bool is_state_file,
                      bool is_save_state_period,
-                     bool is_tick_period);
+                     bool is_tick_period,
+                     bool is_admin_api,
+                     metrics::Registry& registry,
+                     std::function<bool()> reload = {});
 };
 
 class Ticker : public std::enable_shared_from_this<Ticker> {
@@ -92,6 +86,36 @@ private:
     Clock::time_point last_tick_;
 };
 
+// Loads the maps on the io_context and swaps them in on the strand, so ticks and requests are not held up meanwhile
+class MapReloader : public std::enable_shared_from_this<MapReloader> {
+public:
+    using Strand = net::strand<net::io_context::executor_type>;
+    using Loader = std::function<model::Game(extra_data::Payload& payload)>;
+    using ReloadedHandler = std::function<void(std::uint32_t maps_version)>;
+    using ErrorHandler = std::function<void(const std::exception& e)>;
+
+    MapReloader(net::io_context& ioc, Strand strand, app::Application& app, extra_data::Payload& payload,
+                Loader loader, ReloadedHandler reloaded_handler, ErrorHandler error_handler);
+
+    // Returns false if the previous reload has not finished yet
+    bool Reload();
+
+private:
+    void Replace(model::Game game, extra_data::Payload payload);
+
+    void Fail(const std::exception& e);
+
+    net::io_context& ioc_;
+    Strand strand_;
+    app::Application& app_;
+    // Read by the handlers on the strand, so it is replaced only there
+    extra_data::Payload& payload_;
+    Loader loader_;
+    ReloadedHandler reloaded_handler_;
+    ErrorHandler error_handler_;
+    std::atomic_bool is_reloading_{false};
+};
+
 StringResponse MakeBadRequestError(Version version, bool keep_alive, const std::string& code, const std::string& message);
 
 StringResponse MakeMethodNotAllowedError(Version version, bool keep_alive, const std::string& allow, const std::string& code, const std::string& message);
@@ -100,6 +124,8 @@ StringResponse MakeNotFoundError(Version version, bool keep_alive, const std::st
 
 StringResponse MakeUnauthorizedError(Version version, bool keep_alive, const std::string& code, const std::string& message);
 
+StringResponse MakeForbiddenError(Version version, bool keep_alive, const std::string& code, const std::string& message);
+
 bool IsGetOrHeadMethod(http::verb method);
 
 bool IsPostMethod(http::verb method);
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+// Lock-free histogram of non-negative integer values (e.g. latencies in microseconds) in the spirit of HdrHistogram.
+// Values below SUB_BUCKETS are counted exactly, larger ones fall into SUB_BUCKETS linear buckets per power of two,
+// so the relative error of a reported value is below 1 / SUB_BUCKETS. Recording is wait-free except for the maximum
+class Histogram {
+public:
+    static constexpr std::size_t SUB_BUCKET_BITS = 4;
+    static constexpr std::uint64_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    Histogram() = default;
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    void Record(std::uint64_t value) noexcept {
+        buckets_[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        auto max = max_.load(std::memory_order_relaxed);
+        while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::uint64_t GetCount() const noexcept {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t GetSum() const noexcept {
+        return sum_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t GetMax() const noexcept {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    double GetMean() const noexcept {
+        const auto count = GetCount();
+        return count == 0 ? 0. : static_cast<double>(GetSum()) / static_cast<double>(count);
+    }
+
+    // Upper bound of the bucket holding the value at the given fraction (0.5 for the median), 0 if empty
+    std::uint64_t GetPercentile(double fraction) const noexcept {
+        const auto count = GetCount();
+        if (count == 0) {
+            return 0;
+        }
+        const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction * static_cast<double>(count) + 0.5));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i != BUCKET_COUNT; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(GetBucketUpperBound(i), GetMax());
+            }
+        }
+        return GetMax();
+    }
+
+    // Number of recorded values that are less or equal to the bound, rounded to bucket boundaries
+    std::uint64_t GetCountAtOrBelow(std::uint64_t bound) const noexcept {
+        std::uint64_t result = 0;
+        for (std::size_t i = 0; i != BUCKET_COUNT && GetBucketLowerBound(i) <= bound; ++i) {
+            result += buckets_[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    static std::size_t GetBucketIndex(std::uint64_t value) noexcept {
+        if (value < SUB_BUCKETS) {
+            return static_cast<std::size_t>(value);
+        }
+        const auto msb = static_cast<std::size_t>(std::bit_width(value)) - 1;
+        const auto shift = msb - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<std::size_t>((value >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    static std::uint64_t GetBucketLowerBound(std::size_t index) noexcept {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const auto shift = index / SUB_BUCKETS - 1;
+        return (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    }
+
+    static std::uint64_t GetBucketUpperBound(std::size_t index) noexcept {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const auto shift = index / SUB_BUCKETS - 1;
+        return GetBucketLowerBound(index) + ((std::uint64_t{1} << shift) - 1);
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+}  // namespace util
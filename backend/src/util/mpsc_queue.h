@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace util {
+
+// Bounded lock-free queue for many producers and a single consumer, based on D. Vyukov's bounded MPMC queue.
+// Every slot carries a sequence number telling whether it is free for the producer at a position
+// or holds a value for the consumer. TryPush fails instead of blocking when the queue is full
+template <typename T>
+class MpscQueue {
+    // A claimed slot must be published, so nothing may throw between claiming and publishing it
+    static_assert(std::is_nothrow_move_constructible_v<T>);
+
+public:
+    // The capacity is rounded up to a power of two
+    explicit MpscQueue(std::size_t capacity)
+        : mask_{std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1}
+        , slots_{std::make_unique<Slot[]>(mask_ + 1)} {
+        if (capacity == 0) {
+            throw std::invalid_argument("Queue capacity must be positive");
+        }
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // May be called from any thread. The value is made before a slot is claimed,
+    // so if making it throws, the queue is left as it was
+    template <typename... Args>
+    bool TryPush(Args&&... args) {
+        T value(std::forward<Args>(args)...);
+        auto position = tail_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[position & mask_];
+            const auto sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The consumer has not freed the slot yet
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value.emplace(std::move(value));
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Must be called from the consumer thread only
+    std::optional<T> TryPop() {
+        auto& slot = slots_[head_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return std::nullopt;
+        }
+        std::optional<T> result{std::move(slot.value)};
+        slot.value.reset();
+        slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return result;
+    }
+
+    std::size_t GetCapacity() const noexcept {
+        return mask_ + 1;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        std::optional<T> value;
+    };
+
+    std::size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    // Producers and the consumer work on different cache lines
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::size_t head_ = 0;
+};
+
+}  // namespace util
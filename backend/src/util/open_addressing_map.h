@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Hash table with linear probing over a single contiguous array of slots.
+// Elements are never erased, which keeps probing sequences simple: a lookup stops at the first free slot.
+// Key and Value must be default constructible.
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class OpenAddressingMap {
+    struct Slot {
+        std::pair<Key, Value> entry;
+        bool occupied = false;
+    };
+
+    using Slots = std::vector<Slot>;
+
+public:
+    using value_type = std::pair<Key, Value>;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = OpenAddressingMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const {
+            return it_->entry;
+        }
+
+        pointer operator->() const {
+            return &it_->entry;
+        }
+
+        const_iterator& operator++() {
+            ++it_;
+            SkipFree();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return it_ == other.it_;
+        }
+
+    private:
+        friend class OpenAddressingMap;
+
+        using SlotIterator = typename Slots::const_iterator;
+
+        const_iterator(SlotIterator it, SlotIterator end)
+            : it_{it}
+            , end_{end} {
+            SkipFree();
+        }
+
+        void SkipFree() {
+            while (it_ != end_ && !it_->occupied) {
+                ++it_;
+            }
+        }
+
+        SlotIterator it_;
+        SlotIterator end_;
+    };
+
+    std::pair<const_iterator, bool> emplace(const Key& key, Value value) {
+        if ((size_ + 1) * MAX_LOAD_DENOMINATOR > slots_.size() * MAX_LOAD_NUMERATOR) {
+            Rehash(slots_.empty() ? MIN_CAPACITY : slots_.size() * 2);
+        }
+        const std::size_t index = Probe(key);
+        auto& slot = slots_[index];
+        if (slot.occupied) {
+            return {MakeIterator(index), false};
+        }
+        slot.entry.first = key;
+        slot.entry.second = std::move(value);
+        slot.occupied = true;
+        ++size_;
+        return {MakeIterator(index), true};
+    }
+
+    const_iterator find(const Key& key) const {
+        if (slots_.empty()) {
+            return end();
+        }
+        const std::size_t index = Probe(key);
+        return slots_[index].occupied ? MakeIterator(index) : end();
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != end();
+    }
+
+    void reserve(std::size_t count) {
+        std::size_t capacity = MIN_CAPACITY;
+        while (count * MAX_LOAD_DENOMINATOR > capacity * MAX_LOAD_NUMERATOR) {
+            capacity *= 2;
+        }
+        if (capacity > slots_.size()) {
+            Rehash(capacity);
+        }
+    }
+
+    const_iterator begin() const {
+        return {slots_.cbegin(), slots_.cend()};
+    }
+
+    const_iterator end() const {
+        return {slots_.cend(), slots_.cend()};
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+private:
+    static constexpr std::size_t MIN_CAPACITY = 16;
+    // The table grows when it becomes more than 3/4 full
+    static constexpr std::size_t MAX_LOAD_NUMERATOR = 3;
+    static constexpr std::size_t MAX_LOAD_DENOMINATOR = 4;
+
+    Slots slots_;
+    std::size_t size_ = 0;
+    Hash hasher_;
+    KeyEqual key_equal_;
+
+    const_iterator MakeIterator(std::size_t index) const {
+        return {slots_.cbegin() + index, slots_.cend()};
+    }
+
+    // Returns the index of the slot holding the key or of the free slot where it should be placed.
+    // The capacity is always a power of two, so the position is taken from the upper bits of the mixed hash
+    std::size_t Probe(const Key& key) const {
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t index = static_cast<std::size_t>((static_cast<std::uint64_t>(hasher_(key)) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+        while (slots_[index].occupied && !key_equal_(slots_[index].entry.first, key)) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void Rehash(std::size_t capacity) {
+        Slots old_slots(capacity);
+        old_slots.swap(slots_);
+        for (auto& slot : old_slots) {
+            if (slot.occupied) {
+                auto& new_slot = slots_[Probe(slot.entry.first)];
+                new_slot.entry = std::move(slot.entry);
+                new_slot.occupied = true;
+            }
+        }
+    }
+};
+
+}  // namespace util
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+// Calls fn(i) for every i in [0, count) on up to max_threads threads, the calling thread is one of them.
+// Indices are handed out one by one, so uneven work items are balanced. The first exception thrown
+// by fn stops handing out indices and is rethrown once all threads have finished
+template <typename Fn>
+void ParallelFor(std::size_t count, const Fn& fn, unsigned int max_threads = std::thread::hardware_concurrency()) {
+    const auto thread_count = static_cast<std::size_t>(std::min<std::size_t>(std::max(1u, max_threads), count));
+    if (thread_count <= 1) {
+        for (std::size_t i = 0; i != count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto work = [&] {
+        for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard lock{error_mutex};
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next.store(count);
+            }
+        }
+    };
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(thread_count - 1);
+        for (std::size_t i = 1; i != thread_count; ++i) {
+            threads.emplace_back(work);
+        }
+        work();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}  // namespace util
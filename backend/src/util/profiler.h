@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+using ProfilerClock = std::chrono::steady_clock;
+
+// Duration statistics of a repeatedly executed code section. Not thread-safe, it is updated by the code it measures
+class PhaseStats {
+public:
+    using Duration = ProfilerClock::duration;
+
+    void Add(Duration duration) noexcept {
+        ++count_;
+        total_ += duration;
+        max_ = std::max(max_, duration);
+        last_ = duration;
+    }
+
+    std::uint64_t GetCount() const noexcept {
+        return count_;
+    }
+
+    Duration GetTotal() const noexcept {
+        return total_;
+    }
+
+    Duration GetMax() const noexcept {
+        return max_;
+    }
+
+    Duration GetLast() const noexcept {
+        return last_;
+    }
+
+    Duration GetMean() const noexcept {
+        return count_ == 0 ? Duration::zero() : total_ / static_cast<Duration::rep>(count_);
+    }
+
+private:
+    std::uint64_t count_ = 0;
+    Duration total_{};
+    Duration max_{};
+    Duration last_{};
+};
+
+struct TraceEvent {
+    // Names are string literals
+    std::string_view name;
+    // Events of one track are shown on one row of the trace viewer
+    std::uint32_t track;
+    ProfilerClock::time_point start;
+    ProfilerClock::duration duration;
+};
+
+// Collects timed sections of a window of ticks, e.g. to show them in the Chrome trace viewer
+class TraceRecorder {
+public:
+    // Recording stops at this number of events even if the window is not over
+    static constexpr std::size_t MAX_EVENTS = 1 << 20;
+
+    // Discards the previous trace
+    void Start(std::size_t ticks) {
+        events_.clear();
+        requested_ticks_ = ticks;
+        recorded_ticks_ = 0;
+        origin_ = ProfilerClock::now();
+        recording_ = ticks != 0;
+    }
+
+    // Called at the start of every tick, so the work done after the last tick of the window (e.g. saving) is included
+    void BeginTick() noexcept {
+        if (recording_ && recorded_ticks_++ == requested_ticks_) {
+            recording_ = false;
+        }
+    }
+
+    // Called from destructors, so a failure to grow the trace ends the recording instead of throwing
+    void Add(const TraceEvent& event) noexcept {
+        if (!recording_) {
+            return;
+        }
+        if (events_.size() == MAX_EVENTS) {
+            recording_ = false;
+            return;
+        }
+        try {
+            events_.push_back(event);
+        } catch (const std::bad_alloc&) {
+            recording_ = false;
+        }
+    }
+
+    bool IsRecording() const noexcept {
+        return recording_;
+    }
+
+    std::size_t GetRequestedTicks() const noexcept {
+        return requested_ticks_;
+    }
+
+    ProfilerClock::time_point GetOrigin() const noexcept {
+        return origin_;
+    }
+
+    const std::vector<TraceEvent>& GetEvents() const noexcept {
+        return events_;
+    }
+
+private:
+    std::vector<TraceEvent> events_;
+    std::size_t requested_ticks_ = 0;
+    std::size_t recorded_ticks_ = 0;
+    ProfilerClock::time_point origin_{};
+    bool recording_ = false;
+};
+
+// Adds the time between its construction and destruction to the stats and, if given, to the trace
+class ScopedTimer {
+public:
+    ScopedTimer(PhaseStats& stats, TraceRecorder* trace, std::string_view name, std::uint32_t track) noexcept
+        : stats_{stats}
+        , trace_{trace}
+        , name_{name}
+        , track_{track}
+        , start_{ProfilerClock::now()} {
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() noexcept {
+        const auto duration = ProfilerClock::now() - start_;
+        stats_.Add(duration);
+        if (trace_) {
+            trace_->Add({name_, track_, start_, duration});
+        }
+    }
+
+private:
+    PhaseStats& stats_;
+    TraceRecorder* trace_;
+    std::string_view name_;
+    std::uint32_t track_;
+    ProfilerClock::time_point start_;
+};
+
+}  // namespace util
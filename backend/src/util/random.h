@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace util {
+
+// Step of the splitmix64 generator, used to expand a single seed into a full engine state
+inline std::uint64_t SplitMix64(std::uint64_t& state) noexcept {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Derives an independent seed for a stream (for example a game session) from a base seed
+inline std::uint64_t MixSeed(std::uint64_t seed, std::uint64_t stream) noexcept {
+    std::uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03ull);
+    return SplitMix64(state);
+}
+
+inline std::uint64_t NondeterministicSeed() {
+    std::random_device random_device;
+    return (static_cast<std::uint64_t>(random_device()) << 32) ^ random_device();
+}
+
+// xoshiro256** generator by D. Blackman and S. Vigna.
+// It is several times faster than std::mt19937, its state is 32 bytes, and the same seed always
+// produces the same sequence, so it can be used for reproducible simulations
+class RandomEngine {
+public:
+    using result_type = std::uint64_t;
+    using State = std::array<std::uint64_t, 4>;
+
+    explicit RandomEngine(std::uint64_t seed = 0) noexcept {
+        Seed(seed);
+    }
+
+    void Seed(std::uint64_t seed) noexcept {
+        for (auto& word : state_) {
+            word = SplitMix64(seed);
+        }
+    }
+
+    const State& GetState() const noexcept {
+        return state_;
+    }
+
+    void SetState(const State& state) noexcept {
+        state_ = state;
+    }
+
+    static constexpr result_type min() noexcept {
+        return std::numeric_limits<result_type>::min();
+    }
+
+    static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept {
+        const std::uint64_t result = RotateLeft(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = RotateLeft(state_[3], 45);
+        return result;
+    }
+
+    // Uniformly distributed number in [0, 1)
+    double NextDouble() noexcept {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    // Uniformly distributed number in [min, max)
+    double NextDouble(double min, double max) noexcept {
+        return min + (max - min) * NextDouble();
+    }
+
+    // Uniformly distributed number in [0, bound), bound must be greater than 0.
+    // Lemire's multiply-and-shift method, the rejection step removes the modulo bias
+    std::uint64_t NextIndex(std::uint64_t bound) noexcept {
+        unsigned __int128 product = static_cast<unsigned __int128>((*this)()) * bound;
+        auto low = static_cast<std::uint64_t>(product);
+        if (low < bound) {
+            const std::uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<unsigned __int128>((*this)()) * bound;
+                low = static_cast<std::uint64_t>(product);
+            }
+        }
+        return static_cast<std::uint64_t>(product >> 64);
+    }
+
+private:
+    State state_;
+
+    static std::uint64_t RotateLeft(std::uint64_t x, int k) noexcept {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+}  // namespace util
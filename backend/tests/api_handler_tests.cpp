@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/handler/api_handler.h"
+#include "game_fixture.h"
+
+using namespace std::literals;
+
+namespace {
+
+StringRequest MakeRequest(http::verb method, std::string target, std::string body = {}) {
+    StringRequest request{method, target, 11};
+    request.body() = std::move(body);
+    request.prepare_payload();
+    return request;
+}
+
+json::object ParseObject(const StringResponse& response) {
+    return json::parse(response.body()).as_object();
+}
+
+struct Server {
+    extra_data::Payload payload;
+    app::Application app{game_fixture::MakeGame(), false};
+    metrics::Registry metrics;
+    ApiHandlerParams params{payload, app, false, false, false, true, metrics};
+    api_handler::ApiHandlerManager manager{params};
+
+    StringResponse Handle(const StringRequest& request) {
+        return manager.HandleApiRequest(request);
+    }
+
+    std::string Join(const std::string& name) {
+        return app.JoinGame(name, model::Map::Id{"map1"s}).player_token;
+    }
+
+    const model::Dog& GetDog(std::size_t index) const {
+        return *app.GetGame()->GetGameSessions().front()->GetDogs().at(index);
+    }
+};
+
+}  // namespace
+
+TEST_CASE("Batch player actions are applied and failed ones are reported by index") {
+    Server server;
+    const auto first = server.Join("first"s);
+    const auto second = server.Join("second"s);
+
+    SECTION("a mixed batch applies the valid actions") {
+        json::array batch{
+            json::object{{"token", first}, {"move", "R"}},
+            json::object{{"token", std::string(app::Token::HEX_SIZE, '0')}, {"move", "L"}},
+            json::object{{"token", second}, {"move", "D"}},
+            json::object{{"token", second}, {"move", "X"}},
+            json::object{{"token", "not a token"}, {"move", "U"}}
+        };
+        const auto response = server.Handle(MakeRequest(http::verb::post, "/api/v1/game/player/actions", json::serialize(batch)));
+        REQUIRE(response.result() == http::status::ok);
+        const auto body = ParseObject(response);
+        CHECK(body.at("applied").as_int64() == 2);
+        const auto& errors = body.at("errors").as_array();
+        REQUIRE(errors.size() == 3);
+        CHECK(errors[0].at("index").as_int64() == 1);
+        CHECK(errors[0].at("code").as_string() == "unknownToken");
+        CHECK(errors[1].at("index").as_int64() == 3);
+        CHECK(errors[1].at("code").as_string() == "invalidArgument");
+        CHECK(errors[2].at("index").as_int64() == 4);
+        CHECK(errors[2].at("code").as_string() == "unknownToken");
+
+        CHECK(server.GetDog(0).GetSpeed() == geom::Vec2D{2.0, 0.0});
+        // The invalid action of the second player does not undo the valid one before it
+        CHECK(server.GetDog(1).GetSpeed() == geom::Vec2D{0.0, 2.0});
+    }
+
+    SECTION("an invalid token fails only its own action") {
+        json::array batch{
+            json::object{{"token", "Bearer "s + first}, {"move", "R"}},
+            json::object{{"token", first}, {"move", "L"}}
+        };
+        const auto response = server.Handle(MakeRequest(http::verb::post, "/api/v1/game/player/actions", json::serialize(batch)));
+        REQUIRE(response.result() == http::status::ok);
+        const auto body = ParseObject(response);
+        CHECK(body.at("applied").as_int64() == 1);
+        REQUIRE(body.at("errors").as_array().size() == 1);
+        CHECK(body.at("errors").as_array()[0].at("index").as_int64() == 0);
+        CHECK(server.GetDog(0).GetSpeed() == geom::Vec2D{-2.0, 0.0});
+    }
+
+    SECTION("an empty batch applies nothing") {
+        const auto response = server.Handle(MakeRequest(http::verb::post, "/api/v1/game/player/actions", "[]"s));
+        REQUIRE(response.result() == http::status::ok);
+        const auto body = ParseObject(response);
+        CHECK(body.at("applied").as_int64() == 0);
+        CHECK(body.at("errors").as_array().empty());
+    }
+
+    SECTION("a malformed batch is rejected as a whole") {
+        for (const auto& body : {"[{\"token\": "s, "{}"s, "[{\"token\": \"00\"}]"s, "[1, 2]"s}) {
+            const auto response = server.Handle(MakeRequest(http::verb::post, "/api/v1/game/player/actions", body));
+            CHECK(response.result() == http::status::bad_request);
+            CHECK(ParseObject(response).at("code").as_string() == "invalidArgument");
+        }
+        CHECK(server.GetDog(0).GetSpeed() == geom::Vec2D{0.0, 0.0});
+    }
+
+    SECTION("only POST is allowed") {
+        const auto response = server.Handle(MakeRequest(http::verb::get, "/api/v1/game/player/actions"));
+        CHECK(response.result() == http::status::method_not_allowed);
+        CHECK(response.at(http::field::allow) == "POST");
+    }
+}
+
+TEST_CASE("A token with its case changed does not authorize the player") {
+    Server server;
+    const auto token = server.Join("dog"s);
+    std::string upper_token = token;
+    std::transform(upper_token.begin(), upper_token.end(), upper_token.begin(), [](unsigned char c) {
+        return static_cast<char>(std::toupper(c));
+    });
+    REQUIRE(upper_token != token);
+
+    auto request = MakeRequest(http::verb::get, "/api/v1/game/state");
+    request.set(http::field::authorization, "Bearer "s + token);
+    CHECK(server.Handle(request).result() == http::status::ok);
+    request.set(http::field::authorization, "Bearer "s + upper_token);
+    CHECK(server.Handle(request).result() == http::status::unauthorized);
+}
+
+TEST_CASE("Profile reports the tick phases of every session") {
+    Server server;
+    server.Join("dog"s);
+    server.app.UpdateGameState(10);
+
+    const auto response = server.Handle(MakeRequest(http::verb::get, "/api/v1/admin/profile"));
+    REQUIRE(response.result() == http::status::ok);
+    CHECK(response.at(http::field::content_type) == "application/json");
+    const auto body = ParseObject(response);
+    CHECK(body.at("tick").at("count").as_int64() == 1);
+    CHECK(body.at("saveState").at("count").as_int64() == 0);
+    const auto& sessions = body.at("sessions").as_array();
+    REQUIRE(sessions.size() == 1);
+    CHECK(sessions[0].at("mapId").as_string() == "map1");
+    CHECK(sessions[0].at("mapIsCurrent").as_bool());
+    CHECK(sessions[0].at("dogs").as_int64() == 1);
+    const auto& phases = sessions[0].at("phases").as_object();
+    CHECK(phases.size() == model::TICK_PHASE_COUNT);
+    const auto update_dogs = std::string{model::GetTickPhaseName(model::TickPhase::UPDATE_DOGS)};
+    CHECK(phases.at(update_dogs).at("count").as_int64() == 1);
+
+    CHECK(server.Handle(MakeRequest(http::verb::head, "/api/v1/admin/profile")).result() == http::status::ok);
+    CHECK(server.Handle(MakeRequest(http::verb::post, "/api/v1/admin/profile")).result() == http::status::method_not_allowed);
+}
+
+TEST_CASE("Trace records the requested number of ticks") {
+    Server server;
+    server.Join("dog"s);
+
+    SECTION("a started trace is returned in the trace event format") {
+        const auto start = server.Handle(MakeRequest(http::verb::post, "/api/v1/admin/trace", R"({"ticks": 1})"s));
+        REQUIRE(start.result() == http::status::ok);
+        CHECK(ParseObject(start).at("ticks").as_int64() == 1);
+        server.app.UpdateGameState(10);
+        server.app.UpdateGameState(10);
+
+        const auto response = server.Handle(MakeRequest(http::verb::get, "/api/v1/admin/trace"));
+        REQUIRE(response.result() == http::status::ok);
+        const auto body = ParseObject(response);
+        CHECK(body.at("otherData").at("ticks").as_int64() == 1);
+        CHECK_FALSE(body.at("otherData").at("recording").as_bool());
+        const auto& events = body.at("traceEvents").as_array();
+        // Names of the server and session tracks, then the phases of the only traced tick and the tick itself
+        REQUIRE(events.size() == 2 + model::TICK_PHASE_COUNT + 1);
+        CHECK(events[0].at("ph").as_string() == "M");
+        CHECK(events[1].at("args").at("name").as_string() == "session 0 (map1)");
+        CHECK(events[2].at("ph").as_string() == "X");
+        CHECK(events[2].at("tid").as_int64() == 1);
+        CHECK(events.back().at("name").as_string() == "Tick");
+        CHECK(events.back().at("tid").as_int64() == 0);
+    }
+
+    SECTION("an invalid number of ticks is rejected") {
+        const auto max_ticks = std::to_string(api_handler::TraceApiHandler::MAX_TRACE_TICKS + 1);
+        for (const auto& body : {R"({"ticks": 0})"s, R"({"ticks": -1})"s, R"({"ticks": )"s + max_ticks + "}"s, R"({"ticks": "1"})"s, "{}"s}) {
+            const auto response = server.Handle(MakeRequest(http::verb::post, "/api/v1/admin/trace", body));
+            CHECK(response.result() == http::status::bad_request);
+            CHECK(ParseObject(response).at("code").as_string() == "invalidArgument");
+        }
+        CHECK_FALSE(server.app.GetTraceRecorder().IsRecording());
+    }
+
+    SECTION("only GET, HEAD and POST are allowed") {
+        const auto response = server.Handle(MakeRequest(http::verb::put, "/api/v1/admin/trace"));
+        CHECK(response.result() == http::status::method_not_allowed);
+        CHECK(response.at(http::field::allow) == "GET, HEAD, POST");
+    }
+}
+
+TEST_CASE("Admin endpoints are not served unless the admin API is enabled") {
+    extra_data::Payload payload;
+    app::Application app{game_fixture::MakeGame(), false};
+    metrics::Registry metrics;
+    ApiHandlerParams params{payload, app, false, false, false, false, metrics};
+    api_handler::ApiHandlerManager manager{params};
+    for (const auto& target : {"/api/v1/admin/profile"s, "/api/v1/admin/trace"s, "/api/v1/admin/maps/reload"s}) {
+        CHECK(manager.HandleApiRequest(MakeRequest(http::verb::get, target)).result() == http::status::not_found);
+    }
+}
+
+TEST_CASE("Maps reload is started once at a time and refused when disabled") {
+    extra_data::Payload payload;
+    app::Application app{game_fixture::MakeGame(), false};
+    metrics::Registry metrics;
+    const auto reload_request = MakeRequest(http::verb::post, "/api/v1/admin/maps/reload");
+
+    SECTION("a started reload is accepted and a running one conflicts") {
+        int reloads = 0;
+        bool is_running = false;
+        ApiHandlerParams params{payload, app, false, false, false, true, metrics, [&reloads, &is_running] {
+            ++reloads;
+            return !std::exchange(is_running, true);
+        }};
+        api_handler::ApiHandlerManager manager{params};
+
+        const auto accepted = manager.HandleApiRequest(reload_request);
+        REQUIRE(accepted.result() == http::status::accepted);
+        CHECK(ParseObject(accepted).at("mapsVersion").as_int64() == 0);
+
+        const auto conflict = manager.HandleApiRequest(reload_request);
+        CHECK(conflict.result() == http::status::conflict);
+        CHECK(ParseObject(conflict).at("code").as_string() == "reloadInProgress");
+        CHECK(reloads == 2);
+
+        const auto get = manager.HandleApiRequest(MakeRequest(http::verb::get, "/api/v1/admin/maps/reload"));
+        CHECK(get.result() == http::status::method_not_allowed);
+        CHECK(reloads == 2);
+    }
+
+    SECTION("a server that can't reload its maps forbids it") {
+        ApiHandlerParams params{payload, app, false, false, false, true, metrics};
+        api_handler::ApiHandlerManager manager{params};
+        const auto response = manager.HandleApiRequest(reload_request);
+        CHECK(response.result() == http::status::forbidden);
+        CHECK(ParseObject(response).at("code").as_string() == "reloadDisabled");
+    }
+}
+
+TEST_CASE("Map reloader swaps in the loaded maps on the strand") {
+    net::io_context ioc;
+    extra_data::Payload payload;
+    app::Application app{game_fixture::MakeGame(), false};
+    const auto old_session = app.GetGame()->AddGameSession(app.GetGame()->FindMap(model::Map::Id{"map1"s}));
+    bool fail = false;
+    std::vector<std::uint32_t> reloaded;
+    std::vector<std::string> errors;
+    auto reloader = std::make_shared<MapReloader>(ioc, net::make_strand(ioc), app, payload, [&fail](extra_data::Payload& new_payload) {
+        if (fail) {
+            throw std::runtime_error("broken config");
+        }
+        model::Game game;
+        game.AddMap(model::Map{model::Map::Id{"map2"s}, "Map 2"s, 1.0, 3});
+        new_payload.map_id_loot_types.emplace(model::Map::Id{"map2"s}, json::array{json::object{{"name"s, "key"s}}});
+        return game;
+    }, [&reloaded](std::uint32_t maps_version) {
+        reloaded.push_back(maps_version);
+    }, [&errors](const std::exception& e) {
+        errors.emplace_back(e.what());
+    });
+
+    CHECK(reloader->Reload());
+    CHECK_FALSE(reloader->Reload());
+    // Nothing changes until the loader has run and the swap has been posted to the strand
+    CHECK(app.GetGame()->GetMapsVersion() == 0);
+    ioc.run();
+
+    CHECK(reloaded == std::vector<std::uint32_t>{1});
+    CHECK(errors.empty());
+    CHECK(app.GetGame()->FindMap(model::Map::Id{"map1"s}) == nullptr);
+    CHECK(app.GetGame()->FindMap(model::Map::Id{"map2"s}) != nullptr);
+    CHECK(payload.map_id_loot_types.contains(model::Map::Id{"map2"s}));
+    CHECK(old_session->GetMap()->GetId() == model::Map::Id{"map1"s});
+
+    fail = true;
+    REQUIRE(reloader->Reload());
+    ioc.restart();
+    ioc.run();
+    CHECK(errors == std::vector<std::string>{"broken config"s});
+    CHECK(reloaded.size() == 1);
+    CHECK(app.GetGame()->GetMapsVersion() == 1);
+    CHECK(payload.map_id_loot_types.contains(model::Map::Id{"map2"s}));
+    // A failed reload does not block the next one
+    CHECK(reloader->Reload());
+}
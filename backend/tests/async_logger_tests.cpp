@@ -0,0 +1,57 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/logger/async_logger.h"
+
+namespace json = boost::json;
+using namespace std::literals;
+
+namespace {
+
+std::vector<json::object> ParseLines(const std::string& text) {
+    std::vector<json::object> lines;
+    std::istringstream in{text};
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(json::parse(line).as_object());
+    }
+    return lines;
+}
+
+}  // namespace
+
+TEST_CASE("AsyncLogger writes filtered records as JSON lines") {
+    std::ostringstream out;
+    {
+        logger::AsyncLogger async_logger{out, {logger::Level::INFO, 1}};
+        CHECK_FALSE(async_logger.IsEnabled(logger::Level::DEBUG));
+        CHECK(async_logger.IsEnabled(logger::Level::ERROR));
+
+        async_logger.Log(logger::Level::DEBUG, "hidden"sv, json::object{{"id", 0}});
+        async_logger.Log(logger::Level::INFO, "request received"sv, json::object{{"id", 1}});
+        async_logger.Log(logger::Level::WARNING, "error"sv, json::object{{"id", 2}});
+    }
+
+    const auto lines = ParseLines(out.str());
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0].at("message").as_string() == "request received");
+    CHECK(lines[0].at("data").as_object().at("id").as_int64() == 1);
+    CHECK(lines[0].at("timestamp").is_string());
+    CHECK(lines[1].at("message").as_string() == "error");
+}
+
+TEST_CASE("AsyncLogger samples records") {
+    std::ostringstream out;
+    logger::AsyncLogger async_logger{out, {logger::Level::INFO, 3}};
+    int sampled = 0;
+    for (int i = 0; i != 9; ++i) {
+        sampled += async_logger.Sample() ? 1 : 0;
+    }
+    CHECK(sampled == 3);
+
+    CHECK(logger::ParseLevel("warning"sv) == logger::Level::WARNING);
+    CHECK_THROWS_AS(logger::ParseLevel("verbose"sv), std::invalid_argument);
+    CHECK_THROWS_AS((logger::AsyncLogger{out, {logger::Level::INFO, 0}}), std::invalid_argument);
+}
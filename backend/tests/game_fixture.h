@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/app/app.h"
+
+// The game and the state comparisons shared by the tests of the application, its logs and its snapshots
+namespace game_fixture {
+
+// A square of four roads with the office in a corner, loot spawns as soon as a dog joins
+inline std::unique_ptr<model::Game> MakeGame(std::optional<std::uint64_t> seed = std::nullopt) {
+    auto game = std::make_unique<model::Game>();
+    if (seed) {
+        game->SetRandomSeed(*seed);
+    }
+    model::Map map{model::Map::Id{"map1"}, "Map 1", 2.0, 3};
+    map.AddRoads({
+        model::Road(model::Road::Direction::HORIZONTAL, {0, 0}, 40),
+        model::Road(model::Road::Direction::VERTICAL, {40, 0}, 30),
+        model::Road(model::Road::Direction::HORIZONTAL, {40, 30}, 0),
+        model::Road(model::Road::Direction::VERTICAL, {0, 0}, 30)
+    });
+    map.AddOffice(model::Office{model::Office::Id{"o0"}, {0, 0}, {0, 0}});
+    map.AddLoot({0.0001, 0.5}, 1, {10, 30});
+    game->AddMap(std::move(map));
+    return game;
+}
+
+inline void CheckSameDogs(const model::GameSession& session, const model::GameSession& other) {
+    REQUIRE(session.GetDogs().size() == other.GetDogs().size());
+    for (std::size_t i = 0; i != session.GetDogs().size(); ++i) {
+        const auto& dog = *session.GetDogs()[i];
+        const auto& other_dog = *other.GetDogs()[i];
+        CHECK(dog.GetId() == other_dog.GetId());
+        CHECK(dog.GetName() == other_dog.GetName());
+        CHECK(dog.GetPosition() == other_dog.GetPosition());
+        CHECK(dog.GetPreviousPosition() == other_dog.GetPreviousPosition());
+        CHECK(dog.GetSpeed() == other_dog.GetSpeed());
+        CHECK(dog.GetDirection() == other_dog.GetDirection());
+        CHECK(dog.GetCurrentRoadsIndex() == other_dog.GetCurrentRoadsIndex());
+        CHECK(dog.GetBagContent() == other_dog.GetBagContent());
+        CHECK(dog.GetScore() == other_dog.GetScore());
+    }
+}
+
+inline void CheckSameLoot(const model::GameSession& session, const model::GameSession& other) {
+    REQUIRE(static_cast<bool>(session.GetLoot()) == static_cast<bool>(other.GetLoot()));
+    if (!session.GetLoot()) {
+        return;
+    }
+    CHECK(session.GetLoot()->GetTimeWithoutLoot() == other.GetLoot()->GetTimeWithoutLoot());
+    const auto& objects = session.GetLoot()->GetLostObjects();
+    const auto& other_objects = other.GetLoot()->GetLostObjects();
+    REQUIRE(objects.size() == other_objects.size());
+    for (std::size_t i = 0; i != objects.size(); ++i) {
+        CHECK(objects[i]->GetId() == other_objects[i]->GetId());
+        CHECK(objects[i]->GetType() == other_objects[i]->GetType());
+        CHECK(objects[i]->GetPosition() == other_objects[i]->GetPosition());
+    }
+}
+
+// Sessions with their random engines, dogs and loot
+inline void CheckSameSessions(const app::Application& app, const app::Application& other) {
+    const auto& sessions = app.GetGame()->GetGameSessions();
+    const auto& other_sessions = other.GetGame()->GetGameSessions();
+    REQUIRE(sessions.size() == other_sessions.size());
+    for (std::size_t i = 0; i != sessions.size(); ++i) {
+        CHECK(sessions[i]->GetId() == other_sessions[i]->GetId());
+        CHECK(sessions[i]->GetMap()->GetId() == other_sessions[i]->GetMap()->GetId());
+        CHECK(sessions[i]->GetRandomEngine().GetState() == other_sessions[i]->GetRandomEngine().GetState());
+        CheckSameDogs(*sessions[i], *other_sessions[i]);
+        CheckSameLoot(*sessions[i], *other_sessions[i]);
+    }
+}
+
+// The sessions and the players of every token
+inline void CheckSameState(const app::Application& app, const app::Application& other) {
+    CheckSameSessions(app, other);
+    const auto& tokens = app.GetPlayerTokens()->GetTokenToPlayer();
+    REQUIRE(tokens.size() == other.GetPlayerTokens()->GetTokenToPlayer().size());
+    for (const auto& [token, player] : tokens) {
+        const auto* other_player = other.GetPlayerTokens()->FindPlayerByToken(token);
+        REQUIRE(other_player);
+        CHECK(other_player->GetGameSession()->GetId() == player->GetGameSession()->GetId());
+        CHECK(other_player->GetDog()->GetId() == player->GetDog()->GetId());
+    }
+}
+
+}  // namespace game_fixture
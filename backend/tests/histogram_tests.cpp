@@ -0,0 +1,41 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/util/histogram.h"
+
+TEST_CASE("Histogram buckets cover all values") {
+    using util::Histogram;
+    for (std::uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 31ull, 32ull, 1000ull, 123456789ull, ~0ull}) {
+        const auto index = Histogram::GetBucketIndex(value);
+        INFO("value: " << value);
+        REQUIRE(index < Histogram::BUCKET_COUNT);
+        CHECK(Histogram::GetBucketLowerBound(index) <= value);
+        CHECK(value <= Histogram::GetBucketUpperBound(index));
+    }
+    for (std::size_t index = 1; index != Histogram::BUCKET_COUNT; ++index) {
+        CHECK(Histogram::GetBucketLowerBound(index) == Histogram::GetBucketUpperBound(index - 1) + 1);
+    }
+}
+
+TEST_CASE("Histogram reports percentiles within bucket precision") {
+    util::Histogram histogram;
+    CHECK(histogram.GetPercentile(0.5) == 0);
+
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+        histogram.Record(value);
+    }
+    CHECK(histogram.GetCount() == 1000);
+    CHECK(histogram.GetSum() == 500500);
+    CHECK(histogram.GetMax() == 1000);
+    CHECK(histogram.GetMean() == 500.5);
+
+    const auto median = histogram.GetPercentile(0.5);
+    CHECK(median >= 500);
+    CHECK(median <= 500 + 500 / util::Histogram::SUB_BUCKETS);
+    const auto p99 = histogram.GetPercentile(0.99);
+    CHECK(p99 >= 990);
+    CHECK(p99 <= 1000);
+    CHECK(histogram.GetPercentile(1.0) == 1000);
+
+    CHECK(histogram.GetCountAtOrBelow(15) == 15);
+    CHECK(histogram.GetCountAtOrBelow(10000) == 1000);
+}
@@ -0,0 +1,73 @@
+#include <sstream>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/app/app.h"
+#include "../src/app/input_log.h"
+#include "game_fixture.h"
+
+using namespace std::literals;
+
+TEST_CASE("Fixed time step splits ticks into equal steps") {
+    app::Application app{game_fixture::MakeGame(1u), false};
+    app.SetFixedTimeStep(10ms);
+    const auto& result = app.JoinGame("Dog"s, model::Map::Id{"map1"s});
+    const auto credentials = "Bearer "s + result.player_token;
+    app.SetPlayerAction(credentials, "R"s);
+
+    const auto& dog = app.GetGame()->GetGameSessions().front()->GetDogs().front();
+    app.UpdateGameState(25);
+    CHECK(dog->GetPosition().x == 2.0 * 0.02);
+    app.UpdateGameState(5);
+    CHECK(dog->GetPosition().x == 2.0 * 0.03);
+
+    CHECK_THROWS_AS(app.SetFixedTimeStep(-1ms), std::invalid_argument);
+}
+
+TEST_CASE("Input log replays a run of the application") {
+    const app::InputLogHeader header{42u, 10u, 2u, true};
+    std::stringstream log;
+    app::InputLogWriter writer{log, header};
+
+    app::Application app{game_fixture::MakeGame(header.random_seed), header.random_positions, header.max_session_players};
+    app.SetFixedTimeStep(std::chrono::milliseconds{header.fixed_time_step});
+    app.SetInputLog(&writer);
+
+    std::vector<std::string> tokens;
+    for (int i = 0; i != 5; ++i) {
+        tokens.push_back(app.JoinGame("Dog"s + std::to_string(i), model::Map::Id{"map1"s}).player_token);
+    }
+    CHECK_THROWS_AS(app.JoinGame("Lost"s, model::Map::Id{"map2"s}), app::ApplicationError);
+
+    const std::string moves[] = {"R"s, "D"s, "L"s, "U"s, ""s};
+    for (int tick = 0; tick != 200; ++tick) {
+        const auto& token = tokens[tick % tokens.size()];
+        if (tick % 3 == 0) {
+            app.SetPlayerAction("Bearer "s + token, moves[tick % 5]);
+        } else {
+            app.SetPlayerActions({{token, moves[(tick + 1) % 5]}, {"bad"s, "R"s}});
+        }
+        app.UpdateGameState(17 + tick % 40);
+    }
+    writer.Flush();
+
+    app::InputLogReader reader{log};
+    CHECK(reader.GetHeader().random_seed == header.random_seed);
+    CHECK(reader.GetHeader().fixed_time_step == header.fixed_time_step);
+    CHECK(reader.GetHeader().max_session_players == header.max_session_players);
+    CHECK(reader.GetHeader().random_positions == header.random_positions);
+
+    app::Application replayed{game_fixture::MakeGame(reader.GetHeader().random_seed),
+                              reader.GetHeader().random_positions, reader.GetHeader().max_session_players};
+    replayed.SetFixedTimeStep(std::chrono::milliseconds{reader.GetHeader().fixed_time_step});
+    const auto stats = reader.Replay(replayed);
+    CHECK(stats.joins == 5);
+    CHECK(stats.actions == 200);
+    CHECK(stats.ticks == 200);
+    CHECK(stats.rejected == 0);
+
+    game_fixture::CheckSameSessions(app, replayed);
+
+    std::stringstream garbage{"GSIX"s};
+    CHECK_THROWS_AS(app::InputLogReader{garbage}, std::runtime_error);
+}
@@ -0,0 +1,164 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/serialization/journal.h"
+#include "../src/serialization/snapshot_format.h"
+#include "game_fixture.h"
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::uint64_t SEED = 42;
+constexpr app::InputLogHeader HEADER{SEED, 10u, 2u, true};
+
+std::unique_ptr<app::Application> MakeApplication() {
+    auto app = std::make_unique<app::Application>(game_fixture::MakeGame(SEED), true, 2);
+    app->SetFixedTimeStep(10ms);
+    return app;
+}
+
+void Play(app::Application& app, std::vector<std::string>& tokens, int first_tick, int ticks) {
+    const std::string moves[] = {"R"s, "D"s, "L"s, "U"s, ""s};
+    for (int tick = first_tick; tick != first_tick + ticks; ++tick) {
+        if (tick % 25 == 0) {
+            tokens.push_back(app.JoinGame("Dog"s + std::to_string(tick), model::Map::Id{"map1"s}).player_token);
+        }
+        app.SetPlayerAction("Bearer "s + tokens[tick % tokens.size()], moves[tick % 5]);
+        app.UpdateGameState(17 + tick % 40);
+    }
+}
+
+struct TempDirectory {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "journal_tests";
+
+    TempDirectory() {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+
+    ~TempDirectory() {
+        std::filesystem::remove_all(path);
+    }
+};
+
+}  // namespace
+
+TEST_CASE("Snapshot and journal restore the latest state") {
+    TempDirectory directory;
+    const auto journal_path = (directory.path / "state.journal").string();
+
+    auto app = MakeApplication();
+    serialization::Journal journal{journal_path, HEADER, 0};
+    app->SetInputLog(&journal.GetWriter());
+    std::vector<std::string> tokens;
+    Play(*app, tokens, 0, 120);
+
+    // The snapshot is captured when the next segment starts
+    const serialization::JournalCheckpoint checkpoint{journal.Rotate(), app->GetPendingTime().count()};
+    app->SetInputLog(&journal.GetWriter());
+    std::ostringstream snapshot;
+    serialization::WriteBinarySnapshot(serialization::ApplicationRepr{*app}, snapshot, checkpoint);
+    Play(*app, tokens, 120, 80);
+    journal.Rotate();
+    app->SetInputLog(&journal.GetWriter());
+    Play(*app, tokens, 200, 60);
+    journal.Flush();
+    CHECK(serialization::FindJournalSegments(journal_path) == std::vector<std::uint64_t>{0, 1, 2});
+
+    auto restored = MakeApplication();
+    const auto restored_checkpoint = serialization::ReadBinarySnapshot(snapshot.str(), *restored);
+    REQUIRE(restored_checkpoint);
+    CHECK(restored_checkpoint->segment == 1);
+    restored->SetPendingTime(std::chrono::milliseconds{restored_checkpoint->pending_time});
+    CHECK(serialization::ReplayJournal(journal_path, restored_checkpoint->segment, *restored, HEADER) == 2);
+    game_fixture::CheckSameState(*app, *restored);
+
+    serialization::RemoveJournalSegments(journal_path, restored_checkpoint->segment);
+    CHECK(serialization::FindJournalSegments(journal_path) == std::vector<std::uint64_t>{1, 2});
+}
+
+TEST_CASE("Journal replay tolerates a partial record at the end only") {
+    TempDirectory directory;
+    const auto journal_path = (directory.path / "state.journal").string();
+    auto app = MakeApplication();
+    {
+        serialization::Journal journal{journal_path, HEADER, 0};
+        app->SetInputLog(&journal.GetWriter());
+        std::vector<std::string> tokens;
+        Play(*app, tokens, 0, 30);
+        journal.Rotate();
+        app->SetInputLog(&journal.GetWriter());
+        Play(*app, tokens, 30, 30);
+        app->SetInputLog(nullptr);
+    }
+    const auto last_segment = serialization::GetJournalSegmentPath(journal_path, 1);
+    std::filesystem::resize_file(last_segment, std::filesystem::file_size(last_segment) - 3);
+    {
+        auto restored = MakeApplication();
+        CHECK(serialization::ReplayJournal(journal_path, 0, *restored, HEADER) == 2);
+        CHECK(restored->GetGame()->GetGameSessions().size() == app->GetGame()->GetGameSessions().size());
+    }
+
+    const auto first_segment = serialization::GetJournalSegmentPath(journal_path, 0);
+    std::filesystem::resize_file(first_segment, std::filesystem::file_size(first_segment) - 3);
+    auto restored = MakeApplication();
+    CHECK_THROWS_AS(serialization::ReplayJournal(journal_path, 0, *restored, HEADER), std::runtime_error);
+}
+
+TEST_CASE("Journal replay refuses damage that is not a partial last record") {
+    TempDirectory directory;
+    const auto journal_path = (directory.path / "state.journal").string();
+    {
+        auto app = MakeApplication();
+        serialization::Journal journal{journal_path, HEADER, 0};
+        app->SetInputLog(&journal.GetWriter());
+        std::vector<std::string> tokens;
+        Play(*app, tokens, 0, 30);
+        app->SetInputLog(nullptr);
+    }
+    // The first record follows the magic, the version, the seed, the time step, the session size and the spawn mode
+    constexpr std::streamoff first_record = 4 + 4 + 8 + 4 + 4 + 1;
+    {
+        std::fstream file{serialization::GetJournalSegmentPath(journal_path, 0), std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(first_record);
+        file.put(static_cast<char>(0xFF));
+    }
+    auto restored = MakeApplication();
+    CHECK_THROWS_AS(serialization::ReplayJournal(journal_path, 0, *restored, HEADER), std::runtime_error);
+}
+
+TEST_CASE("Journal recorded with other settings is not replayed") {
+    TempDirectory directory;
+    const auto journal_path = (directory.path / "state.journal").string();
+    {
+        auto app = MakeApplication();
+        serialization::Journal journal{journal_path, HEADER, 0};
+        app->SetInputLog(&journal.GetWriter());
+        std::vector<std::string> tokens;
+        Play(*app, tokens, 0, 30);
+        app->SetInputLog(nullptr);
+    }
+
+    auto settings = HEADER;
+    SECTION("fixed time step") {
+        settings.fixed_time_step = 0;
+    }
+    SECTION("session size") {
+        settings.max_session_players = 3;
+    }
+    SECTION("spawn mode") {
+        settings.random_positions = false;
+    }
+    auto restored = MakeApplication();
+    CHECK_THROWS_AS(serialization::ReplayJournal(journal_path, 0, *restored, settings), std::runtime_error);
+    CHECK(restored->GetGame()->GetGameSessions().empty());
+
+    // Segments are recorded with the seed of the run that wrote them, it may differ from the current one
+    settings = HEADER;
+    settings.random_seed = SEED + 1;
+    CHECK(serialization::ReplayJournal(journal_path, 0, *restored, settings) == 1);
+}
@@ -0,0 +1,161 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/loader/json_loader.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::string ReadConfig() {
+    std::ifstream file{"./data/config.json"};
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+void CheckSameGame(const model::Game& lhs, const extra_data::Payload& lhs_payload,
+                   const model::Game& rhs, const extra_data::Payload& rhs_payload) {
+    REQUIRE(lhs.GetMaps().size() == rhs.GetMaps().size());
+    CHECK(lhs_payload.map_id_loot_types.size() == rhs_payload.map_id_loot_types.size());
+    for (std::size_t i = 0; i != lhs.GetMaps().size(); ++i) {
+        const auto& lhs_map = *lhs.GetMaps()[i];
+        const auto& rhs_map = *rhs.GetMaps()[i];
+        CHECK(lhs_map.GetId() == rhs_map.GetId());
+        CHECK(lhs_map.GetName() == rhs_map.GetName());
+        CHECK(lhs_map.GetDogSpeed() == rhs_map.GetDogSpeed());
+        CHECK(lhs_map.GetBagCapacity() == rhs_map.GetBagCapacity());
+        REQUIRE(lhs_map.GetRoads().size() == rhs_map.GetRoads().size());
+        for (std::size_t j = 0; j != lhs_map.GetRoads().size(); ++j) {
+            const auto& lhs_road = lhs_map.GetRoads()[j];
+            const auto& rhs_road = rhs_map.GetRoads()[j];
+            CHECK(lhs_road.IsHorizontal() == rhs_road.IsHorizontal());
+            CHECK(lhs_road.GetStart().x == rhs_road.GetStart().x);
+            CHECK(lhs_road.GetStart().y == rhs_road.GetStart().y);
+            CHECK(lhs_road.GetEnd().x == rhs_road.GetEnd().x);
+            CHECK(lhs_road.GetEnd().y == rhs_road.GetEnd().y);
+        }
+        REQUIRE(lhs_map.GetBuildings().size() == rhs_map.GetBuildings().size());
+        for (std::size_t j = 0; j != lhs_map.GetBuildings().size(); ++j) {
+            const auto& lhs_bounds = lhs_map.GetBuildings()[j].GetBounds();
+            const auto& rhs_bounds = rhs_map.GetBuildings()[j].GetBounds();
+            CHECK(lhs_bounds.position.x == rhs_bounds.position.x);
+            CHECK(lhs_bounds.position.y == rhs_bounds.position.y);
+            CHECK(lhs_bounds.size.width == rhs_bounds.size.width);
+            CHECK(lhs_bounds.size.height == rhs_bounds.size.height);
+        }
+        REQUIRE(lhs_map.GetOffices().size() == rhs_map.GetOffices().size());
+        for (std::size_t j = 0; j != lhs_map.GetOffices().size(); ++j) {
+            const auto& lhs_office = lhs_map.GetOffices()[j];
+            const auto& rhs_office = rhs_map.GetOffices()[j];
+            CHECK(lhs_office.GetId() == rhs_office.GetId());
+            CHECK(lhs_office.GetPosition().x == rhs_office.GetPosition().x);
+            CHECK(lhs_office.GetPosition().y == rhs_office.GetPosition().y);
+            CHECK(lhs_office.GetOffset().dx == rhs_office.GetOffset().dx);
+            CHECK(lhs_office.GetOffset().dy == rhs_office.GetOffset().dy);
+        }
+        REQUIRE(lhs_map.GetLoot());
+        REQUIRE(rhs_map.GetLoot());
+        CHECK(lhs_map.GetLoot()->GetSettings().period == rhs_map.GetLoot()->GetSettings().period);
+        CHECK(lhs_map.GetLoot()->GetSettings().probability == rhs_map.GetLoot()->GetSettings().probability);
+        CHECK(lhs_map.GetLoot()->GetLootTypesCount() == rhs_map.GetLoot()->GetLootTypesCount());
+        CHECK(lhs_map.GetLoot()->GetValues() == rhs_map.GetLoot()->GetValues());
+        const auto lhs_loot_types = lhs_payload.map_id_loot_types.find(lhs_map.GetId());
+        const auto rhs_loot_types = rhs_payload.map_id_loot_types.find(rhs_map.GetId());
+        REQUIRE((lhs_loot_types == lhs_payload.map_id_loot_types.end()) == (rhs_loot_types == rhs_payload.map_id_loot_types.end()));
+        if (lhs_loot_types != lhs_payload.map_id_loot_types.end()) {
+            CHECK(boost::json::serialize(lhs_loot_types->second) == boost::json::serialize(rhs_loot_types->second));
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Streaming config parser builds the same game as the DOM one") {
+    SECTION("the shipped config") {
+        const auto config = ReadConfig();
+        extra_data::Payload payload;
+        const auto game = json_loader::ParseGame(config, payload);
+        extra_data::Payload document_payload;
+        const auto document_game = json_loader::ParseGameDocument(config, document_payload);
+        CHECK(game.GetMaps().size() == 3);
+        CheckSameGame(game, payload, document_game, document_payload);
+    }
+
+    SECTION("defaults after the maps and values the game does not use") {
+        const auto config = R"({
+            "maps": [{
+                "offices": [{"id": "o0", "x": 40, "y": 30, "offsetX": 5, "offsetY": 0, "note": [1, {"x": "a"}]}],
+                "id": "map1",
+                "roads": [{"x0": 0, "y0": 0, "x1": 40, "label": null}, {"x0": 40, "y0": 0, "y1": 30}],
+                "unknown": {"roads": "none", "id": 5, "nested": [[], {}]},
+                "name": "Map \"1\"",
+                "buildings": [{"x": 5, "y": 5, "w": 30, "h": 20}],
+                "lootTypes": [{"name": "key", "value": 10, "scale": 0.03, "tags": [true, null]}, {"name": "wallet", "value": 30}],
+                "bagCapacity": 5
+            }],
+            "extra": {"maps": [1, 2], "defaultDogSpeed": "fast"},
+            "defaultBagCapacity": 3,
+            "lootGeneratorConfig": {"probability": 0.5, "period": 5.0},
+            "defaultDogSpeed": 2.5
+        })"s;
+        extra_data::Payload payload;
+        const auto game = json_loader::ParseGame(config, payload);
+        extra_data::Payload document_payload;
+        const auto document_game = json_loader::ParseGameDocument(config, document_payload);
+        REQUIRE(game.GetMaps().size() == 1);
+        const auto& map = *game.GetMaps().front();
+        CHECK(map.GetName() == "Map \"1\""s);
+        CHECK(map.GetDogSpeed() == 2.5);
+        CHECK(map.GetBagCapacity() == 5);
+        CHECK(*map.GetOffices().front().GetId() == "o0"s);
+        CHECK(map.GetLoot()->GetValues() == std::vector<unsigned>{10, 30});
+        CheckSameGame(game, payload, document_game, document_payload);
+    }
+
+    SECTION("no loot settings, loot types or bag capacity") {
+        const auto config = R"({"maps": [{"id": "map1", "name": "Map 1", "roads": [{"x0": 0, "y0": 0, "x1": 40}], "buildings": [], "offices": []}]})"s;
+        extra_data::Payload payload;
+        const auto game = json_loader::ParseGame(config, payload);
+        extra_data::Payload document_payload;
+        const auto document_game = json_loader::ParseGameDocument(config, document_payload);
+        REQUIRE(game.GetMaps().size() == 1);
+        const auto& map = *game.GetMaps().front();
+        CHECK(map.GetDogSpeed() == 1.);
+        CHECK(map.GetBagCapacity() == 0);
+        CHECK(map.GetLoot()->GetSettings().period == 0.);
+        CHECK(map.GetLoot()->GetLootTypesCount() == 0);
+        CHECK(payload.map_id_loot_types.empty());
+        CheckSameGame(game, payload, document_game, document_payload);
+    }
+}
+
+TEST_CASE("Streaming config parser rejects malformed configs") {
+    extra_data::Payload payload;
+    const auto map = [](const std::string& fields) {
+        return R"({"maps": [{"id": "m", "name": "M", )"s + fields + "}]}"s;
+    };
+    const std::string valid_fields = R"("roads": [{"x0": 0, "y0": 0, "x1": 10}], "buildings": [], "offices": [])"s;
+    REQUIRE_NOTHROW(json_loader::ParseGame(map(valid_fields), payload));
+
+    for (const auto& config : {
+             "[]"s,
+             "{}"s,
+             R"({"maps": {}})"s,
+             R"({"maps": [1]})"s,
+             R"({"maps": [{"id": "m", "name": "M"}]})"s,
+             map(R"("roads": [{"x0": 0, "x1": 10}], "buildings": [], "offices": [])"s),
+             map(R"("roads": [{"x0": 0, "y0": 0}], "buildings": [], "offices": [])"s),
+             map(R"("roads": [{"x0": "0", "y0": 0, "x1": 10}], "buildings": [], "offices": [])"s),
+             map(R"("roads": [3], "buildings": [], "offices": [])"s),
+             map(valid_fields + R"(, "lootTypes": {})"s),
+             map(R"("roads": [], "buildings": [], "offices": [{"x": 0, "y": 0, "offsetX": 0, "offsetY": 0}])"s),
+             map(valid_fields) + " {}"s,
+             map(valid_fields).substr(1)}) {
+        extra_data::Payload rejected_payload;
+        CHECK_THROWS_AS(json_loader::ParseGame(config, rejected_payload), std::runtime_error);
+    }
+}
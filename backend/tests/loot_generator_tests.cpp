@@ -58,17 +58,16 @@ SCENARIO("Loot generation") {
         }
     }
 
-    GIVEN("a loot generator with custom random generator") {
-        LootGenerator gen{1s, 0.5, [] {
-                              return 0.5;
-                          }};
+    GIVEN("a loot generator with a random engine") {
+        util::RandomEngine engine{7};
+        LootGenerator gen{1s, 0.5, &engine};
         WHEN("loot is generated") {
             THEN("number of loot is proportional to random generated values") {
-                const auto time_interval
-                    = std::chrono::duration_cast<TimeInterval>(std::chrono::duration<double>{
-                        1.0 / (std::log(1 - 0.5) / std::log(1.0 - 0.25))});
-                CHECK(gen.Generate(time_interval, 0, 4) == 0);
-                CHECK(gen.Generate(time_interval, 0, 4) == 1);
+                util::RandomEngine expected_engine{7};
+                const double probability = 1.0 - std::pow(1.0 - 0.5, 2.0);
+                const auto expected = static_cast<unsigned>(std::round(4 * probability * expected_engine.NextDouble()));
+                CHECK(gen.Generate(2s, 0, 4) == expected);
+                CHECK(engine.GetState() == expected_engine.GetState());
             }
         }
     }
@@ -0,0 +1,136 @@
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/loader/json_loader.h"
+#include "../src/loader/map_cache.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct TempConfig {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "map_cache_tests";
+    std::filesystem::path path = directory / "config.json";
+
+    TempConfig() {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        std::filesystem::copy_file("./data/config.json", path);
+    }
+
+    ~TempConfig() {
+        std::filesystem::remove_all(directory);
+    }
+};
+
+void CheckSamePoints(const std::vector<model::RoadJunctions::LinePoint>& lhs,
+                     const std::vector<model::RoadJunctions::LinePoint>& rhs) {
+    REQUIRE(lhs.size() == rhs.size());
+    for (std::size_t i = 0; i != lhs.size(); ++i) {
+        CHECK(lhs[i].fixed == rhs[i].fixed);
+        CHECK(lhs[i].along == rhs[i].along);
+        CHECK(lhs[i].road == rhs[i].road);
+    }
+}
+
+void CheckSameMaps(const model::Game& lhs, const extra_data::Payload& lhs_payload,
+                   const model::Game& rhs, const extra_data::Payload& rhs_payload) {
+    REQUIRE(lhs.GetMaps().size() == rhs.GetMaps().size());
+    for (std::size_t i = 0; i != lhs.GetMaps().size(); ++i) {
+        const auto& lhs_map = *lhs.GetMaps()[i];
+        const auto& rhs_map = *rhs.GetMaps()[i];
+        CHECK(lhs_map.GetId() == rhs_map.GetId());
+        CHECK(lhs_map.GetName() == rhs_map.GetName());
+        CHECK(lhs_map.GetDogSpeed() == rhs_map.GetDogSpeed());
+        CHECK(lhs_map.GetBagCapacity() == rhs_map.GetBagCapacity());
+        REQUIRE(lhs_map.GetRoads().size() == rhs_map.GetRoads().size());
+        for (std::size_t j = 0; j != lhs_map.GetRoads().size(); ++j) {
+            const auto& lhs_road = lhs_map.GetRoads()[j];
+            const auto& rhs_road = rhs_map.GetRoads()[j];
+            CHECK(lhs_road.GetStart().x == rhs_road.GetStart().x);
+            CHECK(lhs_road.GetStart().y == rhs_road.GetStart().y);
+            CHECK(lhs_road.GetEnd().x == rhs_road.GetEnd().x);
+            CHECK(lhs_road.GetEnd().y == rhs_road.GetEnd().y);
+        }
+        CHECK(lhs_map.GetRoadSampler().GetProbabilities() == rhs_map.GetRoadSampler().GetProbabilities());
+        CHECK(lhs_map.GetRoadSampler().GetAliases() == rhs_map.GetRoadSampler().GetAliases());
+        REQUIRE(lhs_map.GetCompactRoads().size() == rhs_map.GetCompactRoads().size());
+        const auto& lhs_junctions = lhs_map.GetJunctions().GetIndex();
+        const auto& rhs_junctions = rhs_map.GetJunctions().GetIndex();
+        CheckSamePoints(lhs_junctions.crossings[0], rhs_junctions.crossings[0]);
+        CheckSamePoints(lhs_junctions.crossings[1], rhs_junctions.crossings[1]);
+        CheckSamePoints(lhs_junctions.starts, rhs_junctions.starts);
+        CheckSamePoints(lhs_junctions.ends, rhs_junctions.ends);
+        CheckSamePoints(lhs_junctions.vertical_lines, rhs_junctions.vertical_lines);
+        CHECK(lhs_map.GetBuildings().size() == rhs_map.GetBuildings().size());
+        REQUIRE(lhs_map.GetOffices().size() == rhs_map.GetOffices().size());
+        for (std::size_t j = 0; j != lhs_map.GetOffices().size(); ++j) {
+            CHECK(lhs_map.GetOffices()[j].GetId() == rhs_map.GetOffices()[j].GetId());
+            CHECK(lhs_map.GetOffices()[j].GetPosition().x == rhs_map.GetOffices()[j].GetPosition().x);
+            CHECK(lhs_map.GetOffices()[j].GetPosition().y == rhs_map.GetOffices()[j].GetPosition().y);
+        }
+        REQUIRE(lhs_map.GetLoot());
+        REQUIRE(rhs_map.GetLoot());
+        CHECK(lhs_map.GetLoot()->GetLootTypesCount() == rhs_map.GetLoot()->GetLootTypesCount());
+        CHECK(lhs_map.GetLoot()->GetValues() == rhs_map.GetLoot()->GetValues());
+        CHECK(boost::json::serialize(lhs_payload.map_id_loot_types.at(lhs_map.GetId()))
+              == boost::json::serialize(rhs_payload.map_id_loot_types.at(rhs_map.GetId())));
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Map cache is used while the config is unchanged") {
+    TempConfig config;
+    int errors = 0;
+    auto count_errors = [&errors](const std::exception&) {
+        ++errors;
+    };
+
+    extra_data::Payload parsed_payload;
+    const auto parsed = json_loader::LoadGame(config.path, parsed_payload);
+    extra_data::Payload first_payload;
+    json_loader::LoadGameWithCache(config.path, first_payload, count_errors);
+    const auto cache_path = json_loader::GetMapCachePath(config.path);
+    REQUIRE(std::filesystem::exists(cache_path));
+
+    extra_data::Payload cached_payload;
+    const auto cached = json_loader::LoadGameWithCache(config.path, cached_payload, count_errors);
+    CheckSameMaps(parsed, parsed_payload, cached, cached_payload);
+    CHECK(errors == 0);
+
+    SECTION("a changed config is parsed again") {
+        std::ofstream{config.path, std::ios::app} << ' ';
+        extra_data::Payload payload;
+        const auto file = json_loader::MapFile(config.path);
+        const auto hash = json_loader::HashConfig({file.data(), file.size()});
+        CHECK_FALSE(json_loader::LoadMapCache(cache_path, hash, payload));
+        json_loader::LoadGameWithCache(config.path, payload, count_errors);
+        CHECK(json_loader::LoadMapCache(cache_path, hash, payload));
+        CHECK(errors == 0);
+    }
+
+    SECTION("a damaged cache is reported and replaced") {
+        std::filesystem::resize_file(cache_path, std::filesystem::file_size(cache_path) - 1);
+        extra_data::Payload payload;
+        const auto game = json_loader::LoadGameWithCache(config.path, payload, count_errors);
+        CHECK(errors == 1);
+        CheckSameMaps(parsed, parsed_payload, game, payload);
+        json_loader::LoadGameWithCache(config.path, payload, count_errors);
+        CHECK(errors == 1);
+    }
+}
+
+TEST_CASE("Config hash tells apart contents with the same bytes in other places") {
+    const auto content = R"({"id": "abcdefghijklmnop"})"s;
+    auto swapped = content;
+    std::swap(swapped[7], swapped[15]);
+    REQUIRE(swapped != content);
+    CHECK(json_loader::HashConfig(swapped) != json_loader::HashConfig(content));
+    CHECK(json_loader::HashConfig(content + ' ') != json_loader::HashConfig(content));
+    CHECK(json_loader::HashConfig(content) == json_loader::HashConfig(content));
+}
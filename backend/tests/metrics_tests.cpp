@@ -0,0 +1,48 @@
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/metrics/metrics.h"
+
+using namespace std::literals;
+
+TEST_CASE("Request targets are reduced to endpoint labels") {
+    using metrics::Endpoint;
+    CHECK(metrics::GetEndpoint("/api/v1/maps"sv) == Endpoint::MAPS);
+    CHECK(metrics::GetEndpoint("/api/v1/maps/map1"sv) == Endpoint::MAP_BY_ID);
+    CHECK(metrics::GetEndpoint("/api/v1/game/state?x=1"sv) == Endpoint::GAME_STATE);
+    CHECK(metrics::GetEndpoint("/api/v1/game/player/actions"sv) == Endpoint::PLAYER_ACTIONS);
+    CHECK(metrics::GetEndpoint("/metrics"sv) == Endpoint::METRICS);
+    CHECK(metrics::GetEndpoint("/api/v2/unknown"sv) == Endpoint::API_OTHER);
+    CHECK(metrics::GetEndpoint("/index.html"sv) == Endpoint::STATIC);
+    CHECK(metrics::GetEndpointLabel(Endpoint::MAP_BY_ID) == "/api/v1/maps/{id}"sv);
+}
+
+TEST_CASE("Registry serializes metrics in text exposition format") {
+    metrics::Registry registry;
+    registry.RecordRequest(metrics::Endpoint::GAME_STATE, 200, {20us, 50us, 10us});
+    registry.RecordRequest(metrics::Endpoint::GAME_STATE, 401, {2000us, 990us, 10us});
+    registry.RecordTick(std::chrono::microseconds{700});
+    registry.SetGameState(2, 5, 7);
+    registry.AddConnections(3);
+    registry.AddConnections(-1);
+
+    CHECK(registry.GetRequestCount(metrics::Endpoint::GAME_STATE) == 2);
+    CHECK(registry.GetConnections() == 2);
+
+    const auto text = registry.Serialize();
+    CHECK(text.find("# TYPE game_server_requests_total counter\n"s) != std::string::npos);
+    CHECK(text.find("game_server_requests_total{endpoint=\"/api/v1/game/state\"} 2\n"s) != std::string::npos);
+    CHECK(text.find("game_server_request_errors_total{endpoint=\"/api/v1/game/state\",class=\"4xx\"} 1\n"s) != std::string::npos);
+    CHECK(text.find("game_server_request_duration_microseconds_bucket{endpoint=\"/api/v1/game/state\",le=\"100\"} 1\n"s) != std::string::npos);
+    CHECK(text.find("game_server_request_duration_microseconds_bucket{endpoint=\"/api/v1/game/state\",le=\"+Inf\"} 2\n"s) != std::string::npos);
+    CHECK(text.find("game_server_request_duration_microseconds_sum{endpoint=\"/api/v1/game/state\"} 3080\n"s) != std::string::npos);
+    CHECK(text.find("game_server_request_phase_duration_microseconds_sum{endpoint=\"/api/v1/game/state\",phase=\"queue\"} 2020\n"s) != std::string::npos);
+    CHECK(text.find("game_server_request_phase_duration_microseconds_sum{endpoint=\"/api/v1/game/state\",phase=\"handler\"} 1040\n"s) != std::string::npos);
+    CHECK(text.find("game_server_request_phase_duration_microseconds_bucket{endpoint=\"/api/v1/game/state\",phase=\"write\",le=\"50\"} 2\n"s) != std::string::npos);
+    CHECK(text.find("game_server_tick_duration_microseconds_count 1\n"s) != std::string::npos);
+    CHECK(text.find("game_server_game_sessions 2\n"s) != std::string::npos);
+    CHECK(text.find("game_server_dogs 5\n"s) != std::string::npos);
+    CHECK(text.find("game_server_lost_objects 7\n"s) != std::string::npos);
+    CHECK(text.find("game_server_connections 2\n"s) != std::string::npos);
+}
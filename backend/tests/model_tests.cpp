@@ -1,3 +1,6 @@
+#include <tuple>
+#include <type_traits>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include "../src/util/geom.h"
@@ -107,6 +110,64 @@ TEST_CASE("Loot creation and functionality") {
     CHECK(loot.GetLostObjects()[0]->GetPosition() == geom::Point2D{5.0, 5.0});
 }
 
+TEST_CASE("Loot generation accumulates time between ticks") {
+    GeneratorSettings settings{0.001, 0.5}; // The base interval of the generator is 1 sec
+    Loot loot{settings, 1, {10}};
+
+    // 100 ms is too short to spawn anything for 4 looters, but the time is kept for the next tick
+    CHECK(loot.GetLootCount(100ms, 4) == 0);
+    CHECK(loot.GetTimeWithoutLoot() == 100ms);
+    CHECK(loot.GetLootCount(100ms, 4) == 1);
+    CHECK(loot.GetTimeWithoutLoot() == 0ms);
+
+    // Lost objects already on the map reduce the shortage
+    for (int i = 0; i != 4; ++i) {
+        loot.AddLostObject(0, {0.0, 0.0});
+    }
+    CHECK(loot.GetLootCount(10s, 4) == 0);
+
+    loot.SetTimeWithoutLoot(300ms);
+    CHECK(loot.GetTimeWithoutLoot() == 300ms);
+}
+
+TEST_CASE("Loot generation spawns with the full probability of the settings") {
+    GeneratorSettings settings{0.001, 0.5};
+    Loot loot{settings, 1, {10}};
+
+    // 1 - 0.5^10 of the shortage of 4 rounds to 4, a random factor would cut it
+    CHECK(loot.GetLootCount(10s, 4) == 4);
+}
+
+TEST_CASE("Seeded game sessions spawn the same loot") {
+    auto spawn_loot = [](std::uint64_t seed) {
+        Game game;
+        game.SetRandomSeed(seed);
+        Map map{Map::Id{"map1"}, "Map", 1.0, 3};
+        map.AddRoads({Road(Road::Direction::HORIZONTAL, {0, 0}, 40), Road(Road::Direction::VERTICAL, {40, 0}, 30)});
+        map.AddLoot({0.001, 0.5}, 3, {10, 20, 30});
+        game.AddMap(std::move(map));
+        auto session = game.AddGameSession(game.FindMap(Map::Id{"map1"}));
+        for (int i = 0; i != 10; ++i) {
+            session->AddDog("Dog", {0.0, 0.0}, 0);
+        }
+
+        std::vector<std::tuple<std::size_t, unsigned int, double, double>> spawned;
+        for (int tick = 0; tick != 50; ++tick) {
+            session->UpdateGameState(1000);
+            const auto& objects = session->GetLoot()->GetLostObjects();
+            for (std::size_t i = spawned.size(); i < objects.size(); ++i) {
+                spawned.emplace_back(tick, objects[i]->GetType(), objects[i]->GetPosition().x, objects[i]->GetPosition().y);
+            }
+        }
+        return spawned;
+    };
+
+    const auto spawned = spawn_loot(42u);
+    CHECK_FALSE(spawned.empty());
+    CHECK(spawn_loot(42u) == spawned);
+    CHECK(spawn_loot(43u) != spawned);
+}
+
 TEST_CASE("Map creation and accessors") {
     Map::Id mapId{"map1"};
     Map map{mapId, "Test Map", 2.5, 10};
@@ -204,10 +265,10 @@ TEST_CASE("Dog score management") {
 
 TEST_CASE("GameSession creation and dog management") {
     Map::Id mapId{"map1"};
-    Map map{mapId, "First Map", 2.5, 10};
+    auto map = std::make_shared<const Map>(mapId, "First Map", 2.5, 10);
     GameSession session{map};
 
-    CHECK(session.GetMap() == &map);
+    CHECK(session.GetMap() == map.get());
     CHECK(session.GetDogs().size() == 0);
 
     auto dog = session.AddDog("Charlie", {0.0, 0.0}, 0);
@@ -217,8 +278,7 @@ TEST_CASE("GameSession creation and dog management") {
 
 TEST_CASE("GameSession setting dogs") {
     Map::Id mapId{"map2"};
-    Map map{mapId, "Second Map", 3.0, 15};
-    GameSession session{map};
+    GameSession session{std::make_shared<const Map>(mapId, "Second Map", 3.0, 15)};
 
     auto dog1 = session.AddDog("Dog1", {0.0, 0.0}, 0);
     auto dog2 = session.AddDog("Dog2", {1.0, 1.0}, 1);
@@ -237,13 +297,12 @@ TEST_CASE("Game creation and session management") {
     Game game;
 
     Map::Id mapId{"map3"};
-    Map map{mapId, "Third Map", 4.0, 20};
-    game.AddMap(map);
+    game.AddMap(Map{mapId, "Third Map", 4.0, 20});
 
     CHECK(game.GetMaps().size() == 1);
     CHECK(game.FindMap(mapId) != nullptr);
 
-    game.AddGameSession(&map);
+    game.AddGameSession(game.FindMap(mapId));
     CHECK(game.GetGameSessions().size() == 1);
     CHECK(game.FindGameSession(mapId) != nullptr);
 }
@@ -252,8 +311,220 @@ TEST_CASE("Game adding duplicate map throws exception") {
     Game game;
 
     Map::Id mapId{"map4"};
-    Map map{mapId, "Fourth Map", 5.0, 25};
-    game.AddMap(map);
+    game.AddMap(Map{mapId, "Fourth Map", 5.0, 25});
 
-    CHECK_THROWS_AS(game.AddMap(map), std::invalid_argument);
-}
\ No newline at end of file
+    CHECK_THROWS_AS(game.AddMap(Map{mapId, "Fourth Map", 5.0, 25}), std::invalid_argument);
+}
+
+TEST_CASE("Game sessions of one map are split by player limit") {
+    Game game;
+
+    Map::Id mapId{"map5"};
+    game.AddMap(Map{mapId, "Fifth Map", 1.0, 3});
+    const auto map_ptr = game.FindMap(mapId);
+    CHECK(game.FindVacantGameSession(mapId) == nullptr);
+
+    auto first = game.AddGameSession(map_ptr);
+    first->AddDog("Dog1", {0.0, 0.0}, 0);
+    CHECK(game.FindVacantGameSession(mapId) == first);
+
+    SECTION("a session with room is found") {
+        game.SetMaxSessionDogs(2);
+        CHECK(game.FindVacantGameSession(mapId) == first);
+        first->AddDog("Dog2", {0.0, 0.0}, 0);
+        CHECK(game.FindVacantGameSession(mapId) == nullptr);
+    }
+
+    SECTION("a new session is opened when the others are full") {
+        game.SetMaxSessionDogs(1);
+        CHECK(game.FindVacantGameSession(mapId) == nullptr);
+
+        auto second = game.AddGameSession(map_ptr);
+        CHECK(second->GetId() != first->GetId());
+        CHECK(second->GetMap() == first->GetMap());
+        CHECK(game.FindGameSession(first->GetId()) == first);
+        CHECK(game.FindGameSession(second->GetId()) == second);
+        CHECK(game.FindVacantGameSession(mapId) == second);
+        second->AddDog("Dog2", {0.0, 0.0}, 0);
+        CHECK(game.FindVacantGameSession(mapId) == nullptr);
+    }
+
+    CHECK_THROWS_AS(game.AddGameSession(map_ptr, first->GetId()), std::invalid_argument);
+}
+
+TEST_CASE("A session with a duplicate id leaves the indices untouched") {
+    Game game;
+    Map::Id mapId{"map10"};
+    Map::Id otherId{"map11"};
+    game.AddMap(Map{mapId, "Tenth Map", 1.0, 3});
+    game.AddMap(Map{otherId, "Eleventh Map", 1.0, 3});
+    auto first = game.AddGameSession(game.FindMap(mapId));
+
+    CHECK_THROWS_AS(game.AddGameSession(game.FindMap(otherId), first->GetId()), std::invalid_argument);
+    CHECK(game.GetGameSessions().size() == 1);
+    CHECK(game.FindGameSession(otherId) == nullptr);
+    CHECK(game.FindVacantGameSession(otherId) == nullptr);
+    CHECK(game.FindGameSession(mapId) == first);
+    CHECK(game.FindGameSession(first->GetId()) == first);
+
+    CHECK_THROWS_AS(game.AddGameSession(game.FindMap(mapId), first->GetId()), std::invalid_argument);
+    CHECK(game.FindVacantGameSession(mapId) == first);
+
+    auto other = game.AddGameSession(game.FindMap(otherId));
+    CHECK(game.FindGameSession(otherId) == other);
+    CHECK(game.FindVacantGameSession(otherId) == other);
+    CHECK(game.FindGameSession(other->GetId()) == other);
+}
+
+TEST_CASE("Full sessions are passed over once") {
+    Game game;
+    Map::Id mapId{"map9"};
+    game.AddMap(Map{mapId, "Ninth Map", 1.0, 3});
+    game.SetMaxSessionDogs(1);
+    const auto map_ptr = game.FindMap(mapId);
+
+    for (int i = 0; i != 100; ++i) {
+        game.AddGameSession(map_ptr)->AddDog("Dog", {0.0, 0.0}, 0);
+    }
+    CHECK(game.FindVacantGameSession(mapId) == nullptr);
+    auto vacant = game.AddGameSession(map_ptr);
+    CHECK(game.FindVacantGameSession(mapId) == vacant);
+    CHECK(game.FindVacantGameSession(mapId) == vacant);
+    vacant->AddDog("Dog", {0.0, 0.0}, 0);
+    CHECK(game.FindVacantGameSession(mapId) == nullptr);
+    CHECK(game.FindVacantGameSession(Map::Id{"missing"}) == nullptr);
+}
+
+TEST_CASE("Replaced maps are used by new sessions while old sessions keep theirs") {
+    Game game;
+    Map::Id mapId{"map7"};
+    Map::Id removedId{"map8"};
+    game.AddMap(Map{mapId, "Seventh Map", 1.0, 3});
+    game.AddMap(Map{removedId, "Eighth Map", 1.0, 3});
+    auto old_session = game.AddGameSession(game.FindMap(mapId));
+    std::weak_ptr<const Map> old_map = game.FindMap(mapId);
+    CHECK(game.GetMapsVersion() == 0);
+
+    Game::Maps duplicates{std::make_shared<const Map>(mapId, "New Map", 2.0, 3), std::make_shared<const Map>(mapId, "New Map", 2.0, 3)};
+    CHECK_THROWS_AS(game.ReplaceMaps(duplicates), std::invalid_argument);
+    CHECK(game.GetMapsVersion() == 0);
+    CHECK(game.FindMap(removedId) != nullptr);
+
+    game.ReplaceMaps({std::make_shared<const Map>(mapId, "New Map", 2.0, 3)});
+    CHECK(game.GetMapsVersion() == 1);
+    CHECK(game.GetMaps().size() == 1);
+    CHECK(game.FindMap(removedId) == nullptr);
+    REQUIRE(game.FindMap(mapId) != nullptr);
+    CHECK(game.FindMap(mapId)->GetName() == "New Map");
+
+    // The old session still plays on the old map, but new players go to a session on the new one
+    CHECK(old_session->GetMap()->GetName() == "Seventh Map");
+    CHECK(game.FindVacantGameSession(mapId) == nullptr);
+    CHECK(game.FindGameSession(mapId) == nullptr);
+    auto new_session = game.AddGameSession(game.FindMap(mapId));
+    CHECK(game.FindVacantGameSession(mapId) == new_session);
+    CHECK(game.FindGameSession(mapId) == new_session);
+    CHECK(game.FindGameSession(old_session->GetId()) == old_session);
+
+    // Sessions are never removed, so the old map lives as long as the game
+    CHECK_FALSE(old_map.expired());
+    old_session.reset();
+    game = Game{};
+    CHECK(old_map.expired());
+}
+
+TEST_CASE("Seeded game sessions generate the same random values") {
+    Map::Id mapId{"map6"};
+    auto make_map = [&mapId] {
+        Map map{mapId, "Sixth Map", 1.0, 3};
+        map.AddRoad(Road(Road::Direction::HORIZONTAL, {0, 0}, 40));
+        map.AddRoad(Road(Road::Direction::VERTICAL, {40, 0}, 30));
+        return map;
+    };
+
+    Game first_game;
+    first_game.SetRandomSeed(42u);
+    first_game.AddMap(make_map());
+    Game second_game;
+    second_game.SetRandomSeed(42u);
+    second_game.AddMap(make_map());
+
+    auto first = first_game.AddGameSession(first_game.FindMap(mapId));
+    auto second = second_game.AddGameSession(second_game.FindMap(mapId));
+    auto other = first_game.AddGameSession(first_game.FindMap(mapId));
+    CHECK(first->GetRandomEngine().GetState() == second->GetRandomEngine().GetState());
+    CHECK(first->GetRandomEngine().GetState() != other->GetRandomEngine().GetState());
+
+    const auto& roads = first->GetMap()->GetRoads();
+    for (int i = 0; i != 100; ++i) {
+        auto index = GetRandomIndex(roads.size(), first->GetRandomEngine());
+        CHECK(index == GetRandomIndex(roads.size(), second->GetRandomEngine()));
+        REQUIRE(index < roads.size());
+
+        auto pos = GetRandomPosition(roads[index], first->GetRandomEngine());
+        auto same_pos = GetRandomPosition(roads[index], second->GetRandomEngine());
+        CHECK(pos.x == same_pos.x);
+        CHECK(pos.y == same_pos.y);
+        CHECK(IsWithinRoadBounds(pos, roads[index]));
+
+        auto type = GetRandomType(2u, first->GetRandomEngine());
+        CHECK(type == GetRandomType(2u, second->GetRandomEngine()));
+        CHECK(type <= 2u);
+    }
+}
+
+TEST_CASE("Random roads are picked proportionally to their area") {
+    util::AliasTable table({1.0, 0.0, 3.0});
+    util::RandomEngine engine{7u};
+    std::vector<int> hits(table.size());
+    const int samples = 40000;
+    for (int i = 0; i != samples; ++i) {
+        ++hits.at(table.Sample(engine));
+    }
+    CHECK(hits[1] == 0);
+    CHECK(hits[0] > samples / 4 - samples / 50);
+    CHECK(hits[0] < samples / 4 + samples / 50);
+
+    Map map{Map::Id{"map7"}, "Seventh Map", 1.0, 3};
+    CHECK_THROWS_AS(map.GetRandomRoadIndex(engine), std::out_of_range);
+
+    // Areas are 100.8 * 0.8 and 0.8 * 0.8
+    map.AddRoads({Road(Road::Direction::HORIZONTAL, {0, 0}, 100), Road(Road::Direction::VERTICAL, {0, 5}, 5)});
+    CHECK_THROWS_AS(map.GetRandomRoadIndex(engine), std::logic_error);
+    map.FinalizeRoads();
+    int short_road_hits = 0;
+    for (int i = 0; i != samples; ++i) {
+        short_road_hits += map.GetRandomRoadIndex(engine) == 1 ? 1 : 0;
+    }
+    CHECK(short_road_hits > 0);
+    CHECK(short_road_hits < samples / 50);
+
+    // Roads added one by one get the same sampler, built once
+    Map same_map{Map::Id{"map8"}, "Eighth Map", 1.0, 3};
+    same_map.AddRoad(Road(Road::Direction::HORIZONTAL, {0, 0}, 100));
+    same_map.AddRoad(Road(Road::Direction::VERTICAL, {0, 5}, 5));
+    same_map.FinalizeRoads();
+    CHECK(same_map.GetRoadSampler().GetProbabilities() == map.GetRoadSampler().GetProbabilities());
+    CHECK(same_map.GetRoadSampler().GetAliases() == map.GetRoadSampler().GetAliases());
+}
+
+TEST_CASE("Maps and games are moved, never copied") {
+    STATIC_REQUIRE_FALSE(std::is_copy_constructible_v<Map>);
+    STATIC_REQUIRE(std::is_nothrow_move_constructible_v<Map>);
+    STATIC_REQUIRE_FALSE(std::is_copy_constructible_v<Game>);
+
+    Game game;
+    game.AddMap(Map{Map::Id{"map9"}, "Ninth Map", 1.0, 3});
+    const Map* map = game.FindMap(Map::Id{"map9"}).get();
+    auto session = game.AddGameSession(game.FindMap(Map::Id{"map9"}));
+    for (int i = 0; i != 100; ++i) {
+        game.AddMap(Map{Map::Id{"extra" + std::to_string(i)}, "Extra Map", 1.0, 3});
+    }
+    // Maps added later don't move the ones sessions already play on
+    CHECK(session->GetMap() == map);
+    CHECK(game.FindMap(Map::Id{"map9"}).get() == map);
+
+    Game moved{std::move(game)};
+    CHECK(moved.FindMap(Map::Id{"map9"}).get() == map);
+    CHECK(moved.GetGameSessions().front() == session);
+}
@@ -0,0 +1,409 @@
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/model/model.h"
+#include "../src/util/random.h"
+
+using namespace model;
+
+namespace {
+
+// Movement as it was implemented over Road, the compact roads must move dogs exactly the same way
+namespace legacy {
+
+void MoveWest(Dog& dog, const Map::Roads& roads, int delta) {
+    double new_x, new_y;
+    const double second = 1000.;
+    new_x = dog.GetPosition().x + dog.GetSpeed().x * (delta / second);
+    new_y = dog.GetPosition().y;
+    geom::Point2D new_pos{new_x, new_y};
+
+    const auto& current_road = roads.at(dog.GetCurrentRoadsIndex());
+    if (IsWithinRoadBounds(new_pos, current_road)) {
+        dog.SetPosition({new_pos.x, new_pos.y});
+        return;
+    }
+    for (std::size_t i = 0; i != roads.size(); ++i) {
+        if (current_road.IsVertical() && roads[i].IsHorizontal() &&
+            new_pos.y >= roads[i].GetMin().y && new_pos.y <= roads[i].GetMax().y) {
+            if (current_road.GetStart().x <= roads[i].GetEnd().x && current_road.GetStart().x >= roads[i].GetStart().x) {
+                if (new_pos.x < current_road.GetMin().x) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            } else if (current_road.GetStart().x <= roads[i].GetStart().x && current_road.GetStart().x >= roads[i].GetEnd().x) {
+                if (new_pos.x < current_road.GetMin().x) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            }
+        } else if (current_road.IsHorizontal() && roads[i].IsHorizontal() &&
+                   new_pos.y >= roads[i].GetMin().y && new_pos.y <= roads[i].GetMax().y) {
+            if (current_road.GetStart().x == roads[i].GetEnd().x || current_road.GetEnd().x == roads[i].GetStart().x) {
+                if (new_pos.x < current_road.GetMin().x) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            }
+        }
+    }
+    std::size_t ci = dog.GetCurrentRoadsIndex();
+    if (new_pos.x < roads.at(ci).GetMin().x) {
+        new_x = roads.at(ci).GetMin().x;
+        dog.SetSpeed({0.0, 0.0});
+    }
+    dog.SetPosition({new_x, new_y});
+}
+
+void MoveEast(Dog& dog, const Map::Roads& roads, int delta) {
+    double new_x, new_y;
+    const double second = 1000.;
+    new_x = dog.GetPosition().x + dog.GetSpeed().x * (delta / second);
+    new_y = dog.GetPosition().y;
+    geom::Point2D new_pos{new_x, new_y};
+
+    const auto& current_road = roads.at(dog.GetCurrentRoadsIndex());
+    if (IsWithinRoadBounds(new_pos, current_road)) {
+        dog.SetPosition({new_pos.x, new_pos.y});
+        return;
+    }
+    for (std::size_t i = 0; i != roads.size(); ++i) {
+        if (current_road.IsVertical() && roads[i].IsHorizontal() &&
+            new_pos.y >= roads[i].GetMin().y && new_pos.y <= roads[i].GetMax().y) {
+            if (current_road.GetStart().x <= roads[i].GetEnd().x && current_road.GetStart().x >= roads[i].GetStart().x) {
+                if (new_pos.x > current_road.GetMax().x) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            } else if (current_road.GetStart().x <= roads[i].GetStart().x && current_road.GetStart().x >= roads[i].GetEnd().x) {
+                if (new_pos.x > current_road.GetMax().x) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            }
+        } else if (current_road.IsHorizontal() && roads[i].IsHorizontal() &&
+                   new_pos.y >= roads[i].GetMin().y && new_pos.y <= roads[i].GetMax().y) {
+            if (current_road.GetStart().x == roads[i].GetEnd().x || current_road.GetEnd().x == roads[i].GetStart().x) {
+                if (new_pos.x > current_road.GetMax().x) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            }
+        }
+    }
+    std::size_t ci = dog.GetCurrentRoadsIndex();
+    if (new_pos.x > roads.at(ci).GetMax().x) {
+        new_x = roads.at(ci).GetMax().x;
+        dog.SetSpeed({0.0, 0.0});
+    }
+    dog.SetPosition({new_x, new_y});
+}
+
+void MoveNorth(Dog& dog, const Map::Roads& roads, int delta) {
+    double new_x, new_y;
+    const double second = 1000.;
+    new_x = dog.GetPosition().x;
+    new_y = dog.GetPosition().y + dog.GetSpeed().y * (delta / second);
+    geom::Point2D new_pos{new_x, new_y};
+
+    const auto& current_road = roads.at(dog.GetCurrentRoadsIndex());
+    if (IsWithinRoadBounds(new_pos, current_road)) {
+        dog.SetPosition({new_pos.x, new_pos.y});
+        return;
+    }
+    for (std::size_t i = 0; i != roads.size(); ++i) {
+        if (current_road.IsHorizontal() && roads[i].IsVertical() &&
+            new_pos.x >= roads[i].GetMin().x && new_pos.x <= roads[i].GetMax().x) {
+            if (current_road.GetStart().y <= roads[i].GetEnd().y && current_road.GetStart().y >= roads[i].GetStart().y) {
+                if (new_pos.y < current_road.GetMin().y) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            } else if (current_road.GetStart().y <= roads[i].GetStart().y && current_road.GetStart().y >= roads[i].GetEnd().y) {
+                if (new_pos.y < current_road.GetMin().y) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            }
+        } else if (current_road.IsVertical() && roads[i].IsVertical() &&
+                   new_pos.x >= roads[i].GetMin().x && new_pos.x <= roads[i].GetMax().x) {
+            if (current_road.GetStart().x == roads[i].GetEnd().x || current_road.GetEnd().x == roads[i].GetStart().x) {
+                if (new_pos.y < current_road.GetMin().y) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            }
+        }
+    }
+    std::size_t ci = dog.GetCurrentRoadsIndex();
+    if (new_pos.y < roads.at(ci).GetMin().y) {
+        new_y = roads.at(ci).GetMin().y;
+        dog.SetSpeed({0.0, 0.0});
+    }
+    dog.SetPosition({new_x, new_y});
+}
+
+void MoveSouth(Dog& dog, const Map::Roads& roads, int delta) {
+    double new_x, new_y;
+    const double second = 1000.;
+    new_x = dog.GetPosition().x;
+    new_y = dog.GetPosition().y + dog.GetSpeed().y * (delta / second);
+    geom::Point2D new_pos{new_x, new_y};
+
+    const auto& current_road = roads.at(dog.GetCurrentRoadsIndex());
+    if (IsWithinRoadBounds(new_pos, current_road)) {
+        dog.SetPosition({new_pos.x, new_pos.y});
+        return;
+    }
+    for (std::size_t i = 0; i != roads.size(); ++i) {
+        if (current_road.IsHorizontal() && roads[i].IsVertical() &&
+            new_pos.x >= roads[i].GetMin().x && new_pos.x <= roads[i].GetMax().x) {
+            if (current_road.GetStart().y <= roads[i].GetEnd().y && current_road.GetStart().y >= roads[i].GetStart().y) {
+                if (new_pos.y > current_road.GetMax().y) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            } else if (current_road.GetStart().y <= roads[i].GetStart().y && current_road.GetStart().y >= roads[i].GetEnd().y) {
+                if (new_pos.y > current_road.GetMax().y) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            }
+        } else if (current_road.IsVertical() && roads[i].IsVertical() &&
+                   new_pos.x >= roads[i].GetMin().x && new_pos.x <= roads[i].GetMax().x) {
+            if (current_road.GetStart().x == roads[i].GetEnd().x || current_road.GetEnd().x == roads[i].GetStart().x) {
+                if (new_pos.y > current_road.GetMax().y) {
+                    dog.SetCurrentRoadsIndex(i);
+                }
+            }
+        }
+    }
+    std::size_t ci = dog.GetCurrentRoadsIndex();
+    if (new_pos.y > roads.at(ci).GetMax().y) {
+        new_y = roads.at(ci).GetMax().y;
+        dog.SetSpeed({0.0, 0.0});
+    }
+    dog.SetPosition({new_x, new_y});
+}
+
+}  // namespace legacy
+
+// Road that a dog turned to when every road of the map was checked
+std::optional<std::size_t> ScanTurn(const Map::CompactRoads& roads, std::size_t from, bool horizontal_move, double across) {
+    const auto may_turn = [&current = roads[from]](const CompactRoad& to) {
+        if (current.horizontal != to.horizontal) {
+            return (current.fixed <= to.end && current.fixed >= to.start) || (current.fixed <= to.start && current.fixed >= to.end);
+        }
+        if (current.horizontal) {
+            return current.start == to.end || current.end == to.start;
+        }
+        return current.fixed == 0 || to.fixed == 0;
+    };
+    std::optional<std::size_t> turn;
+    for (std::size_t i = 0; i != roads.size(); ++i) {
+        if (roads[i].horizontal == horizontal_move && may_turn(roads[i])
+            && !(across > roads[i].fixed + ROAD_HALF_WIDTH) && !(across < roads[i].fixed - ROAD_HALF_WIDTH)) {
+            turn = i;
+        }
+    }
+    return turn;
+}
+
+// Few distinct coordinates, so that roads often cross, continue each other and lie on x == 0
+Map MakeRandomMap(util::RandomEngine& engine, std::size_t road_count) {
+    Map map{Map::Id{"random"}, "Random", 1.0, 3};
+    Map::Roads roads;
+    for (std::size_t i = 0; i != road_count; ++i) {
+        const auto direction = engine.NextIndex(2) == 0 ? Road::Direction::HORIZONTAL : Road::Direction::VERTICAL;
+        const auto coord = [&engine] {
+            return static_cast<Coord>(engine.NextIndex(6)) * 5;
+        };
+        roads.emplace_back(direction, Point{coord(), coord()}, coord());
+    }
+    map.AddRoads(roads);
+    map.FinalizeRoads();
+    return map;
+}
+
+void Turn(Dog& dog, util::RandomEngine& engine) {
+    const double speed = engine.NextDouble(0.5, 20.0);
+    switch (engine.NextIndex(4)) {
+        case 0:
+            dog.SetDirection(Dog::Direction::WEST);
+            dog.SetSpeed({-speed, 0.0});
+            break;
+        case 1:
+            dog.SetDirection(Dog::Direction::EAST);
+            dog.SetSpeed({speed, 0.0});
+            break;
+        case 2:
+            dog.SetDirection(Dog::Direction::NORTH);
+            dog.SetSpeed({0.0, -speed});
+            break;
+        default:
+            dog.SetDirection(Dog::Direction::SOUTH);
+            dog.SetSpeed({0.0, speed});
+    }
+}
+
+void Move(Dog& dog, const Map& map, int delta) {
+    switch (dog.GetDirection()) {
+        case Dog::Direction::WEST:
+            dog.SetPositionWhenMovingWest(map, delta);
+            break;
+        case Dog::Direction::EAST:
+            dog.SetPositionWhenMovinggEast(map, delta);
+            break;
+        case Dog::Direction::NORTH:
+            dog.SetPositionWhenMovingNorth(map, delta);
+            break;
+        case Dog::Direction::SOUTH:
+            dog.SetPositionWhenMovingSouth(map, delta);
+            break;
+    }
+}
+
+void MoveLegacy(Dog& dog, const Map& map, int delta) {
+    switch (dog.GetDirection()) {
+        case Dog::Direction::WEST:
+            legacy::MoveWest(dog, map.GetRoads(), delta);
+            break;
+        case Dog::Direction::EAST:
+            legacy::MoveEast(dog, map.GetRoads(), delta);
+            break;
+        case Dog::Direction::NORTH:
+            legacy::MoveNorth(dog, map.GetRoads(), delta);
+            break;
+        case Dog::Direction::SOUTH:
+            legacy::MoveSouth(dog, map.GetRoads(), delta);
+            break;
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Compact roads have the bounds of their roads") {
+    util::RandomEngine engine{7};
+    const auto map = MakeRandomMap(engine, 200);
+    const auto& roads = map.GetRoads();
+    const auto& compact_roads = map.GetCompactRoads();
+    REQUIRE(compact_roads.size() == roads.size());
+    for (std::size_t i = 0; i != roads.size(); ++i) {
+        CHECK(compact_roads[i].GetMinX() == roads[i].GetMin().x);
+        CHECK(compact_roads[i].GetMaxX() == roads[i].GetMax().x);
+        CHECK(compact_roads[i].GetMinY() == roads[i].GetMin().y);
+        CHECK(compact_roads[i].GetMaxY() == roads[i].GetMax().y);
+        CHECK(compact_roads[i].horizontal == roads[i].IsHorizontal());
+    }
+    CHECK(alignof(CompactRoad) == 32);
+    CHECK(reinterpret_cast<std::uintptr_t>(compact_roads.data()) % alignof(CompactRoad) == 0);
+}
+
+TEST_CASE("Dogs move over compact roads as they did over roads") {
+    util::RandomEngine engine{42};
+    std::size_t road_changes = 0;
+    std::size_t stops = 0;
+    for (int map_index = 0; map_index != 50; ++map_index) {
+        const auto map = MakeRandomMap(engine, 2 + engine.NextIndex(40));
+        for (int dog_index = 0; dog_index != 20; ++dog_index) {
+            const auto road_index = map.GetRandomRoadIndex(engine);
+            const auto position = GetRandomPosition(map.GetRoads()[road_index], engine);
+            Dog dog{Dog::Id{0}, "dog", 3};
+            Dog legacy_dog{Dog::Id{0}, "dog", 3};
+            for (auto* d : {&dog, &legacy_dog}) {
+                d->SetPosition(position);
+                d->SetCurrentRoadsIndex(road_index);
+            }
+            for (int tick = 0; tick != 200; ++tick) {
+                if (tick % 10 == 0) {
+                    Turn(dog, engine);
+                    legacy_dog.SetDirection(dog.GetDirection());
+                    legacy_dog.SetSpeed(dog.GetSpeed());
+                }
+                const int delta = 1 + static_cast<int>(engine.NextIndex(300));
+                const auto previous_index = dog.GetCurrentRoadsIndex();
+                Move(dog, map, delta);
+                MoveLegacy(legacy_dog, map, delta);
+                REQUIRE(dog.GetPosition() == legacy_dog.GetPosition());
+                REQUIRE(dog.GetSpeed() == legacy_dog.GetSpeed());
+                REQUIRE(dog.GetCurrentRoadsIndex() == legacy_dog.GetCurrentRoadsIndex());
+                road_changes += dog.GetCurrentRoadsIndex() != previous_index ? 1 : 0;
+                stops += dog.GetSpeed() == geom::Vec2D{0.0, 0.0} ? 1 : 0;
+            }
+        }
+    }
+    // The maps are dense enough to exercise both the road changes and the stops at the edges
+    CHECK(road_changes > 1000);
+    CHECK(stops > 1000);
+}
+
+TEST_CASE("Turns are the ones found by checking every road of the map") {
+    util::RandomEngine engine{77};
+    for (int map_index = 0; map_index != 200; ++map_index) {
+        // Roads on a small grid of unit step, so that they overlap, touch and leave gaps on their lines
+        Map map{Map::Id{"random"}, "Random", 1.0, 3};
+        Map::Roads random_roads;
+        const auto road_count = engine.NextIndex(80);
+        for (std::size_t i = 0; i != road_count; ++i) {
+            const auto direction = engine.NextIndex(2) == 0 ? Road::Direction::HORIZONTAL : Road::Direction::VERTICAL;
+            const auto coord = [&engine] {
+                return static_cast<Coord>(engine.NextIndex(13)) - 2;
+            };
+            random_roads.emplace_back(direction, Point{coord(), coord()}, coord());
+        }
+        map.AddRoads(random_roads);
+        map.FinalizeRoads();
+
+        const auto& roads = map.GetCompactRoads();
+        for (std::size_t from = 0; from != roads.size(); ++from) {
+            for (const bool horizontal_move : {true, false}) {
+                for (int coord = -3; coord != 12; ++coord) {
+                    for (const double offset : {0.0, ROAD_HALF_WIDTH, -ROAD_HALF_WIDTH, 0.41, -0.41, 0.5, engine.NextDouble(-1., 1.)}) {
+                        const double across = coord + offset;
+                        const auto turn = map.GetJunctions().FindTurn(roads[from], horizontal_move, across);
+                        REQUIRE(turn == ScanTurn(roads, from, horizontal_move, across));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Roads added after the map is finalized are not turned to until it is finalized again") {
+    Map map{Map::Id{"map"}, "Map", 1.0, 3};
+    map.AddRoad(Road(Road::Direction::HORIZONTAL, {0, 0}, 10));
+    map.FinalizeRoads();
+    map.AddRoad(Road(Road::Direction::VERTICAL, {5, 0}, 10));
+    const auto& roads = map.GetCompactRoads();
+    CHECK_FALSE(map.GetJunctions().FindTurn(roads[0], false, 5.0));
+    CHECK(map.GetJunctions().FindTurn(roads[1], true, 0.0) == 0u);
+    map.FinalizeRoads();
+    CHECK(map.GetJunctions().FindTurn(roads[0], false, 5.0) == 1u);
+    CHECK(map.GetJunctions().FindTurn(roads[1], true, 0.0) == 0u);
+}
+
+TEST_CASE("Junctions give the road that the scan over all roads gave") {
+    util::RandomEngine engine{2024};
+    for (int map_index = 0; map_index != 50; ++map_index) {
+        const auto map = MakeRandomMap(engine, 1 + engine.NextIndex(60));
+        const auto& roads = map.GetRoads();
+        const auto& junctions = map.GetJunctions();
+        for (std::size_t from = 0; from != roads.size(); ++from) {
+            for (const bool horizontal_move : {true, false}) {
+                for (int probe = 0; probe != 20; ++probe) {
+                    // Coordinates on the edges of the roads as well as between them
+                    const double across = probe % 2 == 0
+                        ? static_cast<double>(engine.NextIndex(6) * 5) + (engine.NextIndex(2) == 0 ? -1. : 1.) * ROAD_HALF_WIDTH
+                        : engine.NextDouble(-2., 28.);
+                    // The dog is put beyond the edge in the direction of the move, as if it had just crossed it
+                    const auto& road = roads[from];
+                    const geom::Point2D pos = horizontal_move ? geom::Point2D{road.GetMin().x - 0.1, across}
+                                                              : geom::Point2D{across, road.GetMin().y - 0.1};
+                    Dog dog{Dog::Id{0}, "dog", 3};
+                    dog.SetPosition(pos);
+                    dog.SetCurrentRoadsIndex(from);
+                    dog.SetSpeed({0.0, 0.0});
+                    if (horizontal_move) {
+                        legacy::MoveWest(dog, roads, 0);
+                    } else {
+                        legacy::MoveNorth(dog, roads, 0);
+                    }
+                    const auto turn = junctions.FindTurn(map.GetCompactRoads()[from], horizontal_move, across);
+                    REQUIRE(turn.value_or(from) == dog.GetCurrentRoadsIndex());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/util/mpsc_queue.h"
+
+TEST_CASE("MpscQueue keeps order and rejects values when full") {
+    util::MpscQueue<int> queue{3};
+    CHECK(queue.GetCapacity() == 4);
+    CHECK_FALSE(queue.TryPop());
+
+    for (int i = 0; i != 4; ++i) {
+        CHECK(queue.TryPush(i));
+    }
+    CHECK_FALSE(queue.TryPush(4));
+
+    CHECK(queue.TryPop() == 0);
+    CHECK(queue.TryPush(4));
+    for (int i = 1; i != 5; ++i) {
+        CHECK(queue.TryPop() == i);
+    }
+    CHECK_FALSE(queue.TryPop());
+
+    CHECK_THROWS_AS(util::MpscQueue<int>{0}, std::invalid_argument);
+}
+
+TEST_CASE("MpscQueue is left as it was when making a value throws") {
+    struct Value {
+        explicit Value(int value)
+            : value{value} {
+            if (value < 0) {
+                throw std::invalid_argument("Negative value");
+            }
+        }
+
+        int value;
+    };
+
+    util::MpscQueue<Value> queue{2};
+    CHECK(queue.TryPush(1));
+    CHECK_THROWS_AS(queue.TryPush(-1), std::invalid_argument);
+    CHECK(queue.TryPush(2));
+    CHECK_FALSE(queue.TryPush(3));
+
+    // No slot was claimed for the value that failed, so the consumer gets the next values right away
+    CHECK(queue.TryPop()->value == 1);
+    CHECK(queue.TryPop()->value == 2);
+    CHECK_FALSE(queue.TryPop());
+}
+
+TEST_CASE("MpscQueue delivers every value pushed by concurrent producers once") {
+    constexpr int producers = 4;
+    constexpr int values_per_producer = 20000;
+    util::MpscQueue<int> queue{256};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p != producers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i != values_per_producer; ++i) {
+                while (!queue.TryPush(p * values_per_producer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> last_seen(producers, -1);
+    std::vector<int> received(producers, 0);
+    for (int total = 0; total != producers * values_per_producer;) {
+        auto value = queue.TryPop();
+        if (!value) {
+            std::this_thread::yield();
+            continue;
+        }
+        const int producer = *value / values_per_producer;
+        // Values of one producer come out in the order they were pushed
+        REQUIRE(*value % values_per_producer > last_seen[producer]);
+        last_seen[producer] = *value % values_per_producer;
+        ++received[producer];
+        ++total;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int p = 0; p != producers; ++p) {
+        CHECK(received[p] == values_per_producer);
+    }
+    CHECK_FALSE(queue.TryPop());
+}
@@ -0,0 +1,33 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/util/parallel_for.h"
+
+TEST_CASE("ParallelFor calls the function once for every index") {
+    for (const unsigned int threads : {1u, 4u}) {
+        std::vector<std::atomic<int>> calls(1000);
+        util::ParallelFor(calls.size(), [&calls](std::size_t i) {
+            calls[i].fetch_add(1);
+        }, threads);
+        for (const auto& count : calls) {
+            CHECK(count.load() == 1);
+        }
+    }
+    util::ParallelFor(0, [](std::size_t) {
+        FAIL("No index is expected");
+    }, 4);
+}
+
+TEST_CASE("ParallelFor rethrows the exception of a work item") {
+    std::atomic<int> calls{0};
+    CHECK_THROWS_AS(util::ParallelFor(1000, [&calls](std::size_t i) {
+        calls.fetch_add(1);
+        if (i == 10) {
+            throw std::runtime_error("failed");
+        }
+    }, 4), std::runtime_error);
+    CHECK(calls.load() < 1000);
+}
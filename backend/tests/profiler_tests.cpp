@@ -0,0 +1,72 @@
+#include <type_traits>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/app/app.h"
+#include "../src/util/profiler.h"
+
+using namespace std::literals;
+
+TEST_CASE("Scoped timers add to stats and to the trace window") {
+    util::PhaseStats stats;
+    util::TraceRecorder trace;
+    {
+        util::ScopedTimer timer{stats, &trace, "Ignored"sv, 0};
+    }
+    CHECK(stats.GetCount() == 1);
+    CHECK(stats.GetMax() == stats.GetLast());
+    CHECK(trace.GetEvents().empty());
+
+    trace.Start(2);
+    for (int tick = 0; tick != 3; ++tick) {
+        trace.BeginTick();
+        util::ScopedTimer timer{stats, &trace, "Phase"sv, 1};
+    }
+    CHECK_FALSE(trace.IsRecording());
+    CHECK(stats.GetCount() == 4);
+    CHECK(stats.GetTotal() >= stats.GetMax());
+    REQUIRE(trace.GetEvents().size() == 2);
+    CHECK(trace.GetEvents()[0].name == "Phase"sv);
+    CHECK(trace.GetEvents()[1].track == 1);
+    CHECK(trace.GetEvents()[0].start >= trace.GetOrigin());
+}
+
+TEST_CASE("Adding to the trace can't throw out of a timer destructor") {
+    STATIC_REQUIRE(std::is_nothrow_destructible_v<util::ScopedTimer>);
+    STATIC_REQUIRE(noexcept(std::declval<util::TraceRecorder&>().Add(std::declval<const util::TraceEvent&>())));
+}
+
+TEST_CASE("Application profiles the phases of session updates") {
+    model::Game game;
+    model::Map map{model::Map::Id{"map1"}, "Map 1", 2.0, 3};
+    map.AddRoads({model::Road(model::Road::Direction::HORIZONTAL, {0, 0}, 40)});
+    map.AddOffice(model::Office{model::Office::Id{"o0"}, {0, 0}, {0, 0}});
+    map.AddLoot({0.0001, 0.5}, 1, {10, 30});
+    game.AddMap(std::move(map));
+    app::Application app{std::make_unique<model::Game>(std::move(game)), false};
+    app.JoinGame("Dog"s, model::Map::Id{"map1"s});
+
+    app.GetTraceRecorder().Start(1);
+    app.UpdateGameState(10);
+    {
+        auto timer = app.MeasureStateSaving();
+    }
+    app.UpdateGameState(10);
+
+    const auto& session = app.GetGame()->GetGameSessions().front();
+    for (const auto& stats : session->GetTickPhaseStats()) {
+        CHECK(stats.GetCount() == 2);
+    }
+    CHECK(app.GetTickStats().GetCount() == 2);
+    CHECK(app.GetStateSavingStats().GetCount() == 1);
+
+    // The first tick with its phases and the saving that follows it
+    const auto& events = app.GetTraceRecorder().GetEvents();
+    REQUIRE(events.size() == model::TICK_PHASE_COUNT + 2);
+    CHECK(events.front().name == model::GetTickPhaseName(model::TickPhase::UPDATE_DOGS));
+    CHECK(events.front().track == *session->GetId() + 1);
+    CHECK(events[model::TICK_PHASE_COUNT].name == "Tick"sv);
+    CHECK(events.back().name == "SaveState"sv);
+    CHECK(events.back().track == 0);
+    CHECK_FALSE(app.GetTraceRecorder().IsRecording());
+}
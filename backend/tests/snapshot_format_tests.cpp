@@ -0,0 +1,147 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/serialization/snapshot_format.h"
+#include "game_fixture.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct RunningGame {
+    app::Application app{game_fixture::MakeGame(), true, 2};
+    std::vector<std::string> tokens;
+
+    RunningGame() {
+        // Three sessions of at most two players
+        for (int i = 0; i != 5; ++i) {
+            tokens.push_back(app.JoinGame("Dog"s + std::to_string(i), model::Map::Id{"map1"s}).player_token);
+        }
+        app.SetPlayerAction("Bearer "s + tokens[0], "R"s);
+        app.SetPlayerAction("Bearer "s + tokens[3], "D"s);
+        for (int i = 0; i != 50; ++i) {
+            app.UpdateGameState(100);
+        }
+    }
+};
+
+std::string WriteBinary(const app::Application& app) {
+    std::ostringstream out;
+    serialization::WriteBinarySnapshot(serialization::ApplicationRepr{app}, out);
+    return out.str();
+}
+
+void CheckRestored(const RunningGame& game, const app::Application& restored) {
+    REQUIRE(restored.GetGame()->GetGameSessions().size() == game.app.GetGame()->GetGameSessions().size());
+    CHECK(restored.GetPlayerTokens()->GetTokenToPlayer().size() == game.tokens.size());
+    for (const auto& token : game.tokens) {
+        const auto* player = game.app.GetPlayerTokens()->FindPlayerByToken(*app::Token::FromHex(token));
+        const auto* restored_player = restored.GetPlayerTokens()->FindPlayerByToken(*app::Token::FromHex(token));
+        REQUIRE(restored_player);
+        CHECK(restored_player->GetGameSession()->GetId() == player->GetGameSession()->GetId());
+        CHECK(restored_player->GetDog()->GetName() == player->GetDog()->GetName());
+        CHECK(restored_player->GetDog()->GetPosition() == player->GetDog()->GetPosition());
+        CHECK(restored_player->GetDog()->GetScore() == player->GetDog()->GetScore());
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Binary snapshot restores the same state as the text one") {
+    RunningGame game;
+    const auto data = WriteBinary(game.app);
+    REQUIRE(serialization::IsBinarySnapshot(data));
+
+    std::stringstream text;
+    {
+        boost::archive::text_oarchive ar{text};
+        ar << serialization::ApplicationRepr{game.app};
+    }
+    app::Application from_text{game_fixture::MakeGame(), false, 2};
+    {
+        boost::archive::text_iarchive ar{text};
+        serialization::ApplicationRepr repr;
+        ar >> repr;
+        repr.Restore(from_text);
+    }
+    CheckRestored(game, from_text);
+
+    app::Application from_binary{game_fixture::MakeGame(), false, 2};
+    serialization::ReadBinarySnapshot(data, from_binary);
+    game_fixture::CheckSameState(from_text, from_binary);
+}
+
+TEST_CASE("Damaged binary snapshots are rejected") {
+    RunningGame game;
+    auto data = WriteBinary(game.app);
+    app::Application restored{game_fixture::MakeGame(), false, 2};
+
+    SECTION("flipped payload byte of the first session") {
+        // Magic, version, section count, then the type, the checksum and the size of the first section
+        constexpr std::size_t first_payload = 8 + 4 + 4 + 4 + 4 + 8;
+        REQUIRE(data.size() > first_payload);
+        data[first_payload] ^= 1;
+        CHECK_THROWS_AS(serialization::ReadBinarySnapshot(data, restored), std::runtime_error);
+    }
+    SECTION("flipped payload byte of the last section") {
+        data[data.size() - 1] ^= 1;
+        CHECK_THROWS_AS(serialization::ReadBinarySnapshot(data, restored), std::runtime_error);
+    }
+    SECTION("truncated file") {
+        data.resize(data.size() - 3);
+        CHECK_THROWS_AS(serialization::ReadBinarySnapshot(data, restored), std::runtime_error);
+    }
+    SECTION("unsupported version") {
+        data[8] = static_cast<char>(serialization::BINARY_SNAPSHOT_VERSION + 1);
+        CHECK_THROWS_AS(serialization::ReadBinarySnapshot(data, restored), std::runtime_error);
+    }
+
+    // Nothing is restored from a snapshot that is damaged anywhere
+    CHECK(restored.GetGame()->GetGameSessions().empty());
+    CHECK(restored.GetPlayerTokens()->GetTokenToPlayer().empty());
+}
+
+TEST_CASE("State files of both formats are loaded") {
+    const auto filename = (std::filesystem::temp_directory_path() / "snapshot_format_test_state").string();
+    RunningGame game;
+    for (const auto format : {serialization::SnapshotFormat::TEXT, serialization::SnapshotFormat::BINARY}) {
+        serialization::SaveSnapshot(serialization::ApplicationRepr{game.app}, filename, format);
+        app::Application restored{game_fixture::MakeGame(), false, 2};
+        serialization::LoadSnapshot(restored, filename);
+        CheckRestored(game, restored);
+    }
+    std::filesystem::remove(filename);
+
+    CHECK(serialization::ParseSnapshotFormat("text"sv) == serialization::SnapshotFormat::TEXT);
+    CHECK_THROWS_AS(serialization::ParseSnapshotFormat("xml"sv), std::invalid_argument);
+}
+
+TEST_CASE("Text state files of another version are refused") {
+    const auto filename = (std::filesystem::temp_directory_path() / "snapshot_format_test_old_state").string();
+    RunningGame game;
+    serialization::SaveSnapshot(serialization::ApplicationRepr{game.app}, filename, serialization::SnapshotFormat::TEXT);
+    std::string data;
+    {
+        std::ifstream file{filename};
+        data.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+
+    // The archive header is followed by the tracking level and the version of ApplicationRepr
+    std::istringstream in{data};
+    std::string size, signature, library_version, tracking, version;
+    in >> size >> signature >> library_version >> tracking >> version;
+    REQUIRE(signature == "serialization::archive");
+    REQUIRE(version == std::to_string(serialization::STATE_FILE_VERSION));
+    data.replace(static_cast<std::size_t>(in.tellg()) - version.size(), version.size(), "0");
+    std::ofstream{filename, std::ios::trunc} << data;
+
+    app::Application restored{game_fixture::MakeGame(), false, 2};
+    CHECK_THROWS_AS(serialization::LoadSnapshot(restored, filename), std::runtime_error);
+    CHECK(restored.GetGame()->GetGameSessions().empty());
+    std::filesystem::remove(filename);
+}
@@ -0,0 +1,52 @@
+#include <filesystem>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/serialization/snapshot_writer.h"
+#include "game_fixture.h"
+
+using namespace std::literals;
+
+TEST_CASE("Snapshot writer saves the state captured at submission") {
+    const auto filename = (std::filesystem::temp_directory_path() / "snapshot_writer_test_state").string();
+    app::Application app{game_fixture::MakeGame(), false};
+    const auto token = app.JoinGame("Rex"s, model::Map::Id{"map1"s}).player_token;
+    app.SetPlayerAction("Bearer "s + token, "R"s);
+    app.UpdateGameState(1000);
+    const auto& dog = app.GetGame()->GetGameSessions().front()->GetDogs().front();
+    const auto captured_position = dog->GetPosition();
+
+    int errors = 0;
+    {
+        serialization::SnapshotWriter writer{filename, serialization::SnapshotFormat::BINARY, [&errors](const std::exception&) {
+            ++errors;
+        }};
+        writer.Submit(serialization::ApplicationRepr{app});
+        // The game keeps running while the snapshot is written
+        app.UpdateGameState(1000);
+        writer.Flush();
+        CHECK(writer.GetWrittenCount() == 1);
+    }
+    CHECK(errors == 0);
+    CHECK(dog->GetPosition() != captured_position);
+
+    app::Application restored{game_fixture::MakeGame(), false};
+    serialization::LoadSnapshot(restored, filename);
+    const auto& restored_dogs = restored.GetGame()->GetGameSessions().front()->GetDogs();
+    REQUIRE(restored_dogs.size() == 1);
+    CHECK(restored_dogs.front()->GetPosition() == captured_position);
+    std::filesystem::remove(filename);
+}
+
+TEST_CASE("Snapshot writer reports failures and keeps working") {
+    const auto filename = (std::filesystem::temp_directory_path() / "no_such_dir" / "state").string();
+    app::Application app{game_fixture::MakeGame(), false};
+    int errors = 0;
+    serialization::SnapshotWriter writer{filename, serialization::SnapshotFormat::BINARY, [&errors](const std::exception&) {
+        ++errors;
+    }};
+    writer.Submit(serialization::ApplicationRepr{app});
+    writer.Flush();
+    CHECK(errors == 1);
+    CHECK(writer.GetWrittenCount() == 0);
+}
@@ -84,7 +84,7 @@ SCENARIO_METHOD(Fixture, "GameSessionRepr Serialization") {
         Game game = json_loader::LoadGame("./data/config.json", payload);
         // Filling in the required objects for testing
         Map::Id id{"map1"};
-        const Map* map_ptr = game.FindMap(id);
+        const auto map_ptr = game.FindMap(id);
         game.AddGameSession(map_ptr);
         auto session_ptr = game.FindGameSession(id);
         session_ptr->AddDog("Rex"s, {1.0, 0.0}, 1);
@@ -98,7 +98,7 @@ SCENARIO_METHOD(Fixture, "GameSessionRepr Serialization") {
                 InputArchive input_archive{strm};
                 serialization::GameSessionRepr restored_repr;
                 input_archive >> restored_repr;
-                auto restored_session = std::make_shared<model::GameSession>(*map_ptr);
+                auto restored_session = std::make_shared<model::GameSession>(map_ptr);
                 restored_repr.Restore(restored_session);
                 // We check that the data after deserialization is the same as the original
                 CHECK(session_ptr->GetDogs().size() == restored_session->GetDogs().size());
@@ -115,27 +115,26 @@ SCENARIO_METHOD(Fixture, "GameRepr Serialization") {
     GIVEN("A game with sessions") {
         // Creating a Game object
         extra_data::Payload payload;
-        Game game = json_loader::LoadGame("./data/config.json", payload);
+        auto game = std::make_unique<Game>(json_loader::LoadGame("./data/config.json", payload));
         // Filling in the required objects for testing
         Map::Id id{"map1"};
-        const Map* map_ptr = game.FindMap(id);
-        game.AddGameSession(map_ptr);
-        auto session_ptr = game.FindGameSession(id);
+        const auto map_ptr = game->FindMap(id);
+        game->AddGameSession(map_ptr);
+        auto session_ptr = game->FindGameSession(id);
         session_ptr->AddDog("Rex"s, {0.0, 0.1}, 0);
         session_ptr->AddDog("Buddy"s, {40.0, 0.2}, 1);
         Loot::LostObjects objects;
         objects.emplace_back(std::make_shared<LostObject>(LostObject::Id{0}, 0, geom::Point2D{0.0, 20.0}));
         objects.emplace_back(std::make_shared<LostObject>(LostObject::Id{1}, 0, geom::Point2D{30.0, 0.03}));
-        session_ptr->GetMap()->GetLoot()->SetLostObjects(objects);
-        session_ptr->GetMap()->GetLoot()->SetNextId(2);
-        session_ptr->GetMap()->GetLoot()->SetLootCount(2);
+        session_ptr->GetLoot()->SetLostObjects(objects);
+        session_ptr->GetLoot()->SetNextId(2);
         std::uint32_t next_dog_id = *(session_ptr->GetDogs().back()->GetId());
         ++next_dog_id;
-        std::uint32_t next_object_id = *(session_ptr->GetMap()->GetLoot()->GetLostObjects().back()->GetId());
+        std::uint32_t next_object_id = *(session_ptr->GetLoot()->GetLostObjects().back()->GetId());
         ++next_object_id;
 
         WHEN("the game is serialized") {
-            serialization::GameRepr repr{std::make_unique<model::Game>(game)};
+            serialization::GameRepr repr{game};
             output_archive << repr;
 
             THEN("it can be deserialized") {
@@ -143,28 +142,27 @@ SCENARIO_METHOD(Fixture, "GameRepr Serialization") {
                 serialization::GameRepr restored_repr;
                 input_archive >> restored_repr;
                 extra_data::Payload payload2;
-                Game restored_game = json_loader::LoadGame("./data/config.json", payload2);
-                auto restored_game_ptr = std::make_unique<model::Game>(restored_game);
+                auto restored_game_ptr = std::make_unique<model::Game>(json_loader::LoadGame("./data/config.json", payload2));
                 restored_repr.Restore(restored_game_ptr);
                 // We check that the data after deserialization is the same as the original
-                CHECK(game.GetMaps().size() == restored_game_ptr->GetMaps().size());
-                CHECK(game.GetGameSessions().size() == restored_game_ptr->GetGameSessions().size());
-                CHECK(game.GetGameSessions()[0]->GetDogs().size() == restored_game_ptr->GetGameSessions()[0]->GetDogs().size());
-                CHECK(game.GetGameSessions()[0]->GetDogs()[0]->GetId() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[0]->GetId());
-                CHECK(game.GetGameSessions()[0]->GetDogs()[0]->GetName() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[0]->GetName());
-                CHECK(game.GetGameSessions()[0]->GetDogs()[0]->GetPosition() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[0]->GetPosition());
-                CHECK(game.GetGameSessions()[0]->GetDogs()[1]->GetId() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[1]->GetId());
-                CHECK(game.GetGameSessions()[0]->GetDogs()[1]->GetName() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[1]->GetName());
-                CHECK(game.GetGameSessions()[0]->GetDogs()[1]->GetPosition() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[1]->GetPosition());
+                CHECK(game->GetMaps().size() == restored_game_ptr->GetMaps().size());
+                CHECK(game->GetGameSessions().size() == restored_game_ptr->GetGameSessions().size());
+                CHECK(game->GetGameSessions()[0]->GetDogs().size() == restored_game_ptr->GetGameSessions()[0]->GetDogs().size());
+                CHECK(game->GetGameSessions()[0]->GetDogs()[0]->GetId() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[0]->GetId());
+                CHECK(game->GetGameSessions()[0]->GetDogs()[0]->GetName() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[0]->GetName());
+                CHECK(game->GetGameSessions()[0]->GetDogs()[0]->GetPosition() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[0]->GetPosition());
+                CHECK(game->GetGameSessions()[0]->GetDogs()[1]->GetId() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[1]->GetId());
+                CHECK(game->GetGameSessions()[0]->GetDogs()[1]->GetName() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[1]->GetName());
+                CHECK(game->GetGameSessions()[0]->GetDogs()[1]->GetPosition() == restored_game_ptr->GetGameSessions()[0]->GetDogs()[1]->GetPosition());
                 CHECK(next_dog_id == (*(restored_game_ptr->GetGameSessions()[0]->GetDogs().back()->GetId()) + 1));
-                CHECK(game.GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects().size() == restored_game_ptr->GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects().size());
-                CHECK(game.GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[0]->GetId() == restored_game_ptr->GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[0]->GetId());
-                CHECK(game.GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[0]->GetPosition() == restored_game_ptr->GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[0]->GetPosition());
-                CHECK(game.GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[0]->GetType() == restored_game_ptr->GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[0]->GetType());
-                CHECK(game.GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[1]->GetId() == restored_game_ptr->GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[1]->GetId());
-                CHECK(game.GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[1]->GetPosition() == restored_game_ptr->GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[1]->GetPosition());
-                CHECK(game.GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[1]->GetType() == restored_game_ptr->GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects()[1]->GetType());
-                CHECK(next_object_id == (*(restored_game_ptr->GetGameSessions()[0]->GetMap()->GetLoot()->GetLostObjects().back()->GetId()) + 1));
+                CHECK(game->GetGameSessions()[0]->GetLoot()->GetLostObjects().size() == restored_game_ptr->GetGameSessions()[0]->GetLoot()->GetLostObjects().size());
+                CHECK(game->GetGameSessions()[0]->GetLoot()->GetLostObjects()[0]->GetId() == restored_game_ptr->GetGameSessions()[0]->GetLoot()->GetLostObjects()[0]->GetId());
+                CHECK(game->GetGameSessions()[0]->GetLoot()->GetLostObjects()[0]->GetPosition() == restored_game_ptr->GetGameSessions()[0]->GetLoot()->GetLostObjects()[0]->GetPosition());
+                CHECK(game->GetGameSessions()[0]->GetLoot()->GetLostObjects()[0]->GetType() == restored_game_ptr->GetGameSessions()[0]->GetLoot()->GetLostObjects()[0]->GetType());
+                CHECK(game->GetGameSessions()[0]->GetLoot()->GetLostObjects()[1]->GetId() == restored_game_ptr->GetGameSessions()[0]->GetLoot()->GetLostObjects()[1]->GetId());
+                CHECK(game->GetGameSessions()[0]->GetLoot()->GetLostObjects()[1]->GetPosition() == restored_game_ptr->GetGameSessions()[0]->GetLoot()->GetLostObjects()[1]->GetPosition());
+                CHECK(game->GetGameSessions()[0]->GetLoot()->GetLostObjects()[1]->GetType() == restored_game_ptr->GetGameSessions()[0]->GetLoot()->GetLostObjects()[1]->GetType());
+                CHECK(next_object_id == (*(restored_game_ptr->GetGameSessions()[0]->GetLoot()->GetLostObjects().back()->GetId()) + 1));
             }
         }
     }
@@ -174,16 +172,15 @@ SCENARIO_METHOD(Fixture, "ApplicationRepr Serialization") {
     GIVEN("A game, players, and player tokens") {
         // Creating a Game object
         extra_data::Payload payload;
-        Game game = json_loader::LoadGame("./data/config.json", payload);
         // Filling in the required objects for testing
         Map::Id id{"map1"};
-        app::Application app_real(std::make_unique<Game>(game), true);
+        app::Application app_real(std::make_unique<Game>(json_loader::LoadGame("./data/config.json", payload)), true);
 
         app_real.JoinGame("Rex"s, id);
         app_real.JoinGame("Buddy"s, id);
 
-        app::Token token1{""};
-        app::Token token2{""};
+        app::Token token1;
+        app::Token token2;
 
         const auto& player_tokens = app_real.GetPlayerTokens()->GetTokenToPlayer();
         for (auto it = player_tokens.begin(); it != player_tokens.end(); ++it) {
@@ -194,11 +191,11 @@ SCENARIO_METHOD(Fixture, "ApplicationRepr Serialization") {
             }
         }
 
-        const std::string credentials1{"Bearer " + *token1};
+        const std::string credentials1{"Bearer " + token1.ToHex()};
         const std::string dir1{"D"};
         app_real.SetPlayerAction(credentials1, dir1);
 
-        const std::string credentials2{"Bearer " + *token2};
+        const std::string credentials2{"Bearer " + token2.ToHex()};
         const std::string dir2{"R"};
         app_real.SetPlayerAction(credentials2, dir2);
 
@@ -217,8 +214,7 @@ SCENARIO_METHOD(Fixture, "ApplicationRepr Serialization") {
 
             THEN("it can be deserialized") {
                 extra_data::Payload payload2;
-                Game restored_game = json_loader::LoadGame("./data/config.json", payload2);
-                app::Application restore_app(std::make_unique<Game>(restored_game), false);
+                app::Application restore_app(std::make_unique<Game>(json_loader::LoadGame("./data/config.json", payload2)), false);
                 InputArchive input_archive{strm};
                 serialization::ApplicationRepr restored_app_repr;
                 input_archive >> restored_app_repr;
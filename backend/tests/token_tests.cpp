@@ -0,0 +1,80 @@
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/app/app.h"
+#include "../src/app/token.h"
+#include "../src/util/open_addressing_map.h"
+
+using namespace std::literals;
+
+TEST_CASE("Token hex conversion") {
+    const app::Token token{0x0123456789abcdefull, 0xfedcba9876543210ull};
+    CHECK(token.ToHex() == "0123456789abcdeffedcba9876543210"s);
+
+    auto parsed = app::Token::FromHex("0123456789abcdeffedcba9876543210"sv);
+    REQUIRE(parsed.has_value());
+    CHECK(*parsed == token);
+    CHECK_FALSE(app::Token::FromHex("0123456789ABCDEFfedcba9876543210"sv).has_value());
+    CHECK_FALSE(app::Token::FromHex("0123456789abcdeFfedcba9876543210"sv).has_value());
+
+    CHECK_FALSE(app::Token::FromHex(""sv).has_value());
+    CHECK_FALSE(app::Token::FromHex("0123456789abcdeffedcba987654321"sv).has_value());
+    CHECK_FALSE(app::Token::FromHex("0123456789abcdeffedcba987654321g"sv).has_value());
+}
+
+TEST_CASE("Open addressing map keeps all inserted tokens") {
+    util::OpenAddressingMap<app::Token, int, app::TokenHasher> map;
+    std::unordered_map<std::string, int> expected;
+    for (int i = 0; i != 1000; ++i) {
+        const app::Token token{static_cast<std::uint64_t>(i) * 7919u, static_cast<std::uint64_t>(i)};
+        CHECK(map.emplace(token, i).second);
+        expected.emplace(token.ToHex(), i);
+    }
+    CHECK_FALSE(map.emplace(app::Token{0u, 0u}, 42).second);
+    CHECK(map.size() == expected.size());
+
+    std::size_t visited = 0;
+    for (const auto& [token, value] : map) {
+        CHECK(expected.at(token.ToHex()) == value);
+        ++visited;
+    }
+    CHECK(visited == expected.size());
+
+    auto it = map.find(app::Token{7919u * 5u, 5u});
+    REQUIRE(it != map.end());
+    CHECK(it->second == 5);
+    CHECK(map.find(app::Token{1u, 0u}) == map.end());
+}
+
+TEST_CASE("Player handles stay valid as players and tokens are added") {
+    model::Game game;
+    model::Map map{model::Map::Id{"map1"}, "Map 1", 1.0, 3};
+    map.AddRoads({model::Road(model::Road::Direction::HORIZONTAL, {0, 0}, 40)});
+    game.AddMap(std::move(map));
+    auto session = game.AddGameSession(game.FindMap(model::Map::Id{"map1"}));
+
+    app::Players players;
+    app::PlayerTokens player_tokens;
+    struct Issued {
+        app::Token token;
+        app::PlayerHandle player;
+        std::string name;
+    };
+    std::vector<Issued> issued;
+    for (int i = 0; i != 3000; ++i) {
+        const auto name = "dog"s + std::to_string(i);
+        const auto& player = players.Add(session, session->AddDog(name, {0., 0.}, 0));
+        // The store of the players and the token table grow many times meanwhile
+        issued.push_back({player_tokens.Add(player), &player, name});
+    }
+
+    REQUIRE(players.GetAddedPlayers().size() == issued.size());
+    for (std::size_t i = 0; i != issued.size(); ++i) {
+        CHECK(&players.GetAddedPlayers()[i] == issued[i].player);
+        CHECK(issued[i].player->GetDog()->GetName() == issued[i].name);
+        CHECK(player_tokens.FindPlayerByToken(issued[i].token) == issued[i].player);
+    }
+}
@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/json.hpp>
+#include <boost/program_options.hpp>
+
+#include "../src/util/histogram.h"
+#include "../src/util/random.h"
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace json = boost::json;
+using tcp = net::ip::tcp;
+using namespace std::literals;
+
+namespace {
+
+struct Args {
+    std::string host;
+    std::string port;
+    std::string map_id;
+    std::size_t players;
+    std::size_t connections;
+    unsigned int duration;
+    unsigned int state_weight;
+    unsigned int action_weight;
+    unsigned int map_weight;
+    std::size_t batch_size;
+    std::uint64_t random_seed;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+    po::options_description desc("Allowed options");
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("host", po::value<std::string>(&args.host)->default_value("127.0.0.1"s), "set server address")
+        ("port,p", po::value<std::string>(&args.port)->default_value("8080"s), "set server port")
+        ("map", po::value<std::string>(&args.map_id), "set id of the map to join, the first map of the server by default")
+        ("players", po::value<std::size_t>(&args.players)->default_value(1000), "set number of players to join")
+        ("connections,c", po::value<std::size_t>(&args.connections)->default_value(8), "set number of keep-alive connections, each one runs in its own thread")
+        ("duration,d", po::value<unsigned int>(&args.duration)->default_value(10), "set duration of the load in seconds")
+        ("state-weight", po::value<unsigned int>(&args.state_weight)->default_value(6), "set relative share of game state requests")
+        ("action-weight", po::value<unsigned int>(&args.action_weight)->default_value(3), "set relative share of player action requests")
+        ("map-weight", po::value<unsigned int>(&args.map_weight)->default_value(1), "set relative share of map requests")
+        ("batch-size", po::value<std::size_t>(&args.batch_size)->default_value(0), "send player actions in batches of this many players to the batch endpoint, 0 sends them one by one")
+        ("random-seed", po::value<std::uint64_t>(&args.random_seed)->default_value(1), "set seed of the request mix");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (args.connections == 0 || args.players < args.connections) {
+        throw std::invalid_argument("There must be at least one player for every connection");
+    }
+    if (args.state_weight + args.action_weight + args.map_weight == 0) {
+        throw std::invalid_argument("At least one request weight must be positive");
+    }
+    return args;
+}
+
+enum class Endpoint {
+    JOIN,
+    STATE,
+    ACTION,
+    BATCH,
+    MAP
+};
+
+constexpr std::size_t ENDPOINT_COUNT = 5;
+constexpr std::array<std::string_view, ENDPOINT_COUNT> ENDPOINT_NAMES = {"join"sv, "state"sv, "action"sv, "batch"sv, "map"sv};
+
+struct EndpointStats {
+    util::Histogram latency;
+    std::atomic<std::uint64_t> errors{0};
+};
+
+using Stats = std::array<EndpointStats, ENDPOINT_COUNT>;
+using Clock = std::chrono::steady_clock;
+
+// When a connection joined its players and ran the load, throughput is counted over the measured time
+struct Timeline {
+    Clock::time_point join_start;
+    Clock::time_point load_start;
+    Clock::time_point load_end;
+};
+
+// Synchronous keep-alive HTTP/1.1 connection, it reconnects after the server closes it
+class Client {
+public:
+    Client(net::io_context& ioc, tcp::resolver::results_type endpoints, std::string host)
+        : stream_{ioc}
+        , endpoints_{std::move(endpoints)}
+        , host_{std::move(host)} {
+    }
+
+    // Returns the response or nullopt on a network error, the latency is recorded in both cases
+    std::optional<http::response<http::string_body>> Send(http::verb method, std::string_view target, std::string body,
+                                                          const std::string& authorization, EndpointStats& stats) {
+        http::request<http::string_body> request{method, target, 11};
+        request.set(http::field::host, host_);
+        request.keep_alive(true);
+        if (!authorization.empty()) {
+            request.set(http::field::authorization, authorization);
+        }
+        if (method == http::verb::post) {
+            request.set(http::field::content_type, "application/json"sv);
+            request.body() = std::move(body);
+        }
+        request.prepare_payload();
+
+        const auto start = std::chrono::steady_clock::now();
+        std::optional<http::response<http::string_body>> response;
+        try {
+            if (!connected_) {
+                stream_.connect(endpoints_);
+                connected_ = true;
+            }
+            http::write(stream_, request);
+            response.emplace();
+            http::read(stream_, buffer_, *response);
+            if (response->need_eof()) {
+                Close();
+            }
+        } catch (const std::exception&) {
+            Close();
+            response.reset();
+        }
+        const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        stats.latency.Record(static_cast<std::uint64_t>(latency.count()));
+        if (!response || response->result() != http::status::ok) {
+            stats.errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        return response;
+    }
+
+private:
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    tcp::resolver::results_type endpoints_;
+    std::string host_;
+    bool connected_ = false;
+
+    void Close() {
+        beast::error_code ec;
+        stream_.socket().shutdown(tcp::socket::shutdown_both, ec);
+        stream_.close();
+        buffer_.clear();
+        connected_ = false;
+    }
+};
+
+std::string FindFirstMapId(Client& client, EndpointStats& stats) {
+    auto response = client.Send(http::verb::get, "/api/v1/maps"sv, {}, {}, stats);
+    if (!response || response->result() != http::status::ok) {
+        throw std::runtime_error("Failed to get the list of maps");
+    }
+    const auto maps = json::parse(response->body()).as_array();
+    if (maps.empty()) {
+        throw std::runtime_error("The server has no maps");
+    }
+    return std::string{maps.at(0).as_object().at("id").as_string()};
+}
+
+// A response with the OK status may still be malformed or report failed actions, it is counted as an error then
+template <typename Check>
+void CheckResponse(const std::optional<http::response<http::string_body>>& response, EndpointStats& stats, Check check) {
+    if (!response || response->result() != http::status::ok) {
+        return;
+    }
+    try {
+        if (!check(json::parse(response->body()))) {
+            stats.errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    } catch (const std::exception&) {
+        stats.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Timeline RunConnection(const Args& args, std::size_t index, const std::string& map_id,
+                       const tcp::resolver::results_type& endpoints, Stats& stats) {
+    net::io_context ioc;
+    Client client{ioc, endpoints, args.host};
+    Timeline timeline;
+    timeline.join_start = Clock::now();
+
+    // Players are split between connections evenly
+    const std::size_t first_player = args.players * index / args.connections;
+    const std::size_t last_player = args.players * (index + 1) / args.connections;
+    std::vector<std::string> tokens;
+    std::vector<std::string> authorizations;
+    tokens.reserve(last_player - first_player);
+    authorizations.reserve(last_player - first_player);
+    auto& join_stats = stats[static_cast<std::size_t>(Endpoint::JOIN)];
+    for (std::size_t i = first_player; i != last_player; ++i) {
+        json::object body{{"userName", "bot"s + std::to_string(i)}, {"mapId", map_id}};
+        auto response = client.Send(http::verb::post, "/api/v1/game/join"sv, json::serialize(body), {}, join_stats);
+        CheckResponse(response, join_stats, [&](const json::value& value) {
+            tokens.emplace_back(value.as_object().at("authToken").as_string());
+            authorizations.push_back("Bearer "s + tokens.back());
+            return true;
+        });
+    }
+    timeline.load_start = Clock::now();
+    timeline.load_end = timeline.load_start;
+    if (authorizations.empty()) {
+        return timeline;
+    }
+
+    // Joins are not counted in the duration of the load
+    const auto deadline = timeline.load_start + std::chrono::seconds{args.duration};
+    static constexpr std::array<std::string_view, 5> moves = {"L"sv, "R"sv, "U"sv, "D"sv, ""sv};
+    const std::string map_target = "/api/v1/maps/"s + map_id;
+    const std::uint64_t total_weight = args.state_weight + args.action_weight + args.map_weight;
+    util::RandomEngine engine{util::MixSeed(args.random_seed, index)};
+    std::size_t next_batch_player = 0;
+    for (std::size_t i = 0; Clock::now() < deadline; ++i) {
+        const auto& authorization = authorizations[i % authorizations.size()];
+        const auto choice = engine.NextIndex(total_weight);
+        if (choice < args.state_weight) {
+            client.Send(http::verb::get, "/api/v1/game/state"sv, {}, authorization, stats[static_cast<std::size_t>(Endpoint::STATE)]);
+        } else if (choice < args.state_weight + args.action_weight && args.batch_size == 0) {
+            json::object body{{"move", moves[engine.NextIndex(moves.size())]}};
+            client.Send(http::verb::post, "/api/v1/game/player/action"sv, json::serialize(body), authorization,
+                        stats[static_cast<std::size_t>(Endpoint::ACTION)]);
+        } else if (choice < args.state_weight + args.action_weight) {
+            // The next players of the connection in turn, every one of them moves once in a batch
+            json::array batch;
+            batch.reserve(args.batch_size);
+            for (std::size_t j = 0; j != args.batch_size; ++j, ++next_batch_player) {
+                batch.push_back(json::object{{"token", tokens[next_batch_player % tokens.size()]},
+                                             {"move", moves[engine.NextIndex(moves.size())]}});
+            }
+            auto& batch_stats = stats[static_cast<std::size_t>(Endpoint::BATCH)];
+            auto response = client.Send(http::verb::post, "/api/v1/game/player/actions"sv, json::serialize(batch), {}, batch_stats);
+            CheckResponse(response, batch_stats, [](const json::value& value) {
+                return value.as_object().at("errors").as_array().empty();
+            });
+        } else {
+            client.Send(http::verb::get, map_target, {}, {}, stats[static_cast<std::size_t>(Endpoint::MAP)]);
+        }
+    }
+    timeline.load_end = Clock::now();
+    return timeline;
+}
+
+double Rate(std::uint64_t count, double seconds) {
+    return seconds > 0. ? static_cast<double>(count) / seconds : 0.;
+}
+
+// Rates are taken over the measured time of the phase: the joins, or the load that follows them
+void PrintReport(const Stats& stats, double join_seconds, double load_seconds) {
+    std::cout << std::left << std::setw(8) << "endpoint" << std::right
+              << std::setw(10) << "requests" << std::setw(8) << "errors" << std::setw(11) << "req/s"
+              << std::setw(10) << "mean us" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "max us" << '\n';
+    std::cout << std::fixed << std::setprecision(1);
+    for (std::size_t i = 0; i != ENDPOINT_COUNT; ++i) {
+        const auto& endpoint = stats[i];
+        const auto count = endpoint.latency.GetCount();
+        if (count == 0) {
+            continue;
+        }
+        std::cout << std::left << std::setw(8) << ENDPOINT_NAMES[i] << std::right
+                  << std::setw(10) << count << std::setw(8) << endpoint.errors.load()
+                  << std::setw(11) << Rate(count, i == static_cast<std::size_t>(Endpoint::JOIN) ? join_seconds : load_seconds)
+                  << std::setw(10) << endpoint.latency.GetMean()
+                  << std::setw(10) << endpoint.latency.GetPercentile(0.5)
+                  << std::setw(10) << endpoint.latency.GetPercentile(0.9)
+                  << std::setw(10) << endpoint.latency.GetPercentile(0.99)
+                  << std::setw(10) << endpoint.latency.GetMax() << '\n';
+    }
+    std::cout.flush();
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        net::io_context ioc;
+        tcp::resolver resolver{ioc};
+        const auto endpoints = resolver.resolve(args->host, args->port);
+
+        Stats stats;
+        std::string map_id = args->map_id;
+        if (map_id.empty()) {
+            Client client{ioc, endpoints, args->host};
+            map_id = FindFirstMapId(client, stats[static_cast<std::size_t>(Endpoint::MAP)]);
+        }
+
+        std::vector<Timeline> timelines(args->connections);
+        // An error a connection can not count against a request stops it, and is reported once all of them are done
+        std::vector<std::exception_ptr> failures(args->connections);
+        std::vector<std::thread> workers;
+        workers.reserve(args->connections);
+        for (std::size_t i = 0; i != args->connections; ++i) {
+            workers.emplace_back([&, i] {
+                try {
+                    timelines[i] = RunConnection(*args, i, map_id, endpoints, stats);
+                } catch (...) {
+                    failures[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& failure : failures) {
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+
+        // Each phase lasts from its first start to its last end over all connections
+        auto join_start = Clock::time_point::max();
+        auto join_end = Clock::time_point::min();
+        auto load_start = Clock::time_point::max();
+        auto load_end = Clock::time_point::min();
+        for (const auto& timeline : timelines) {
+            join_start = std::min(join_start, timeline.join_start);
+            join_end = std::max(join_end, timeline.load_start);
+            load_start = std::min(load_start, timeline.load_start);
+            load_end = std::max(load_end, timeline.load_end);
+        }
+        const std::chrono::duration<double> join_time = join_end - join_start;
+        const std::chrono::duration<double> load_time = load_end - load_start;
+
+        std::cout << "map: "sv << map_id << ", players: "sv << args->players << ", connections: "sv << args->connections
+                  << ", batch size: "sv << args->batch_size << ", join seconds: "sv << join_time.count()
+                  << ", load seconds: "sv << load_time.count() << '\n';
+        PrintReport(stats, join_time.count(), load_time.count());
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include "../src/app/app.h"
+#include "../src/app/input_log.h"
+#include "../src/loader/json_loader.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct Args {
+    std::string config_file_path;
+    std::string input_log_file;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+    po::options_description desc("Allowed options");
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("config-file,c", po::value<std::string>(&args.config_file_path)->required(), "set config file path")
+        ("input-log,i", po::value<std::string>(&args.input_log_file)->required(), "set path to the recorded input log");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    po::notify(vm);
+    return args;
+}
+
+// FNV-1a over the state of all dogs and lost objects, two runs of the same log must print the same value
+class StateHasher {
+public:
+    template <typename T>
+    void Add(const T& value) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        for (auto byte : bytes) {
+            hash_ = (hash_ ^ byte) * 0x100000001B3ull;
+        }
+    }
+
+    std::uint64_t Get() const noexcept {
+        return hash_;
+    }
+
+private:
+    std::uint64_t hash_ = 0xCBF29CE484222325ull;
+};
+
+std::uint64_t HashState(const app::Application& app) {
+    StateHasher hasher;
+    for (const auto& session : app.GetGame()->GetGameSessions()) {
+        hasher.Add(*session->GetId());
+        for (const auto& dog : session->GetDogs()) {
+            hasher.Add(dog->GetPosition().x);
+            hasher.Add(dog->GetPosition().y);
+            hasher.Add(dog->GetScore());
+            for (const auto& item : dog->GetBagContent()) {
+                hasher.Add(*item.id);
+                hasher.Add(item.type);
+            }
+        }
+        for (const auto& object : session->GetLoot()->GetLostObjects()) {
+            hasher.Add(object->GetType());
+            hasher.Add(object->GetPosition().x);
+            hasher.Add(object->GetPosition().y);
+        }
+    }
+    return hasher.Get();
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        std::ifstream log_file(args->input_log_file, std::ios::binary);
+        if (!log_file.is_open()) {
+            throw std::runtime_error("Failed to open file: " + args->input_log_file);
+        }
+        app::InputLogReader reader{log_file};
+        const auto& header = reader.GetHeader();
+
+        extra_data::Payload payload;
+        auto game = std::make_unique<model::Game>(json_loader::LoadGame(args->config_file_path, payload));
+        game->SetRandomSeed(header.random_seed);
+        app::Application app{std::move(game), header.random_positions, header.max_session_players};
+        app.SetFixedTimeStep(std::chrono::milliseconds(header.fixed_time_step));
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto stats = reader.Replay(app);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "joins: "sv << stats.joins << '\n'
+                  << "actions: "sv << stats.actions << '\n'
+                  << "ticks: "sv << stats.ticks << '\n'
+                  << "rejected: "sv << stats.rejected << '\n'
+                  << "elapsed ms: "sv << elapsed.count() << '\n'
+                  << "ticks per second: "sv << (elapsed.count() > 0 ? stats.ticks * 1000. / elapsed.count() : 0.) << '\n'
+                  << "state hash: "sv << std::hex << HashState(app) << std::dec << std::endl;
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}